@@ -0,0 +1,236 @@
+#include "audio_capture.h"
+
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "crc32.h"
+
+static const char *TAG = "CAPTURE";
+
+#ifdef CONFIG_AUDIO_CAPTURE_PRE_MS
+#define AUDIO_CAPTURE_PRE_MS (CONFIG_AUDIO_CAPTURE_PRE_MS)
+#define AUDIO_CAPTURE_POST_MS (CONFIG_AUDIO_CAPTURE_POST_MS)
+#else
+#define AUDIO_CAPTURE_PRE_MS (500)
+#define AUDIO_CAPTURE_POST_MS (250)
+#endif
+
+#define AUDIO_CAPTURE_SAMPLE_RATE (44100)
+#define POST_SAMPLES ((uint32_t)AUDIO_CAPTURE_POST_MS * AUDIO_CAPTURE_SAMPLE_RATE / 1000)
+#define RING_SAMPLES ((uint32_t)(AUDIO_CAPTURE_PRE_MS + AUDIO_CAPTURE_POST_MS) * AUDIO_CAPTURE_SAMPLE_RATE / 1000)
+// block headers for blocks of 256 samples or more, the DSP element normally delivers 512,
+// smaller blocks run out of headers first and shorten the window
+#define RING_BLOCKS (RING_SAMPLES / 256 + 2)
+// samples per dump line
+#define LINE_SAMPLES (128)
+
+static dsp_chain_params_t chain_params;
+#ifdef CONFIG_STATIC_MEMORY
+// in PSRAM with CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY, internal .bss otherwise
+EXT_RAM_BSS_ATTR static struct {
+  audio_capture_block_t blocks[RING_BLOCKS];
+  int16_t ring[RING_SAMPLES];
+} capture_mem;
+#endif
+static int16_t *ring;                 // RING_SAMPLES
+static audio_capture_block_t *blocks; // RING_BLOCKS
+static uint32_t total;                // samples recorded, free running
+static uint32_t write_pos;            // total % RING_SAMPLES, kept separately as total wraps
+static uint32_t started;              // blocks recorded, the newest is (started - 1) % RING_BLOCKS
+
+static bool triggered = false;
+static uint32_t trigger_at;
+// snapshot complete, recording stops until it is dumped
+static bool frozen = false;
+// recording stops while a dump is printed
+static bool dumping = false;
+// the newest block is still being processed, its edges go into its crc
+static bool block_open = false;
+// settings changed during a dump, the ring is dropped after it
+static bool stale = false;
+
+// guards everything above, recording copies a block (a few microseconds) with the lock held
+static portMUX_TYPE capture_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t audio_capture_init(const dsp_chain_params_t *params) {
+  chain_params = *params;
+
+  if (RING_SAMPLES == 0) {
+    return ESP_OK;
+  }
+
+  size_t size = RING_SAMPLES * sizeof(int16_t) + RING_BLOCKS * sizeof(audio_capture_block_t);
+#ifdef CONFIG_STATIC_MEMORY
+  void *mem = &capture_mem;
+#else
+  void *mem = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!mem) {
+    mem = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+  }
+#endif
+  if (!mem) {
+    ESP_LOGE(TAG, "No memory for %u byte audio capture", (unsigned)size);
+    return ESP_ERR_NO_MEM;
+  }
+
+  blocks = (audio_capture_block_t *)mem;
+  ring = (int16_t *)(blocks + RING_BLOCKS);
+  ESP_LOGI(TAG, "%d+%d ms around decode failures, %u bytes", AUDIO_CAPTURE_PRE_MS, AUDIO_CAPTURE_POST_MS,
+           (unsigned)size);
+  return ESP_OK;
+}
+
+void audio_capture_block(const dsp_chain_state_t *state, const int16_t *samples, int stride, int n) {
+  if (!ring) {
+    return;
+  }
+
+  portENTER_CRITICAL(&capture_lock);
+  block_open = !frozen && !dumping && (uint32_t)n <= RING_SAMPLES;
+  if (block_open) {
+    audio_capture_block_t *b = &blocks[started++ % RING_BLOCKS];
+    b->start = total;
+    b->len = n;
+    b->edges_crc = 0;
+    b->state = *state;
+
+    for (int i = 0; i < n; i++) {
+      ring[write_pos] = samples[i * stride];
+      write_pos = (write_pos + 1 == RING_SAMPLES) ? 0 : write_pos + 1;
+    }
+    total += n;
+
+    if (triggered && total - trigger_at >= POST_SAMPLES) {
+      frozen = true;
+    }
+  }
+  portEXIT_CRITICAL(&capture_lock);
+}
+
+void audio_capture_edge(int32_t e) {
+  portENTER_CRITICAL(&capture_lock);
+  if (block_open) {
+    audio_capture_block_t *b = &blocks[(started - 1) % RING_BLOCKS];
+    b->edges_crc = crc32_update(b->edges_crc, &e, sizeof(e));
+  }
+  portEXIT_CRITICAL(&capture_lock);
+}
+
+void audio_capture_trigger(void) {
+  portENTER_CRITICAL(&capture_lock);
+  if (!triggered) {
+    triggered = true;
+    trigger_at = total;
+  }
+  portEXIT_CRITICAL(&capture_lock);
+}
+
+static void print_hex(const void *data, size_t len) {
+  static const char digits[] = "0123456789abcdef";
+  char line[2 * LINE_SAMPLES * sizeof(int16_t) + 1];
+  const uint8_t *p = (const uint8_t *)data;
+
+  for (size_t i = 0; i < len; i++) {
+    line[2 * i] = digits[p[i] >> 4];
+    line[2 * i + 1] = digits[p[i] & 0x0F];
+  }
+  line[2 * len] = 0;
+  printf("AUD %s\n", line);
+}
+
+static void print_samples(uint32_t pos, uint32_t len) {
+  int16_t line[LINE_SAMPLES];
+
+  while (len > 0) {
+    uint32_t n = len < LINE_SAMPLES ? len : LINE_SAMPLES;
+    for (uint32_t i = 0; i < n; i++) {
+      line[i] = ring[pos];
+      pos = (pos + 1 == RING_SAMPLES) ? 0 : pos + 1;
+    }
+    print_hex(line, n * sizeof(int16_t));
+    len -= n;
+  }
+}
+
+void audio_capture_dump(void) {
+  if (!ring) {
+    printf("# audio capture is off\n");
+    return;
+  }
+
+  dsp_chain_params_t params;
+  portENTER_CRITICAL(&capture_lock);
+  dumping = true;
+  block_open = false;
+  params = chain_params;
+  portEXIT_CRITICAL(&capture_lock);
+
+  // oldest block whose samples are all still in the ring
+  uint32_t n = 0;
+  while (n < started && n < RING_BLOCKS) {
+    const audio_capture_block_t *b = &blocks[(started - 1 - n) % RING_BLOCKS];
+    if (total - b->start > RING_SAMPLES) {
+      break;
+    }
+    n++;
+  }
+
+  audio_capture_header_t h = {
+      .magic = AUDIO_CAPTURE_MAGIC,
+      .sample_rate = AUDIO_CAPTURE_SAMPLE_RATE,
+      .blocks = n,
+      .trigger = triggered ? trigger_at : AUDIO_CAPTURE_NO_TRIGGER,
+      .params = params,
+  };
+
+  printf("# %lu blocks, %s\n", (unsigned long)n, triggered ? (frozen ? "decode failure" : "decode failure, partial")
+                                                           : "no decode failure");
+  print_hex(&h, sizeof(h));
+  for (uint32_t i = started - n; i != started; i++) {
+    const audio_capture_block_t *b = &blocks[i % RING_BLOCKS];
+    uint32_t back = total - b->start;
+    uint32_t pos = write_pos >= back ? write_pos - back : write_pos + RING_SAMPLES - back;
+    print_hex(b, sizeof(*b));
+    print_samples(pos, b->len);
+  }
+  printf("AUD end\n");
+
+  portENTER_CRITICAL(&capture_lock);
+  dumping = false;
+  triggered = false;
+  frozen = false;
+  if (stale) {
+    started = 0;
+    stale = false;
+  }
+  portEXIT_CRITICAL(&capture_lock);
+}
+
+void audio_capture_clear(void) {
+  portENTER_CRITICAL(&capture_lock);
+  started = 0;
+  block_open = false;
+  triggered = false;
+  frozen = false;
+  portEXIT_CRITICAL(&capture_lock);
+}
+
+void audio_capture_set_params(const dsp_chain_params_t *params) {
+  portENTER_CRITICAL(&capture_lock);
+  chain_params = *params;
+  if (dumping) {
+    stale = true; // the dump is printing the old blocks
+  } else {
+    started = 0;
+    block_open = false;
+    triggered = false;
+    frozen = false;
+  }
+  portEXIT_CRITICAL(&capture_lock);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file audio_capture.h
+ * @brief Ring of raw input samples around decode failures, for post-mortem replay through the DSP chain.
+ *
+ * The DSP element copies every input block (one channel, as int16) into a ring together with a copy of the chain
+ * state at the start of the block. When the decoder gives up on a character (audio_capture_trigger) the ring keeps
+ * recording for CONFIG_AUDIO_CAPTURE_POST_MS and then freezes, holding CONFIG_AUDIO_CAPTURE_PRE_MS before the
+ * failure. The "audio" console command dumps the snapshot and re-arms the trigger, tools/audio_replay replays it.
+ *
+ * The ring is allocated once by audio_capture_init (PSRAM when available), recording is a copy, no allocation.
+ * New chain settings (audio_capture_set_params) drop the ring, a snapshot is always replayable with one set.
+ *
+ * Dump format, little endian: audio_capture_header_t, then per block audio_capture_block_t followed by len int16
+ * samples, oldest block first.
+ */
+#ifndef AUDIO_CAPTURE_H_
+#define AUDIO_CAPTURE_H_
+
+#include <esp_err.h>
+#include <stdint.h>
+
+#include "dsp_chain.h"
+
+#define AUDIO_CAPTURE_MAGIC (0x36445541) // "AUD6"
+// No trigger in the snapshot
+#define AUDIO_CAPTURE_NO_TRIGGER (UINT32_MAX)
+
+typedef struct {
+  uint32_t magic;
+  uint32_t sample_rate;
+  uint32_t blocks;                          // number of blocks that follow
+  uint32_t trigger;                         // sample index of the failure, AUDIO_CAPTURE_NO_TRIGGER if none
+  dsp_chain_params_t params;                // chain settings, filter coefficients as computed by the device
+} audio_capture_header_t;
+
+typedef struct {
+  uint32_t start;          // sample index of the first sample, free running
+  uint32_t len;            // number of samples
+  uint32_t edges_crc;      // crc32 of the edges the device produced from this block
+  dsp_chain_state_t state; // chain state at the start of the block
+} audio_capture_block_t;
+
+/** Allocates the ring, recording is off if this fails. */
+esp_err_t audio_capture_init(const dsp_chain_params_t *params);
+
+/** The chain changed settings, drops the ring and re-arms the trigger. Called by the DSP element between blocks. */
+void audio_capture_set_params(const dsp_chain_params_t *params);
+
+/**
+ * @brief Records a block, called by the DSP element before processing it.
+ *
+ * @param state chain state at the start of the block
+ * @param samples interleaved input samples
+ * @param stride distance between samples of the recorded channel
+ * @param n number of samples of the channel
+ */
+void audio_capture_block(const dsp_chain_state_t *state, const int16_t *samples, int stride, int n);
+
+/** Adds an edge produced from the last recorded block, lets the replay check it is bit exact. */
+void audio_capture_edge(int32_t e);
+
+/** Marks a decode failure, ignored while a snapshot is pending. Any task. */
+void audio_capture_trigger(void);
+
+/** Prints the ring to stdout as text lines, "AUD <hex>", that tools/audio_replay reads back. Re-arms the trigger. */
+void audio_capture_dump(void);
+
+/** Drops everything recorded so far and re-arms the trigger. */
+void audio_capture_clear(void);
+
+#endif // AUDIO_CAPTURE_H_
@@ -2,56 +2,133 @@
 
 #include "audio_element.h"
 #include "audio_mem.h"
+#include "esp_cpu.h"
 #include "esp_err.h"
 #include "esp_log.h"
-#include <dsp_common.h>
-#include <dsps_biquad.h>
+#include "ringbuf.h"
+#include "sdkconfig.h"
 #include <dsps_biquad_gen.h>
-#include <dsps_d_gen.h>
-#include <dsps_fft2r.h>
-#include <dsps_view.h>
+#include <esp_timer.h>
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "audio_capture.h"
+#include "cw_gen.h"
+#include "dsp_chain.h"
+#include "latency.h"
 #include "morse.h"
-#include "ook_edge_detector.h"
+#include "params.h"
+#include "static_alloc.h"
+#include "telemetry.h"
+#include "trace.h"
 
 static const char *TAG = "AUD";
 
 typedef struct audio_dsp {
   uint32_t cnt;
-  float coeffs_bpf[AUDIO_DSP_FILTER_LEN];
-  float coeffs_lpf_envelope[AUDIO_DSP_FILTER_LEN];
-  float wfb[AUDIO_DSP_FILTER_LEN];
-  float wfe[AUDIO_DSP_FILTER_LEN];
-
-  ook_edge_detector_t ook_edge;
+  uint64_t sample; // index of the next input sample (one channel), edges are stamped with it
+  uint32_t params_generation;
+  dsp_chain_t chain;
+  audio_dsp_stats_t stats;
+  bool nb_wanted;        // noise blanker setting, load shedding may keep it off
+  int overload_run;      // overloaded blocks in a row
+  uint32_t calm_samples; // samples processed since the element caught up
+#ifdef CONFIG_SELFTEST_LOOPBACK
+  cw_gen_t gen; // replaces the right channel output
+#endif
 } audio_dsp_t;
 
-// Decay coefficient applied to current min/max on each callback
-static float DECAY = 0.010;
+static uint32_t fraction_to_u32(float f) {
+  double d = (double)f * UINT32_MAX;
+  return d >= UINT32_MAX ? UINT32_MAX : (d <= 0 ? 0 : (uint32_t)d);
+}
+
+// Chain settings from a copy of the parameter registry
+static void load_params(const float *v, dsp_chain_params_t *p) {
+  ESP_ERROR_CHECK(dsps_biquad_gen_bpf_f32(p->coeffs_bpf, v[PARAM_BPF_HZ] / MORSE_SAMPLE_RATE, v[PARAM_BPF_Q]));
+  ESP_ERROR_CHECK(dsps_biquad_gen_lpf_f32(p->coeffs_lpf, v[PARAM_LPF_HZ] / MORSE_SAMPLE_RATE, 0.707f));
+  p->decay = v[PARAM_ENV_DECAY];
+  p->ook_high = fraction_to_u32(v[PARAM_OOK_HIGH]);
+  p->ook_low = fraction_to_u32(v[PARAM_OOK_LOW]);
+  p->squelch_open = v[PARAM_SQUELCH] > 0 ? powf(10.0f, v[PARAM_SQUELCH] / 20) : 0.0f;
+  p->squelch_hang = (uint32_t)(v[PARAM_SQUELCH_HANG] * MORSE_SAMPLE_RATE / 1000);
+  p->ook_adapt = v[PARAM_OOK_ADAPT];
+}
+
+// The noise blanker setting lives with its state, load shedding may keep it off
+static void load_noise_blanker(audio_dsp_t *mod, const float *v) {
+  noise_blanker_t *nb = &mod->chain.s.nb;
+  mod->nb_wanted = v[PARAM_NB] > 0.5f;
+  nb->threshold_mult = v[PARAM_NB_MULT];
+  noise_blanker_set_enabled(nb, mod->nb_wanted && mod->stats.shed < AUDIO_DSP_SHED_OPTIONAL);
+}
+
+static void set_shed(audio_dsp_t *mod, audio_dsp_shed_t shed, int fill, int load) {
+  audio_dsp_stats_t *stats = &mod->stats;
+  stats->shed = shed;
+  stats->shed_max = shed > stats->shed_max ? shed : stats->shed_max;
+  noise_blanker_set_enabled(&mod->chain.s.nb, mod->nb_wanted && shed < AUDIO_DSP_SHED_OPTIONAL);
+  telemetry_record_shed(shed);
+  TRACE(TLM, TRACE_SHED, shed, fill, (int16_t)(load < INT16_MAX ? load : INT16_MAX));
+}
+
+// Steps load shedding up after a run of overloaded blocks, down after a calm stretch
+static void update_shedding(audio_element_handle_t self, audio_dsp_t *mod, int n, int64_t elapsed_us) {
+#ifndef CONFIG_REPLAY_MAX_SPEED
+  ringbuf_handle_t rb = audio_element_get_input_ringbuf(self);
+  int size = rb ? rb_get_size(rb) : 0;
+  int fill = size > 0 ? 100 * rb_bytes_filled(rb) / size : 0;
+  // percent of the block duration, n samples take n / MORSE_SAMPLE_RATE seconds
+  int load = (int)(elapsed_us * MORSE_SAMPLE_RATE / (10000 * (int64_t)n));
+  audio_dsp_stats_t *stats = &mod->stats;
+
+  if (fill > AUDIO_DSP_OVERLOAD_FILL || load > AUDIO_DSP_OVERLOAD_LOAD) {
+    stats->overloaded++;
+    mod->calm_samples = 0;
+    if (++mod->overload_run >= AUDIO_DSP_OVERLOAD_BLOCKS && stats->shed + 1 < AUDIO_DSP_SHED_LEVELS) {
+      set_shed(mod, stats->shed + 1, fill, load);
+      mod->overload_run = 0;
+    }
+    return;
+  }
+
+  mod->overload_run = 0;
+  if (fill >= AUDIO_DSP_RECOVER_FILL || load >= AUDIO_DSP_RECOVER_LOAD) {
+    mod->calm_samples = 0;
+    return;
+  }
+  mod->calm_samples += n;
+  if (stats->shed > AUDIO_DSP_SHED_NONE && mod->calm_samples >= AUDIO_DSP_RECOVER_MS * MORSE_SAMPLE_RATE / 1000) {
+    set_shed(mod, stats->shed - 1, fill, load);
+    mod->calm_samples = 0;
+  }
+#endif
+}
 
-static float smax = -MAXFLOAT / 2;
-static float smin = MAXFLOAT / 2;
+static void on_edge(int32_t e, float range, uint64_t sample, void *ctx) {
+  audio_capture_edge(e);
+  ESP_ERROR_CHECK(morse_sample(e, range, sample));
+}
 
 /**
  * Audio DSP.
  * Reads stereo samples, passes one channel through for reference/debugging.
  * Second channels is processed through
+ *   Noise blanker =>
  *   BPF(750Hz) =>
  *   Envelope detector =>
  *   LPF =>
  *   Rescaling => Audio output (for debugging)
  *             => OOK edge detector => Morse decoder
  *
+ * The chain itself is in dsp_chain.c, raw input is also tapped into the audio capture ring.
+ * With the loopback self-test the CW generator replaces the pass-through channel.
+ * Sheds load in steps when it falls behind, see audio_dsp_shed_t.
  */
 static int _dsp_process(audio_element_handle_t self, char *in_buffer, int in_len) {
-  __attribute__((aligned(16))) static float input[AUDIO_DSP_N_SAMPLES];
-  __attribute__((aligned(16))) static float output[AUDIO_DSP_N_SAMPLES];
-
   audio_dsp_t *mod = (audio_dsp_t *)audio_element_getdata(self);
 
   int r_size = audio_element_input(self, in_buffer, in_len); // Read data
@@ -81,85 +158,59 @@ static int _dsp_process(audio_element_handle_t self, char *in_buffer, int in_len
 
   mod->cnt++;
 
+  // new settings take effect between blocks, no locks: a torn copy is retried on the next block
+  float v[PARAM_COUNT];
+  if (params_generation() != mod->params_generation && params_snapshot(v, &mod->params_generation)) {
+    dsp_chain_params_t p;
+    load_params(v, &p);
+    dsp_chain_set_params(&mod->chain, &p);
+    load_noise_blanker(mod, v);
+    audio_capture_set_params(&p);
+    TRACE(TLM, TRACE_SETTINGS, (int32_t)mod->params_generation, 0, 0);
+  }
+
   // If we got here, r_size > 0, process the audio data
   // Assuming 16-bit signed integer samples
   int16_t *samples = (int16_t *)in_buffer;
   int num_samples = r_size / sizeof(int16_t);
   int num_samples_filter = num_samples / 2; // 1 channel only
 
-  /* ESP_LOGW(TAG, "cnt: %ul, num_samples: %d, in_len: %d", (unsigned
-   * int)mod->cnt, */
-  /*          num_samples, in_len); */
-
-  if (num_samples_filter > AUDIO_DSP_N_SAMPLES) {
-    return ESP_FAIL;
-  }
-
-  for (int i = 0; i < num_samples_filter; i++) {
-    input[i] = (float)samples[i * 2];
-  }
-
-  // BPF
-  ESP_ERROR_CHECK(dsps_biquad_f32(input, output, num_samples_filter, mod->coeffs_bpf, mod->wfb));
-
-  // Envelope
-  for (int i = 0; i < num_samples_filter; i++) {
-    input[i] = fabs(output[i]);
-  }
-
-  // LPF over envelope
-  ESP_ERROR_CHECK(dsps_biquad_f32(input, output, num_samples_filter, mod->coeffs_lpf_envelope,
-                                  mod->wfe)); // memcpy(output, input, num_samples_filter * sizeof(float));
-
-  // Shrinking min/max to account for signal fade in/out
-  smax = smax - DECAY * fabs(smax);
-  smin = smin + DECAY * fabs(smin);
-
-  for (int i = 0; i < num_samples_filter; i++) {
-    if (smin > output[i]) {
-      smin = output[i];
-    }
-    if (smax < output[i]) {
-      smax = output[i];
-    }
+#ifdef CONFIG_AUDIO_SOURCE_SELFTEST
+  latency_dsp_block(mod->sample + num_samples_filter);
+#endif
+
+  int64_t start_us = esp_timer_get_time();
+  uint32_t start = esp_cpu_get_cycle_count();
+  // blocks larger than the chain buffers go through in chunks, each one a block of the audio capture
+  for (int off = 0; off < num_samples_filter; off += AUDIO_DSP_N_SAMPLES) {
+    int n = num_samples_filter - off < AUDIO_DSP_N_SAMPLES ? num_samples_filter - off : AUDIO_DSP_N_SAMPLES;
+    audio_capture_block(&mod->chain.s, samples + 2 * off, 2, n);
+    dsp_chain_process(&mod->chain, samples + 2 * off, 2, n, mod->sample, on_edge, NULL);
+    mod->sample += n;
   }
-
-  if (smin >= smax) {
-    smin = smax - 0.1;
+  uint32_t cycles = esp_cpu_get_cycle_count() - start;
+  if (num_samples_filter > 0) {
+    update_shedding(self, mod, num_samples_filter, esp_timer_get_time() - start_us);
   }
 
-  float range = smax - smin;
-  float scale = range / (float)UINT32_MAX;
-
-  // ESP_LOGV(TAG, "Smin: %0.3f, Smax: %0.3f, Range: %0.3f, Scale: %0.7f", smin, smax, range, scale);
-
-  // Convert back to stereo output and run OOK decoder
-  for (int i = 0; i < num_samples_filter; i++) {
-    float val_float = (output[i] - smin) / scale;
-    uint32_t s;
-
-    if (val_float <= 0.0f) {
-      s = 0;
-    } else if (val_float >= (float)UINT32_MAX) {
-      // (float)UINT32_MAX is typically 4294967296.0f (i.e., 2^32f) due to rounding.
-      // If val_float is this large or larger, it should be clamped to UINT32_MAX.
-      s = UINT32_MAX;
-    } else {
-      // val_float is in the range (0.0f, 2^32f).
-      // Casting this to uint32_t is safe and will result in a value
-      // from 0 to UINT32_MAX. For example, if val_float is 4294967295.999...
-      // (and still less than 2^32f), its (uint32_t) cast will be 4294967295.
-      s = (uint32_t)val_float;
-    }
-
-    samples[i * 2] = (s >> 16) + INT16_MIN;
-
-    int32_t e = ook_edge_detector_update(&mod->ook_edge, s);
-
-    if (e != 0) {
-      ESP_ERROR_CHECK(morse_sample(e, range));
-    }
+  audio_dsp_stats_t *stats = &mod->stats;
+  stats->cycles_min = (stats->blocks == 0 || cycles < stats->cycles_min) ? cycles : stats->cycles_min;
+  stats->cycles_max = cycles > stats->cycles_max ? cycles : stats->cycles_max;
+  stats->cycles += cycles;
+  stats->samples += num_samples_filter;
+  stats->blocks++;
+
+#ifdef CONFIG_SELFTEST_LOOPBACK
+  cw_gen_fill(&mod->gen, samples + 1, 2, num_samples_filter);
+  latency_source_block(mod->gen.sample);
+#endif
+
+#ifndef CONFIG_SELFTEST_LOOPBACK
+  // first to go when falling behind, the loopback self-test keeps it for its generator output
+  if (mod->stats.shed >= AUDIO_DSP_SHED_PASSTHROUGH) {
+    return r_size;
   }
+#endif
 
   // Write the modified data to the output ringbuffer
   int w_size = audio_element_output(self, in_buffer, r_size);
@@ -169,6 +220,7 @@ static int _dsp_process(audio_element_handle_t self, char *in_buffer, int in_len
     // Successfully wrote all data
     return w_size;
   } else if (w_size == AEL_IO_TIMEOUT) {
+    mod->stats.output_timeouts++;
     ESP_LOGW(TAG, "Output ringbuffer timeout (wrote %d/%d bytes)", w_size, r_size);
     // Output buffer likely full. Element should wait and retry, which
     // returning ESP_OK effectively does (the element's task loop will call
@@ -202,6 +254,8 @@ static esp_err_t _dsp_close(audio_element_handle_t self) {
   ESP_LOGI(TAG, "Dsp element closed");
   audio_dsp_t *mod = (audio_dsp_t *)audio_element_getdata(self);
   ESP_LOGI(TAG, "Dsp CNT: %ul", (unsigned int)mod->cnt);
+  ESP_LOGI(TAG, "Noise blanker: %lu samples blanked, %lu signal sub-blocks passed", (unsigned long)mod->chain.s.nb.blanked,
+           (unsigned long)mod->chain.s.nb.passed);
 
   // Check status, might be useful for debugging why it closed
   if (audio_element_is_stopping(self)) {
@@ -222,7 +276,7 @@ static esp_err_t _dsp_destroy(audio_element_handle_t self) {
   audio_dsp_t *mod = (audio_dsp_t *)audio_element_getdata(self);
 
   if (mod) {
-    audio_free(mod);
+    STATIC_ELEMENT_FREE(mod);
   }
   ESP_LOGD(TAG, "Dsp element destroyed");
   return ESP_OK;
@@ -233,18 +287,32 @@ static esp_err_t _dsp_destroy(audio_element_handle_t self) {
  */
 audio_element_handle_t audio_dsp_init(audio_dsp_cfg_t *config) {
   // Allocate memory for the element's specific data
-  audio_dsp_t *mod = audio_calloc(1, sizeof(audio_dsp_t));
+  audio_dsp_t *mod = STATIC_ELEMENT_CALLOC(audio_dsp_t);
   AUDIO_MEM_CHECK(TAG, mod, {
     ESP_LOGE(TAG, "Failed to allocate memory for audio_dsp_t");
     return NULL;
   });
 
-  ook_edge_detector_init(&mod->ook_edge);
+  // Init filters, 750Hz band-pass by default, see params.c
+  float v[PARAM_COUNT];
+  dsp_chain_params_t p;
+  while (!params_snapshot(v, &mod->params_generation)) {
+  }
+  load_params(v, &p);
+  dsp_chain_init(&mod->chain, p.coeffs_bpf, p.coeffs_lpf);
+  dsp_chain_set_params(&mod->chain, &p);
+  load_noise_blanker(mod, v);
+
+  if (audio_capture_init(&p) != ESP_OK) {
+    ESP_LOGW(TAG, "No audio capture");
+  }
 
-  // Init filters
-  // 44100 750Hz
-  ESP_ERROR_CHECK(dsps_biquad_gen_bpf_f32(mod->coeffs_bpf, 0.017, 20.0f));
-  ESP_ERROR_CHECK(dsps_biquad_gen_lpf_f32(mod->coeffs_lpf_envelope, 0.00050, 0.707f));
+#ifdef CONFIG_SELFTEST_LOOPBACK
+  cw_gen_init(&mod->gen, CONFIG_SELFTEST_TEXT, CONFIG_SELFTEST_WPM, CONFIG_SELFTEST_FREQ, 8000.0f, 44100,
+              latency_keyup, NULL);
+  latency_start(esp_timer_get_time, 44100, mod->gen.dit);
+  ESP_LOGI(TAG, "Loopback self-test on the right channel output");
+#endif
 
   // Basic audio element configuration
   audio_element_cfg_t cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
@@ -263,7 +331,7 @@ audio_element_handle_t audio_dsp_init(audio_dsp_cfg_t *config) {
   audio_element_handle_t el = audio_element_init(&cfg);
   AUDIO_MEM_CHECK(TAG, el, {
     ESP_LOGE(TAG, "Failed to initialize audio element");
-    audio_free(mod);
+    STATIC_ELEMENT_FREE(mod);
     return NULL;
   });
 
@@ -276,3 +344,8 @@ audio_element_handle_t audio_dsp_init(audio_dsp_cfg_t *config) {
   ESP_LOGD(TAG, "Audio DSP element initialized successfully");
   return el;
 }
+
+void audio_dsp_get_stats(audio_element_handle_t self, audio_dsp_stats_t *stats) {
+  audio_dsp_t *mod = (audio_dsp_t *)audio_element_getdata(self);
+  *stats = mod->stats;
+}
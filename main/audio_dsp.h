@@ -5,6 +5,8 @@
 #include "audio_error.h"
 #include "esp_err.h"
 
+#include "dsp_chain.h"
+
 /**
  * @brief   Audio DSP Element configurations
  */
@@ -22,8 +24,8 @@ typedef struct {
 #define AUDIO_DSP_TASK_CORE (0)
 #define AUDIO_DSP_TASK_PRIO (5)
 #define AUDIO_DSP_RINGBUFFER_SIZE (8 * 1024) // Output buffer size
-#define AUDIO_DSP_N_SAMPLES (1024)
-#define AUDIO_DSP_FILTER_LEN (5)
+#define AUDIO_DSP_N_SAMPLES (DSP_CHAIN_MAX_SAMPLES)
+#define AUDIO_DSP_FILTER_LEN (DSP_CHAIN_COEFFS)
 
 /**
  * @brief Default configuration macro for the audio DSP element.
@@ -37,6 +39,41 @@ typedef struct {
       .extern_stack = false,                                                                                           \
   }
 
+/**
+ * Load shedding steps. The element falls behind real time when its input ringbuffer fills up or a block takes
+ * most of its own duration to process; it then drops work one step at a time and restores it once it has
+ * caught up. Not used when replaying at max speed, where a full input ringbuffer is normal.
+ */
+typedef enum {
+  AUDIO_DSP_SHED_NONE,        // full processing
+  AUDIO_DSP_SHED_PASSTHROUGH, // nothing goes to the DAC
+  AUDIO_DSP_SHED_OPTIONAL,    // no noise blanker either
+  AUDIO_DSP_SHED_LEVELS,
+} audio_dsp_shed_t;
+
+// Overloaded: input ringbuffer fill or block processing time (percent of the block duration) above these...
+#define AUDIO_DSP_OVERLOAD_FILL (75)
+#define AUDIO_DSP_OVERLOAD_LOAD (80)
+// ...for this many blocks in a row sheds the next step
+#define AUDIO_DSP_OVERLOAD_BLOCKS (8)
+// Caught up: both below these for AUDIO_DSP_RECOVER_MS restores a step
+#define AUDIO_DSP_RECOVER_FILL (25)
+#define AUDIO_DSP_RECOVER_LOAD (50)
+#define AUDIO_DSP_RECOVER_MS (2000)
+
+// Cost of the DSP work (capture tap and signal chain), CPU cycles per block
+typedef struct {
+  uint32_t blocks;
+  uint64_t samples; // per channel
+  uint64_t cycles;  // total
+  uint32_t cycles_min;
+  uint32_t cycles_max;
+  uint32_t overloaded;       // blocks over the overload thresholds
+  uint32_t output_timeouts;  // blocks the output ringbuffer did not take
+  audio_dsp_shed_t shed;     // current load shedding step
+  audio_dsp_shed_t shed_max; // deepest step so far
+} audio_dsp_stats_t;
+
 /**
  * @brief      Create an AudioElement handle to process incoming data samples.
  * This element reads audio data, divides each sample by 2, and writes it out.
@@ -48,4 +85,9 @@ typedef struct {
  */
 audio_element_handle_t audio_dsp_init(audio_dsp_cfg_t *config);
 
+/**
+ * @brief      Cycle counts of the blocks processed so far.
+ */
+void audio_dsp_get_stats(audio_element_handle_t self, audio_dsp_stats_t *stats);
+
 #endif /* _AUDIO_DSP_H_ */
@@ -0,0 +1,57 @@
+#include "boot.h"
+
+#include "freertos/FreeRTOS.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "BOOT";
+
+static struct {
+  const char *name;
+  int64_t us;
+} marks[BOOT_MAX_MARKS];
+static int n_marks = 0;
+static portMUX_TYPE marks_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int find(const char *name) {
+  for (int i = 0; i < n_marks; i++) {
+    if (strcmp(marks[i].name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void boot_mark(const char *name) {
+  int64_t now = esp_timer_get_time();
+  bool added = false;
+
+  portENTER_CRITICAL(&marks_lock);
+  if (n_marks < BOOT_MAX_MARKS && find(name) < 0) {
+    marks[n_marks].name = name;
+    marks[n_marks].us = now;
+    n_marks++;
+    added = true;
+  }
+  portEXIT_CRITICAL(&marks_lock);
+
+  if (added) {
+    ESP_LOGI(TAG, "%s at %.1f ms", name, now / 1000.0);
+  }
+}
+
+void boot_print(void) {
+  portENTER_CRITICAL(&marks_lock);
+  int n = n_marks;
+  portEXIT_CRITICAL(&marks_lock);
+
+  // entries below n are never changed again
+  printf("%-16s %10s %10s\n", "milestone", "ms", "+ms");
+  for (int i = 0; i < n; i++) {
+    int64_t prev = i > 0 ? marks[i - 1].us : 0;
+    printf("%-16s %10.1f %10.1f\n", marks[i].name, marks[i].us / 1000.0, (marks[i].us - prev) / 1000.0);
+  }
+}
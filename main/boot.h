@@ -0,0 +1,24 @@
+/**
+ * @file boot.h
+ * @brief Boot milestones: uptime when each part of the startup is done, up to the first decoded character.
+ *
+ * Every milestone is logged as it is reached (`BOOT: codec at 212.4 ms`), the "boot" console command prints
+ * them all. Milestones can be marked from any task, each name once, the first mark counts.
+ */
+#ifndef BOOT_H_
+#define BOOT_H_
+
+// Milestones kept, later ones are dropped
+#define BOOT_MAX_MARKS (16)
+
+/**
+ * @brief Records the current uptime for a milestone.
+ *
+ * @param name a string literal, e.g. "codec"
+ */
+void boot_mark(const char *name);
+
+/** Prints the milestones with their uptime and the time since the previous one to stdout. */
+void boot_print(void);
+
+#endif // BOOT_H_
@@ -0,0 +1,178 @@
+#include "console.h"
+
+#include <esp_console.h>
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_capture.h"
+#include "boot.h"
+#include "edge_capture.h"
+#include "health.h"
+#include "latency.h"
+#include "params.h"
+#include "transcript.h"
+
+static const char *TAG = "CONSOLE";
+
+static int cmd_edges(int argc, char **argv) {
+  if (argc > 1 && strcmp(argv[1], "clear") == 0) {
+    edge_capture_clear();
+  } else {
+    edge_capture_dump();
+  }
+  return 0;
+}
+
+static int cmd_audio(int argc, char **argv) {
+  if (argc > 1 && strcmp(argv[1], "clear") == 0) {
+    audio_capture_clear();
+  } else {
+    audio_capture_dump();
+  }
+  return 0;
+}
+
+static int cmd_latency(int argc, char **argv) {
+  if (argc > 1 && strcmp(argv[1], "clear") == 0) {
+    latency_clear();
+  } else {
+    latency_report();
+  }
+  return 0;
+}
+
+static int cmd_health(int argc, char **argv) {
+  health_print();
+  return 0;
+}
+
+static int cmd_boot(int argc, char **argv) {
+  boot_print();
+  return 0;
+}
+
+static int cmd_transcript(int argc, char **argv) {
+  uint64_t begin, end;
+  transcript_get_range(&begin, &end);
+
+  uint64_t offset = transcript_boot_offset();
+  if (argc > 1) {
+    char *end_boot, *end_ms = "";
+    unsigned long boot = strtoul(argv[1], &end_boot, 10);
+    unsigned long ms = argc > 2 ? strtoul(argv[2], &end_ms, 10) : 0;
+    if (end_boot == argv[1] || *end_boot != '\0' || *end_ms != '\0') {
+      printf("Invalid boot or uptime\n");
+      return 1;
+    }
+    offset = transcript_find((uint32_t)boot, (uint32_t)ms);
+  }
+
+  printf("# transcript %" PRIu64 "..%" PRIu64 ", from %" PRIu64 "\n", begin, end, offset);
+  char text[65];
+  size_t n;
+  while ((n = transcript_read(&offset, text, sizeof(text) - 1)) > 0) {
+    text[n] = 0;
+    printf("%s", text);
+  }
+  printf("\n");
+  return 0;
+}
+
+static void print_param(param_id_t id) {
+  const param_desc_t *d = params_desc(id);
+  printf("%-10s %10g  (default %g, %g..%g) %s\n", d->name, params_get(id), d->def, d->min, d->max, d->help);
+}
+
+static int cmd_param(int argc, char **argv) {
+  if (argc < 2) {
+    for (int i = 0; i < PARAM_COUNT; i++) {
+      print_param(i);
+    }
+    return 0;
+  }
+  int id = params_find(argv[1]);
+  if (id < 0) {
+    printf("No parameter '%s'\n", argv[1]);
+    return 1;
+  }
+  if (argc > 2) {
+    char *end;
+    float value = strtof(argv[2], &end);
+    if (end == argv[2] || *end != '\0' || params_set(id, value) != ESP_OK) {
+      const param_desc_t *d = params_desc(id);
+      printf("Invalid %s '%s', range %g..%g and OOK low < high, pulse min < max\n", d->name, argv[2], d->min,
+             d->max);
+      return 1;
+    }
+  }
+  print_param(id);
+  return 0;
+}
+
+esp_err_t console_init(void) {
+  esp_console_repl_t *repl = NULL;
+  esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+  repl_config.prompt = "morse>";
+  esp_console_dev_uart_config_t uart_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+
+  esp_err_t err = esp_console_new_repl_uart(&uart_config, &repl_config, &repl);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create console: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  const esp_console_cmd_t edges = {
+      .command = "edges",
+      .help = "Dump captured OOK edges for tools/edge_replay, 'edges clear' drops them",
+      .hint = "[clear]",
+      .func = cmd_edges,
+  };
+  ESP_ERROR_CHECK(esp_console_cmd_register(&edges));
+  const esp_console_cmd_t audio = {
+      .command = "audio",
+      .help = "Dump raw audio around the last decode failure for tools/audio_replay and re-arm, "
+              "'audio clear' drops it",
+      .hint = "[clear]",
+      .func = cmd_audio,
+  };
+  ESP_ERROR_CHECK(esp_console_cmd_register(&audio));
+  const esp_console_cmd_t latency = {
+      .command = "latency",
+      .help = "Self-test key-up to glyph latency per pipeline stage, 'latency clear' restarts the statistics",
+      .hint = "[clear]",
+      .func = cmd_latency,
+  };
+  ESP_ERROR_CHECK(esp_console_cmd_register(&latency));
+  const esp_console_cmd_t health = {
+      .command = "health",
+      .help = "Core load, heap, DSP ringbuffer peak fill and per task CPU share and free stack of the last period",
+      .func = cmd_health,
+  };
+  ESP_ERROR_CHECK(esp_console_cmd_register(&health));
+  const esp_console_cmd_t boot = {
+      .command = "boot",
+      .help = "Uptime of each boot milestone, from app_main to the first decoded character",
+      .func = cmd_boot,
+  };
+  ESP_ERROR_CHECK(esp_console_cmd_register(&boot));
+  const esp_console_cmd_t transcript = {
+      .command = "transcript",
+      .help = "Decoded text saved in flash, this boot's by default, or from around the uptime (ms) of an earlier boot",
+      .hint = "[boot [ms]]",
+      .func = cmd_transcript,
+  };
+  ESP_ERROR_CHECK(esp_console_cmd_register(&transcript));
+  const esp_console_cmd_t param = {
+      .command = "param",
+      .help = "List the DSP and decoder parameters, show or set one, applied live and not saved",
+      .hint = "[name [value]]",
+      .func = cmd_param,
+  };
+  ESP_ERROR_CHECK(esp_console_cmd_register(&param));
+  ESP_ERROR_CHECK(esp_console_register_help_command());
+
+  return esp_console_start_repl(repl);
+}
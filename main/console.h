@@ -0,0 +1,9 @@
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include <esp_err.h>
+
+/** Starts the serial console (REPL on the log UART) with the decoder debugging commands. */
+esp_err_t console_init(void);
+
+#endif // CONSOLE_H_
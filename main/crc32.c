@@ -0,0 +1,19 @@
+#include "crc32.h"
+
+// nibble at a time, 64 bytes of table instead of 1KB
+static const uint32_t crc_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+
+  crc = ~crc;
+  while (len--) {
+    crc ^= *p++;
+    crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+    crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+  }
+  return ~crc;
+}
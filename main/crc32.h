@@ -0,0 +1,14 @@
+#ifndef CRC32_H_
+#define CRC32_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief CRC-32 (IEEE 802.3, as zlib), portable so records written on the device check the same on a host.
+ *
+ * @param crc 0 to start, previous result to continue over more data
+ */
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+
+#endif // CRC32_H_
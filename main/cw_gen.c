@@ -0,0 +1,97 @@
+#include "cw_gen.h"
+
+#include <math.h>
+
+#include "morse_code_table.h"
+
+// Rise/fall time of an element
+#define CW_GEN_RAMP_S (0.004f)
+
+void cw_gen_init(cw_gen_t *g, const char *text, int wpm, float freq_hz, float amplitude, uint32_t sample_rate,
+                 cw_gen_keyup_fn on_keyup, void *ctx) {
+  g->text = text;
+  g->next = text;
+  g->dit = (uint32_t)(1.2f * sample_rate / wpm);
+  g->level_step = 1.0f / (CW_GEN_RAMP_S * sample_rate);
+  g->level = 0.0f;
+  g->phase = 0.0f;
+  g->phase_inc = 2.0f * (float)M_PI * freq_hz / sample_rate;
+  g->amplitude = amplitude;
+  g->sample = 0;
+  g->c = 0;
+  g->key = MORSE_CODE_KEY_EMPTY;
+  g->element = 0;
+  g->on = false;
+  g->left = 0;
+  g->on_keyup = on_keyup;
+  g->ctx = ctx;
+}
+
+// gap before the next character, loads it
+static uint32_t next_char(cw_gen_t *g) {
+  uint32_t gap = 3 * g->dit;
+  int wraps = 0;
+
+  g->key = MORSE_CODE_KEY_EMPTY;
+  g->element = 0;
+  while (wraps < 2) {
+    if (*g->next == 0) {
+      g->next = g->text;
+      gap = 7 * g->dit;
+      wraps++;
+      continue;
+    }
+    char c = *g->next++;
+    uint16_t key = morse_code_key_of(c);
+    if (c == ' ') {
+      gap = 7 * g->dit;
+    } else if (key != MORSE_CODE_KEY_EMPTY) {
+      g->c = c;
+      g->key = key;
+      return gap;
+    }
+  }
+  return gap; // nothing to send, silence
+}
+
+static void next_segment(cw_gen_t *g) {
+  int len = morse_code_key_len(g->key);
+
+  if (g->on) {
+    g->on = false;
+    if (g->element == len) {
+      if (g->on_keyup) {
+        g->on_keyup(g->c, g->sample, g->ctx);
+      }
+      g->left = next_char(g);
+    } else {
+      g->left = g->dit;
+    }
+  } else if (g->element < len) {
+    g->on = true;
+    g->left = ((g->key >> (len - 1 - g->element)) & 1) ? 3 * g->dit : g->dit;
+    g->element++;
+  } else {
+    // start, or a text without codes
+    g->left = next_char(g);
+  }
+}
+
+void cw_gen_fill(cw_gen_t *g, int16_t *out, int stride, int n) {
+  for (int i = 0; i < n; i++) {
+    while (g->left == 0) {
+      next_segment(g);
+    }
+    g->left--;
+
+    g->level += g->on ? g->level_step : -g->level_step;
+    g->level = g->level > 1.0f ? 1.0f : (g->level < 0.0f ? 0.0f : g->level);
+
+    out[i * stride] = (int16_t)(g->amplitude * g->level * sinf(g->phase));
+    g->phase += g->phase_inc;
+    if (g->phase > 2.0f * (float)M_PI) {
+      g->phase -= 2.0f * (float)M_PI;
+    }
+    g->sample++;
+  }
+}
@@ -0,0 +1,50 @@
+/**
+ * @file cw_gen.h
+ * @brief Keyed tone generator for self-tests, plays a text as CW with known key-up sample indexes.
+ *
+ * Timing is PARIS (dit = 1.2 / wpm seconds), elements have short linear ramps so the tone does not click.
+ * The text repeats with a word gap between repetitions. A character's key-up is the sample where its last
+ * element starts to fall, it is reported through the callback before the sample is produced. Platform free,
+ * runs in the self-test source element on the device and in tools/selftest_sim.
+ */
+#ifndef CW_GEN_H_
+#define CW_GEN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Called when a character's last element ends, sample is its index since cw_gen_init. */
+typedef void (*cw_gen_keyup_fn)(char c, uint64_t sample, void *ctx);
+
+typedef struct {
+  const char *text;
+  const char *next; // next character of text
+  uint32_t dit;     // samples
+  float level_step; // ramp slope, per sample
+  float level;      // envelope, 0..1
+  float phase;
+  float phase_inc;
+  float amplitude;
+  uint64_t sample; // index of the next sample
+
+  char c;        // character being sent
+  uint16_t key;  // its code
+  int element;   // next element of the code
+  bool on;       // key down
+  uint32_t left; // samples left in the current segment
+  cw_gen_keyup_fn on_keyup;
+  void *ctx;
+} cw_gen_t;
+
+/**
+ * @param text characters to send, glyphs without a code are skipped, ' ' is a word gap
+ * @param amplitude peak sample value
+ * @param on_keyup may be NULL
+ */
+void cw_gen_init(cw_gen_t *g, const char *text, int wpm, float freq_hz, float amplitude, uint32_t sample_rate,
+                 cw_gen_keyup_fn on_keyup, void *ctx);
+
+/** Produces the next n samples into out[0], out[stride], ... */
+void cw_gen_fill(cw_gen_t *g, int16_t *out, int stride, int n);
+
+#endif // CW_GEN_H_
@@ -0,0 +1,136 @@
+#include "cw_source.h"
+
+#include "audio_element.h"
+#include "audio_error.h"
+#include "audio_mem.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <esp_timer.h>
+#include <stdint.h>
+
+#include "cw_gen.h"
+#include "latency.h"
+#include "static_alloc.h"
+
+static const char *TAG = "CWSRC";
+
+#define CW_SOURCE_SAMPLE_RATE (44100)
+
+typedef struct cw_source {
+  cw_source_cfg_t cfg;
+  cw_gen_t gen;
+  int64_t t0; // time of sample 0
+  esp_timer_handle_t timer;
+  SemaphoreHandle_t due;
+} cw_source_t;
+
+static void on_timer(void *arg) {
+  cw_source_t *mod = (cw_source_t *)arg;
+  xSemaphoreGive(mod->due);
+}
+
+static esp_err_t _cw_open(audio_element_handle_t self) {
+  cw_source_t *mod = (cw_source_t *)audio_element_getdata(self);
+
+  mod->due = STATIC_BINARY_SEMAPHORE_CREATE();
+  if (mod->due == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  esp_timer_create_args_t args = {.callback = on_timer, .arg = mod, .name = "cw_source"};
+  esp_err_t err = esp_timer_create(&args, &mod->timer);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create timer: %s", esp_err_to_name(err));
+    vSemaphoreDelete(mod->due);
+    return err;
+  }
+
+  cw_gen_init(&mod->gen, mod->cfg.text, mod->cfg.wpm, mod->cfg.freq_hz, mod->cfg.level, CW_SOURCE_SAMPLE_RATE,
+              latency_keyup, NULL);
+  latency_start(esp_timer_get_time, CW_SOURCE_SAMPLE_RATE, mod->gen.dit);
+  mod->t0 = esp_timer_get_time();
+  latency_set_origin(mod->t0);
+  ESP_LOGI(TAG, "Sending \"%s\" at %d wpm, %d Hz", mod->cfg.text, mod->cfg.wpm, mod->cfg.freq_hz);
+  return ESP_OK;
+}
+
+static int _cw_process(audio_element_handle_t self, char *in_buffer, int in_len) {
+  cw_source_t *mod = (cw_source_t *)audio_element_getdata(self);
+  uint32_t n = in_len / (2 * sizeof(int16_t));
+
+  // a block is complete when its last sample is due, like an I2S DMA buffer
+  int64_t due = mod->t0 + (int64_t)((mod->gen.sample + n) * 1000000 / CW_SOURCE_SAMPLE_RATE);
+  int64_t now = esp_timer_get_time();
+  if (due > now) {
+    esp_timer_start_once(mod->timer, due - now);
+    xSemaphoreTake(mod->due, portMAX_DELAY);
+  }
+
+  int16_t *out = (int16_t *)in_buffer;
+  cw_gen_fill(&mod->gen, out, 2, n);
+  for (uint32_t i = 0; i < n; i++) {
+    out[2 * i + 1] = out[2 * i];
+  }
+  latency_source_block(mod->gen.sample);
+
+  int w_size = audio_element_output(self, in_buffer, n * 2 * sizeof(int16_t));
+  if (w_size < 0 && w_size != AEL_IO_TIMEOUT) {
+    ESP_LOGE(TAG, "Error writing to output ringbuffer: %d", w_size);
+    audio_element_report_status(self, AEL_STATUS_ERROR_OUTPUT);
+    return ESP_FAIL;
+  }
+  return w_size;
+}
+
+static esp_err_t _cw_close(audio_element_handle_t self) {
+  cw_source_t *mod = (cw_source_t *)audio_element_getdata(self);
+  if (mod->timer) {
+    esp_timer_stop(mod->timer);
+    esp_timer_delete(mod->timer);
+    mod->timer = NULL;
+    vSemaphoreDelete(mod->due);
+  }
+  return ESP_OK;
+}
+
+static esp_err_t _cw_destroy(audio_element_handle_t self) {
+  cw_source_t *mod = (cw_source_t *)audio_element_getdata(self);
+  if (mod) {
+    STATIC_ELEMENT_FREE(mod);
+  }
+  return ESP_OK;
+}
+
+audio_element_handle_t cw_source_init(cw_source_cfg_t *config) {
+  cw_source_t *mod = STATIC_ELEMENT_CALLOC(cw_source_t);
+  AUDIO_MEM_CHECK(TAG, mod, {
+    ESP_LOGE(TAG, "Failed to allocate memory for cw_source_t");
+    return NULL;
+  });
+  mod->cfg = *config;
+
+  audio_element_cfg_t cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
+  cfg.open = _cw_open;
+  cfg.close = _cw_close;
+  cfg.process = _cw_process;
+  cfg.destroy = _cw_destroy;
+  cfg.tag = "cw_source";
+  cfg.task_stack = config->task_stack;
+  cfg.task_prio = config->task_prio;
+  cfg.task_core = config->task_core;
+  cfg.out_rb_size = config->out_rb_size;
+  cfg.buffer_len = CW_SOURCE_BUF_SIZE;
+
+  audio_element_handle_t el = audio_element_init(&cfg);
+  AUDIO_MEM_CHECK(TAG, el, {
+    ESP_LOGE(TAG, "Failed to initialize audio element");
+    STATIC_ELEMENT_FREE(mod);
+    return NULL;
+  });
+  audio_element_setdata(el, mod);
+
+  audio_element_info_t info = {0};
+  audio_element_setinfo(el, &info);
+  return el;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file cw_source.h
+ * @brief Audio source element for the self-test, keyed tones from the CW generator in place of the I2S reader.
+ *
+ * Blocks are released in realtime the way the I2S reader releases DMA buffers: a block goes out once the
+ * time of its last sample has passed, timed with a one-shot esp_timer. Sample 0 is the latency origin, so
+ * the latency of every pipeline stage from the key-up on is measured, see latency.h. Both channels carry
+ * the tone.
+ */
+#ifndef CW_SOURCE_H_
+#define CW_SOURCE_H_
+
+#include "audio_element.h"
+#include "esp_err.h"
+
+typedef struct {
+  const char *text; /*!< Sent repeatedly, must outlive the element */
+  int wpm;
+  int freq_hz;
+  int level;       /*!< Peak sample value */
+  int out_rb_size; /*!< Size of output ringbuffer */
+  int task_stack;  /*!< Task stack size */
+  int task_core;   /*!< Task running core */
+  int task_prio;   /*!< Task priority */
+} cw_source_cfg_t;
+
+#define CW_SOURCE_BUF_SIZE (2048)
+
+#define DEFAULT_CW_SOURCE_CONFIG()                                                                                     \
+  {                                                                                                                    \
+      .text = "PARIS",                                                                                                 \
+      .wpm = 20,                                                                                                       \
+      .freq_hz = 750,                                                                                                  \
+      .level = 8000,                                                                                                   \
+      .out_rb_size = 8 * 1024,                                                                                         \
+      .task_stack = 3072,                                                                                              \
+      .task_core = 0,                                                                                                  \
+      .task_prio = 5,                                                                                                  \
+  }
+
+/**
+ * @brief Creates the element, the generator and the latency accounting start with the pipeline.
+ *
+ * @return The audio element handle, or NULL if initialization fails.
+ */
+audio_element_handle_t cw_source_init(cw_source_cfg_t *config);
+
+#endif // CW_SOURCE_H_
@@ -8,15 +8,30 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 static const char *TAG = "HIST";
 
 // dah is supposed to be ~ 3xdit in morse, this creates a narrower 2x peak search exclusion zone
 static const int EXCLUSION_ZONE_MULT = 2;
 
+static bool valid_args(const decaying_histogram_t *hist, int32_t min_val, int32_t max_val, uint32_t num_bins,
+                       float decay_exponent) {
+  return hist != NULL && num_bins > 0 && decay_exponent > 0.0f && decay_exponent < 1.0f && min_val < max_val;
+}
+
+static void set_range(decaying_histogram_t *hist, int32_t min_val, int32_t max_val, uint32_t num_bins,
+                      float decay_exponent) {
+  hist->min_val = min_val;
+  hist->max_val = max_val;
+  hist->num_bins = num_bins;
+  hist->decay_exponent = decay_exponent;
+  hist->bin_width = (float)(max_val - min_val) / num_bins;
+}
+
 esp_err_t decaying_histogram_init(decaying_histogram_t *hist, int32_t min_val, int32_t max_val, uint32_t num_bins,
                                   float decay_exponent) {
-  if (hist == NULL || num_bins == 0 || decay_exponent <= 0.0f || decay_exponent >= 1.0f || min_val >= max_val) {
+  if (!valid_args(hist, min_val, max_val, num_bins, decay_exponent)) {
     return ESP_ERR_INVALID_ARG;
   }
 
@@ -24,12 +39,22 @@ esp_err_t decaying_histogram_init(decaying_histogram_t *hist, int32_t min_val, i
   if (hist->bins == NULL) {
     return ESP_ERR_NO_MEM;
   }
+  hist->owns_bins = true;
+  set_range(hist, min_val, max_val, num_bins, decay_exponent);
 
-  hist->min_val = min_val;
-  hist->max_val = max_val;
-  hist->num_bins = num_bins;
-  hist->decay_exponent = decay_exponent;
-  hist->bin_width = (float)(max_val - min_val) / num_bins;
+  return ESP_OK;
+}
+
+esp_err_t decaying_histogram_init_static(decaying_histogram_t *hist, float *bins, int32_t min_val, int32_t max_val,
+                                         uint32_t num_bins, float decay_exponent) {
+  if (bins == NULL || !valid_args(hist, min_val, max_val, num_bins, decay_exponent)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(bins, 0, num_bins * sizeof(float));
+  hist->bins = bins;
+  hist->owns_bins = false;
+  set_range(hist, min_val, max_val, num_bins, decay_exponent);
 
   return ESP_OK;
 }
@@ -145,7 +170,9 @@ esp_err_t decaying_histogram_get_min_max_bins(const decaying_histogram_t *hist,
 
 void decaying_histogram_free(decaying_histogram_t *hist) {
   if (hist != NULL && hist->bins != NULL) {
-    free(hist->bins);
+    if (hist->owns_bins) {
+      free(hist->bins);
+    }
     hist->bins = NULL;
   }
 }
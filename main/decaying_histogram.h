@@ -4,6 +4,7 @@
 #include "esp_err.h"
 
 #include <float.h> // For FLT_MAX
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -18,11 +19,18 @@ typedef struct {
 
   float decay_exponent;
   float bin_width;
+
+  // bins allocated by decaying_histogram_init(), freed by decaying_histogram_free()
+  bool owns_bins;
 } decaying_histogram_t;
 
 esp_err_t decaying_histogram_init(decaying_histogram_t *hist, int32_t min_val, int32_t max_val, uint32_t num_bins,
                                   float decay_exponent);
 
+// Same as decaying_histogram_init() with caller provided bins, at least num_bins of them, nothing is allocated.
+esp_err_t decaying_histogram_init_static(decaying_histogram_t *hist, float *bins, int32_t min_val, int32_t max_val,
+                                         uint32_t num_bins, float decay_exponent);
+
 void decaying_histogram_dump(const decaying_histogram_t *hist);
 
 void decaying_histogram_decay(decaying_histogram_t *hist);
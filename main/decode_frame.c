@@ -0,0 +1,83 @@
+#include "decode_frame.h"
+
+#include <string.h>
+
+#include "crc32.h"
+#include "morse_code_table.h"
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+  return p + 4;
+}
+
+// sync, version, type, length
+#define HEADER_LEN (5)
+
+// header and CRC around a payload of len bytes already at out + HEADER_LEN
+static size_t finish(uint8_t *out, uint8_t type, size_t len) {
+  out[0] = DECODE_FRAME_SYNC0;
+  out[1] = DECODE_FRAME_SYNC1;
+  out[2] = DECODE_FRAME_VERSION;
+  out[3] = type;
+  out[4] = len;
+  uint8_t *p = out + HEADER_LEN + len;
+  p = put_u32(p, crc32_update(0, out + 2, p - out - 2));
+  return p - out;
+}
+
+size_t decode_frame_char(uint8_t *out, uint16_t seq, uint8_t channel, const morse_char_t *ch, uint32_t sample_rate,
+                         uint32_t time_ms) {
+  const char *text = morse_glyph_text(ch->c);
+  size_t text_len = strnlen(text, DECODE_FRAME_TEXT_MAX);
+  uint8_t flags = (ch->word_start ? DECODE_FRAME_WORD_START : 0) | (ch->c == '~' ? DECODE_FRAME_UNDECODABLE : 0) |
+                  (ch->soft ? DECODE_FRAME_SOFT : 0);
+  // PARIS standard, dit = 1.2 / wpm seconds
+  uint32_t wpm_x10 = ch->dit_len > 0 ? (uint32_t)(12.0f * sample_rate / ch->dit_len + 0.5f) : 0;
+  float confidence = ch->confidence < 0 ? 0 : (ch->confidence > 1 ? 1 : ch->confidence);
+
+  uint8_t *p = out + HEADER_LEN;
+  p = put_u16(p, seq);
+  *p++ = channel;
+  *p++ = flags;
+  *p++ = (uint8_t)(confidence * 255 + 0.5f);
+  p = put_u16(p, wpm_x10 > UINT16_MAX ? UINT16_MAX : wpm_x10);
+  p = put_u32(p, (uint32_t)(ch->start_sample * 1000 / sample_rate));
+  p = put_u32(p, time_ms);
+  *p++ = text_len;
+  memcpy(p, text, text_len);
+  return finish(out, DECODE_FRAME_CHAR, DECODE_FRAME_CHAR_FIXED + text_len);
+}
+
+size_t decode_frame_word(uint8_t *out, uint16_t seq, uint8_t channel, const morse_word_t *w, uint32_t sample_rate,
+                         uint32_t time_ms) {
+  uint8_t *p = out + HEADER_LEN;
+  p = put_u16(p, seq);
+  *p++ = channel;
+  *p++ = w->word_start ? DECODE_FRAME_WORD_START : 0;
+  *p++ = w->n_reported > UINT8_MAX ? UINT8_MAX : w->n_reported;
+  p = put_u32(p, (uint32_t)(w->start_sample * 1000 / sample_rate));
+  p = put_u32(p, time_ms);
+
+  uint8_t *text_len = p++;
+  size_t len = 0;
+  for (int i = 0; i < w->n; i++) {
+    const char *text = morse_glyph_text(w->glyphs[i]);
+    size_t n = strlen(text);
+    if (len + n > DECODE_FRAME_WORD_TEXT_MAX) {
+      break;
+    }
+    memcpy(p + len, text, n);
+    len += n;
+  }
+  *text_len = len;
+  return finish(out, DECODE_FRAME_WORD, DECODE_FRAME_WORD_FIXED + len);
+}
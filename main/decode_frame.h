@@ -0,0 +1,97 @@
+/**
+ * @file decode_frame.h
+ * @brief Binary frames of decoded characters and words, the format of the UART decode stream (decode_stream.h).
+ *
+ * Platform free, host tools write the same frames, and tools/decode_stream.py parses them. Little endian:
+ *
+ *   u8  0xA5, 0x5A  sync
+ *   u8  version     DECODE_FRAME_VERSION
+ *   u8  type        DECODE_FRAME_CHAR, DECODE_FRAME_WORD
+ *   u8  length      of the payload
+ *   payload
+ *   u32 CRC-32 (crc32.h) of version..payload
+ *
+ * Character payload:
+ *
+ *   u16 seq         frame counter, a gap means frames were dropped
+ *   u8  channel     receiver id, CONFIG_DECODE_STREAM_CHANNEL
+ *   u8  flags       DECODE_FRAME_WORD_START, DECODE_FRAME_UNDECODABLE, DECODE_FRAME_SOFT
+ *   u8  confidence  soft decoder confidence of the character, 0..255
+ *   u16 wpm_x10     speed estimate, PARIS standard, 0.1 wpm
+ *   u32 key_ms      key-down of the first element, ms of audio since the pipeline started
+ *   u32 time_ms     decided, ms since boot
+ *   u8  text_len
+ *   text            UTF-8 transcript text of the glyph
+ *
+ * Characters go out as soon as they are decided. Once a word ends it is decoded again with the speed learned
+ * meanwhile (lookahead modes other than off), and a word frame follows
+ * with the text that goes to the transcript. It replaces the last `replaces` character frames of the channel,
+ * the ones since the previous word frame; a logger that only wants final text takes the words. Word payload:
+ *
+ *   u16 seq         frame counter, shared with the character frames
+ *   u8  channel
+ *   u8  flags       DECODE_FRAME_WORD_START, false for the rest of a word cut for length
+ *   u8  replaces    character frames the word replaces
+ *   u32 key_ms      key-down of the first element
+ *   u32 time_ms     decided, ms since boot
+ *   u8  text_len
+ *   text            UTF-8 transcript text of the word, cut at a glyph after DECODE_FRAME_WORD_TEXT_MAX bytes
+ *
+ * Version 2 added the word frame. Later versions only append fields or frame types and bump the version, a
+ * parser skips what follows the fields it knows and the types it doesn't.
+ */
+#ifndef DECODE_FRAME_H_
+#define DECODE_FRAME_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "morse_core.h"
+
+#define DECODE_FRAME_SYNC0 (0xA5)
+#define DECODE_FRAME_SYNC1 (0x5A)
+#define DECODE_FRAME_VERSION (2)
+
+#define DECODE_FRAME_CHAR (1)
+#define DECODE_FRAME_WORD (2)
+
+#define DECODE_FRAME_WORD_START (1 << 0) // first character after a word gap
+#define DECODE_FRAME_UNDECODABLE (1 << 1) // nothing matched, text is "~"
+#define DECODE_FRAME_SOFT (1 << 2)        // soft decoder guess, the dit/dah sequence is not a code
+
+// sync, version, type, length, CRC
+#define DECODE_FRAME_OVERHEAD (9)
+// character payload up to the text
+#define DECODE_FRAME_CHAR_FIXED (16)
+// longest glyph text, see morse_glyph_text()
+#define DECODE_FRAME_TEXT_MAX (8)
+#define DECODE_FRAME_CHAR_MAX (DECODE_FRAME_OVERHEAD + DECODE_FRAME_CHAR_FIXED + DECODE_FRAME_TEXT_MAX)
+// word payload up to the text
+#define DECODE_FRAME_WORD_FIXED (16)
+// longest word text, a glyph that doesn't fit and the rest of the word are left out
+#define DECODE_FRAME_WORD_TEXT_MAX (128)
+#define DECODE_FRAME_WORD_MAX (DECODE_FRAME_OVERHEAD + DECODE_FRAME_WORD_FIXED + DECODE_FRAME_WORD_TEXT_MAX)
+
+/**
+ * @brief Encodes a character frame.
+ *
+ * @param out at least DECODE_FRAME_CHAR_MAX bytes
+ * @param sample_rate of the sample indexes in ch
+ * @param time_ms decision time
+ * @return frame length
+ */
+size_t decode_frame_char(uint8_t *out, uint16_t seq, uint8_t channel, const morse_char_t *ch, uint32_t sample_rate,
+                         uint32_t time_ms);
+
+/**
+ * @brief Encodes a word frame.
+ *
+ * @param out at least DECODE_FRAME_WORD_MAX bytes
+ * @param sample_rate of the sample indexes in w
+ * @param time_ms decision time
+ * @return frame length
+ */
+size_t decode_frame_word(uint8_t *out, uint16_t seq, uint8_t channel, const morse_word_t *w, uint32_t sample_rate,
+                         uint32_t time_ms);
+
+#endif // DECODE_FRAME_H_
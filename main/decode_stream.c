@@ -0,0 +1,105 @@
+#include "decode_stream.h"
+
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/stream_buffer.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <esp_log.h>
+#include <inttypes.h>
+
+#include "decode_frame.h"
+#include "morse.h"
+#include "static_alloc.h"
+
+#ifdef CONFIG_DECODE_STREAM
+
+static const char *TAG = "DECSTREAM";
+
+#define DECODE_STREAM_UART ((uart_port_t)CONFIG_DECODE_STREAM_UART_NUM)
+// Frames waiting for the sender, a second of fast CW and the words it ends
+#define DECODE_STREAM_LEN (32 * DECODE_FRAME_CHAR_MAX + 4 * DECODE_FRAME_WORD_MAX)
+// Bytes handed to the UART driver at a time
+#define DECODE_STREAM_BATCH (8 * DECODE_FRAME_CHAR_MAX)
+
+static StreamBufferHandle_t stream = NULL;
+static uint16_t seq = 0;
+static uint32_t dropped = 0;
+
+static void send(const uint8_t *frame, size_t len) {
+  // single writer (the decoder task), whole frames only so the parser does not have to resync
+  if (xStreamBufferSpacesAvailable(stream) < len) {
+    dropped++;
+    return;
+  }
+  xStreamBufferSend(stream, frame, len, 0);
+}
+
+static void on_char(const morse_char_t *ch, void *ctx) {
+  uint8_t frame[DECODE_FRAME_CHAR_MAX];
+  send(frame, decode_frame_char(frame, seq++, CONFIG_DECODE_STREAM_CHANNEL, ch, MORSE_SAMPLE_RATE,
+                                (uint32_t)(ch->decoded_us / 1000)));
+}
+
+static void on_word(const morse_word_t *w, void *ctx) {
+  // kept off the decoder task stack
+  static uint8_t frame[DECODE_FRAME_WORD_MAX];
+  send(frame, decode_frame_word(frame, seq++, CONFIG_DECODE_STREAM_CHANNEL, w, MORSE_SAMPLE_RATE,
+                                (uint32_t)(w->decoded_us / 1000)));
+}
+
+static void decode_stream_task(void *pvParameters) {
+  static uint8_t batch[DECODE_STREAM_BATCH];
+  uint32_t dropped_reported = 0;
+
+  while (1) {
+    size_t n = xStreamBufferReceive(stream, batch, sizeof(batch), portMAX_DELAY);
+    if (n > 0) {
+      uart_write_bytes(DECODE_STREAM_UART, batch, n);
+    }
+    if (dropped != dropped_reported) {
+      dropped_reported = dropped;
+      ESP_LOGW(TAG, "%" PRIu32 " frames dropped", dropped_reported);
+    }
+  }
+}
+
+esp_err_t decode_stream_init(void) {
+  const uart_config_t uart_config = {
+      .baud_rate = CONFIG_DECODE_STREAM_BAUD,
+      .data_bits = UART_DATA_8_BITS,
+      .parity = UART_PARITY_DISABLE,
+      .stop_bits = UART_STOP_BITS_1,
+      .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+      .source_clk = UART_SCLK_DEFAULT,
+  };
+  // no TX ring in the driver, the stream buffer is the only copy
+  esp_err_t err = uart_driver_install(DECODE_STREAM_UART, 2 * UART_HW_FIFO_LEN(DECODE_STREAM_UART), 0, 0, NULL, 0);
+  if (err == ESP_OK) {
+    err = uart_param_config(DECODE_STREAM_UART, &uart_config);
+  }
+  if (err == ESP_OK) {
+    err = uart_set_pin(DECODE_STREAM_UART, CONFIG_DECODE_STREAM_TX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE,
+                       UART_PIN_NO_CHANGE);
+  }
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "UART %d setup failed: %s", CONFIG_DECODE_STREAM_UART_NUM, esp_err_to_name(err));
+    return err;
+  }
+
+  stream = STATIC_STREAM_BUFFER_CREATE(DECODE_STREAM_LEN, 1);
+  if (stream == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  if (STATIC_TASK_CREATE(decode_stream_task, "DecodeStream", 2048, NULL, 4, NULL) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create decode stream task");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  ESP_LOGI(TAG, "Decoded characters and words on UART %d TX GPIO %d, %d baud, channel %d", CONFIG_DECODE_STREAM_UART_NUM,
+           CONFIG_DECODE_STREAM_TX_PIN, CONFIG_DECODE_STREAM_BAUD, CONFIG_DECODE_STREAM_CHANNEL);
+  err = morse_add_char_listener(on_char, NULL);
+  return err == ESP_OK ? morse_add_word_listener(on_word, NULL) : err;
+}
+
+#endif // CONFIG_DECODE_STREAM
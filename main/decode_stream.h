@@ -0,0 +1,25 @@
+/**
+ * @file decode_stream.h
+ * @brief Decoded characters as binary frames on a dedicated UART, for station loggers.
+ *
+ * Each character, and each word once it is re-decoded, is encoded by the decoder task (see decode_frame.h for the format) and handed over through a
+ * stream buffer without blocking. A sender task writes whatever has collected in one go, so frames go out as
+ * soon as they are decided and batch up under load. The UART driver feeds the TX FIFO from its interrupt; the
+ * sender blocks in it, the decoder never does. Frames that arrive while the stream buffer is full are dropped,
+ * counted and show up as sequence number gaps. Parse them with tools/decode_stream.py.
+ *
+ * Built with CONFIG_DECODE_STREAM only.
+ */
+#ifndef DECODE_STREAM_H_
+#define DECODE_STREAM_H_
+
+#include <esp_err.h>
+
+/**
+ * @brief Configures the UART and starts the sender task, registers the decoder listener.
+ *
+ * Call before morse_init().
+ */
+esp_err_t decode_stream_init(void);
+
+#endif // DECODE_STREAM_H_
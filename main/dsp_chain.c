@@ -0,0 +1,142 @@
+#include "dsp_chain.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "telemetry.h"
+
+#ifndef MAXFLOAT
+#define MAXFLOAT (3.40282347e+38F)
+#endif
+
+void dsp_chain_init(dsp_chain_t *chain, const float *coeffs_bpf, const float *coeffs_lpf) {
+  memset(chain, 0, sizeof(*chain));
+  memcpy(chain->p.coeffs_bpf, coeffs_bpf, sizeof(chain->p.coeffs_bpf));
+  memcpy(chain->p.coeffs_lpf, coeffs_lpf, sizeof(chain->p.coeffs_lpf));
+  chain->p.decay = DSP_CHAIN_DECAY;
+  chain->p.ook_high = OOK_LOW_TO_HIGH_THRESHOLD;
+  chain->p.ook_low = OOK_HIGH_TO_LOW_THRESHOLD;
+  chain->p.squelch_open = DSP_CHAIN_SQUELCH_OPEN;
+  chain->p.squelch_hang = DSP_CHAIN_SQUELCH_HANG;
+  chain->p.ook_adapt = DSP_CHAIN_OOK_ADAPT;
+  chain->s.smax = -MAXFLOAT / 2;
+  chain->s.smin = MAXFLOAT / 2;
+  noise_blanker_init(&chain->s.nb, NOISE_BLANKER_DEFAULT_MULT);
+  squelch_init(&chain->s.sq);
+  ook_edge_detector_init(&chain->s.ook);
+}
+
+void dsp_chain_set_params(dsp_chain_t *chain, const dsp_chain_params_t *params) { chain->p = *params; }
+
+// Direct form II, same as esp-dsp dsps_biquad_f32_ansi, w[2] delay line
+static void biquad(const float *input, float *output, int len, const float *coef, float *w) {
+  for (int i = 0; i < len; i++) {
+    float d0 = input[i] - coef[3] * w[0] - coef[4] * w[1];
+    output[i] = coef[0] * d0 + coef[1] * w[0] + coef[2] * w[1];
+    w[1] = w[0];
+    w[0] = d0;
+  }
+}
+
+void dsp_chain_process(dsp_chain_t *chain, int16_t *samples, int stride, int n, uint64_t sample0,
+                       dsp_chain_edge_fn on_edge, void *ctx) {
+  __attribute__((aligned(16))) static float input[DSP_CHAIN_MAX_SAMPLES];
+  __attribute__((aligned(16))) static float output[DSP_CHAIN_MAX_SAMPLES];
+  dsp_chain_state_t *s = &chain->s;
+
+  if (n <= 0) {
+    return;
+  }
+
+  for (int i = 0; i < n; i++) {
+    input[i] = (float)samples[i * stride];
+  }
+
+  int blanked = noise_blanker_process(&s->nb, input, n);
+  telemetry_record_blanked(blanked);
+
+  // BPF
+  biquad(input, output, n, chain->p.coeffs_bpf, s->w_bpf);
+
+  // Envelope
+  for (int i = 0; i < n; i++) {
+    input[i] = fabs(output[i]);
+  }
+
+  // LPF over envelope
+  biquad(input, output, n, chain->p.coeffs_lpf, s->w_lpf);
+
+  // Shrinking min/max to account for signal fade in/out
+  s->smax = s->smax - chain->p.decay * fabs(s->smax);
+  s->smin = s->smin + chain->p.decay * fabs(s->smin);
+
+  float sum = 0.0f;
+  float peak = 0.0f;
+  for (int i = 0; i < n; i++) {
+    if (s->smin > output[i]) {
+      s->smin = output[i];
+    }
+    if (s->smax < output[i]) {
+      s->smax = output[i];
+    }
+    sum += output[i];
+    peak = fmaxf(peak, output[i]);
+  }
+
+  if (s->smin >= s->smax) {
+    s->smin = s->smax - 0.1;
+  }
+
+  telemetry_record_levels(s->smin, s->smax);
+
+  float range = s->smax - s->smin;
+
+  bool open = squelch_update(&s->sq, sum / n, peak, n, chain->p.squelch_open, chain->p.squelch_hang);
+  telemetry_record_squelch(open);
+  if (!open) {
+    int32_t e = ook_edge_detector_hold_low(&s->ook, n);
+    if (e != 0) {
+      on_edge(e, range, sample0, ctx);
+    }
+    for (int i = 0; i < n; i++) {
+      samples[i * stride] = INT16_MIN;
+    }
+    return;
+  }
+
+  float scale = range / (float)UINT32_MAX;
+
+  // Convert back to the output channel and run OOK decoder
+  for (int i = 0; i < n; i++) {
+    float val_float = (output[i] - s->smin) / scale;
+    uint32_t u;
+
+    if (val_float <= 0.0f) {
+      u = 0;
+    } else if (val_float >= (float)UINT32_MAX) {
+      // (float)UINT32_MAX is typically 4294967296.0f (i.e., 2^32f) due to rounding.
+      // If val_float is this large or larger, it should be clamped to UINT32_MAX.
+      u = UINT32_MAX;
+    } else {
+      // val_float is in the range (0.0f, 2^32f).
+      // Casting this to uint32_t is safe and will result in a value
+      // from 0 to UINT32_MAX. For example, if val_float is 4294967295.999...
+      // (and still less than 2^32f), its (uint32_t) cast will be 4294967295.
+      u = (uint32_t)val_float;
+    }
+
+    samples[i * stride] = (u >> 16) + INT16_MIN;
+
+    int32_t e;
+    if (chain->p.ook_adapt > 0.0f) {
+      e = ook_edge_detector_update_adaptive(&s->ook, u, chain->p.ook_high, chain->p.ook_low, chain->p.ook_adapt);
+    } else {
+      e = ook_edge_detector_update(&s->ook, u, chain->p.ook_high, chain->p.ook_low);
+    }
+
+    if (e != 0) {
+      on_edge(e, range, sample0 + i, ctx);
+    }
+  }
+}
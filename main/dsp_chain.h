@@ -0,0 +1,84 @@
+/**
+ * @file dsp_chain.h
+ * @brief Platform free signal chain of the DSP element: noise blanker, BPF, envelope, LPF, squelch, rescaling,
+ * OOK edges.
+ *
+ * Runs inside _dsp_process on the device and in tools/audio_replay on a host. All state that affects the output
+ * lives in dsp_chain_state_t, so a copy taken at a block boundary lets a host continue from that block and
+ * produce the same edges bit for bit. For that the chain uses its own plain C biquad and is compiled with
+ * -ffp-contract=off (see CMakeLists.txt), the compiler must not fuse multiply-adds differently on each target.
+ */
+#ifndef DSP_CHAIN_H_
+#define DSP_CHAIN_H_
+
+#include <stdint.h>
+
+#include "noise_blanker.h"
+#include "ook_edge_detector.h"
+#include "squelch.h"
+
+// Longest block, samples of a single channel
+#define DSP_CHAIN_MAX_SAMPLES (1024)
+// biquad coefficients b0, b1, b2, a1, a2, as generated by esp-dsp dsps_biquad_gen_*
+#define DSP_CHAIN_COEFFS (5)
+// Default shrink of the envelope min/max per block
+#define DSP_CHAIN_DECAY (0.010f)
+// Default squelch open margin over the noise ratio (10 dB) and hang time (2s at 44.1kHz), see squelch.h
+#define DSP_CHAIN_SQUELCH_OPEN (3.162f)
+#define DSP_CHAIN_SQUELCH_HANG (88200)
+// Default OOK hysteresis band, multiple of the envelope noise spread, 0 fixed thresholds. The adaptive band only
+// wins around -15dB wideband SNR and loses below and above it, see tools/ook_bench
+#define DSP_CHAIN_OOK_ADAPT (0.0f)
+
+typedef struct {
+  float w_bpf[2];
+  float w_lpf[2];
+  float smin; // decaying envelope min/max, the OOK threshold follows them
+  float smax;
+  noise_blanker_t nb;
+  squelch_t sq;
+  ook_edge_detector_t ook;
+} dsp_chain_state_t;
+
+// Settings, they change only between blocks
+typedef struct {
+  float coeffs_bpf[DSP_CHAIN_COEFFS];
+  float coeffs_lpf[DSP_CHAIN_COEFFS];
+  float decay;       // envelope min/max shrink per block, fraction
+  uint32_t ook_high; // OOK thresholds on the rescaled envelope, see ook_edge_detector_update
+  uint32_t ook_low;
+  float squelch_open;    // see squelch_update, 0 turns the squelch off
+  uint32_t squelch_hang; // samples
+  float ook_adapt;       // see ook_edge_detector_update_adaptive, 0 fixed ook_high/ook_low
+} dsp_chain_params_t;
+
+typedef struct {
+  dsp_chain_params_t p;
+  dsp_chain_state_t s;
+} dsp_chain_t;
+
+/** Called for every OOK edge, see morse_sample() for e, range and sample. */
+typedef void (*dsp_chain_edge_fn)(int32_t e, float range, uint64_t sample, void *ctx);
+
+/** Starts with the given filters and the default decay, squelch and OOK thresholds. */
+void dsp_chain_init(dsp_chain_t *chain, const float *coeffs_bpf, const float *coeffs_lpf);
+
+/** Replaces the settings, the filter and envelope state carries on. Between blocks only. */
+void dsp_chain_set_params(dsp_chain_t *chain, const dsp_chain_params_t *params);
+
+/**
+ * @brief Processes a block of a single channel.
+ *
+ * While the squelch is closed the block is not rescaled or run through the edge detector, the output channel
+ * is silent and no edges come out, except the key-up of a pulse that was in progress.
+ *
+ * @param[in,out] samples interleaved samples, the processed channel is replaced with the rescaled envelope
+ * @param stride distance between samples of the channel, 2 for stereo
+ * @param n number of samples of the channel, at most DSP_CHAIN_MAX_SAMPLES
+ * @param sample0 index of the first sample since the chain started, edges are stamped with it
+ * @param on_edge called for each edge, in order
+ */
+void dsp_chain_process(dsp_chain_t *chain, int16_t *samples, int stride, int n, uint64_t sample0,
+                       dsp_chain_edge_fn on_edge, void *ctx);
+
+#endif // DSP_CHAIN_H_
@@ -0,0 +1,75 @@
+#include "edge_capture.h"
+
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "edge_trace.h"
+
+#ifdef CONFIG_EDGE_CAPTURE_BLOCKS
+#define EDGE_CAPTURE_BLOCKS (CONFIG_EDGE_CAPTURE_BLOCKS)
+#else
+#define EDGE_CAPTURE_BLOCKS (16)
+#endif
+
+// Sample rate of edge durations
+#define EDGE_CAPTURE_SAMPLE_RATE (44100)
+
+static uint8_t capture_mem[EDGE_CAPTURE_BLOCKS * EDGE_TRACE_BLOCK];
+static edge_trace_t capture = {.mem = capture_mem, .blocks = EDGE_CAPTURE_BLOCKS, .pos = EDGE_TRACE_BLOCK};
+// guards capture, recording (audio task) against dumping (console task)
+static portMUX_TYPE capture_lock = portMUX_INITIALIZER_UNLOCKED;
+// recording stops while a dump is printed, so the dump is consistent
+static bool paused = false;
+
+void edge_capture_record(int32_t e, float range) {
+  portENTER_CRITICAL(&capture_lock);
+  if (!paused) {
+    edge_trace_record(&capture, e, range);
+  }
+  portEXIT_CRITICAL(&capture_lock);
+}
+
+static void print_hex(const char *prefix, const void *data, size_t len) {
+  static const char digits[] = "0123456789abcdef";
+  char line[2 * EDGE_TRACE_BLOCK + 1];
+  const uint8_t *p = (const uint8_t *)data;
+
+  for (size_t i = 0; i < len; i++) {
+    line[2 * i] = digits[p[i] >> 4];
+    line[2 * i + 1] = digits[p[i] & 0x0F];
+  }
+  line[2 * len] = 0;
+  printf("%s%s\n", prefix, line);
+}
+
+void edge_capture_dump(void) {
+  portENTER_CRITICAL(&capture_lock);
+  paused = true;
+  portEXIT_CRITICAL(&capture_lock);
+
+  uint32_t blocks = edge_trace_block_count(&capture);
+  edge_trace_file_header_t h = {
+      .magic = EDGE_TRACE_MAGIC,
+      .block_size = EDGE_TRACE_BLOCK,
+      .sample_rate = EDGE_CAPTURE_SAMPLE_RATE,
+      .blocks = blocks,
+  };
+  printf("# %lu edges in %lu blocks\n", (unsigned long)capture.edges, (unsigned long)blocks);
+  print_hex("EDT ", &h, sizeof(h));
+  for (uint32_t i = 0; i < blocks; i++) {
+    print_hex("EDT ", edge_trace_block(&capture, i), EDGE_TRACE_BLOCK);
+  }
+  printf("EDT end\n");
+
+  portENTER_CRITICAL(&capture_lock);
+  paused = false;
+  portEXIT_CRITICAL(&capture_lock);
+}
+
+void edge_capture_clear(void) {
+  portENTER_CRITICAL(&capture_lock);
+  edge_trace_clear(&capture);
+  portEXIT_CRITICAL(&capture_lock);
+}
@@ -0,0 +1,20 @@
+/**
+ * @file edge_capture.h
+ * @brief Always-on capture of the most recent OOK edges on the device, see edge_trace.h for the format.
+ *
+ * Dump with the "edges" console command and replay with tools/edge_replay.
+ */
+#ifndef EDGE_CAPTURE_H_
+#define EDGE_CAPTURE_H_
+
+#include <stdint.h>
+
+/** Records an edge, called from the audio task for every edge passed to the decoder. */
+void edge_capture_record(int32_t e, float range);
+
+/** Prints the capture to stdout as text lines, "EDT <hex>", that tools/edge_replay reads back. */
+void edge_capture_dump(void);
+
+void edge_capture_clear(void);
+
+#endif // EDGE_CAPTURE_H_
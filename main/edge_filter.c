@@ -0,0 +1,70 @@
+#include "edge_filter.h"
+
+#include <stdlib.h>
+
+#include "trace.h"
+
+void edge_filter_init(edge_filter_t *f, int32_t min_width, int32_t max_width) {
+  f->pending = 0;
+  f->merging = false;
+  f->min_width = min_width;
+  f->max_width = max_width;
+  f->threshold = min_width;
+  f->merged = 0;
+}
+
+void edge_filter_set_dit_len(edge_filter_t *f, int32_t dit_len) {
+  int32_t th = dit_len / 3;
+
+  if (th < f->min_width) {
+    th = f->min_width;
+  } else if (th > f->max_width) {
+    th = f->max_width;
+  }
+
+  f->threshold = th;
+}
+
+// adds duration of e to the held edge, keeping the sign of the held edge
+static void merge_into_pending(edge_filter_t *f, int32_t e) {
+  int32_t d = abs(e);
+
+  if (f->pending < 0) {
+    f->pending = (f->pending < INT32_MIN + d) ? INT32_MIN : f->pending - d;
+  } else {
+    f->pending = (f->pending > INT32_MAX - d) ? INT32_MAX : f->pending + d;
+  }
+}
+
+int32_t edge_filter_update(edge_filter_t *f, int32_t e) {
+  if (f->pending == 0) {
+    f->pending = e;
+    return 0;
+  }
+
+  if (f->merging) {
+    // the other side of the glitch
+    merge_into_pending(f, e);
+    f->merging = false;
+    return 0;
+  }
+
+  if (abs(e) < f->threshold) {
+    TRACE(DSP, TRACE_GLITCH, e, f->threshold, 0);
+    merge_into_pending(f, e);
+    f->merging = true;
+    f->merged++;
+    return 0;
+  }
+
+  int32_t out = f->pending;
+  f->pending = e;
+  return out;
+}
+
+int32_t edge_filter_flush(edge_filter_t *f) {
+  int32_t out = f->pending;
+  f->pending = 0;
+  f->merging = false;
+  return out;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file edge_filter.h
+ * @brief Glitch filter over the OOK edge stream, merges short pulses and gaps into their neighbours.
+ *
+ * Works on edge records (see morse_sample) rather than on samples. Holds back one edge,
+ * when the next one is shorter than the threshold it is folded into the held edge together
+ * with the edge that follows it, e.g. a click in the middle of a dah: "on 3000, off 40, on 2900"
+ * becomes "on 5940".
+ */
+#ifndef EDGE_FILTER_H_
+#define EDGE_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  int32_t pending;   // held back edge, 0 if none
+  bool merging;      // pending absorbed a glitch, the next edge (same polarity as pending) is merged too
+  int32_t min_width; // lower bound of the merge threshold, samples
+  int32_t max_width; // upper bound of the merge threshold, samples
+  int32_t threshold; // current merge threshold, samples
+  uint32_t merged;   // number of merged glitches, for debugging
+} edge_filter_t;
+
+/**
+ * @param min_width threshold used before the dit length is known, samples
+ * @param max_width threshold never goes above this, however long dits are, samples
+ */
+void edge_filter_init(edge_filter_t *f, int32_t min_width, int32_t max_width);
+
+/** Adapts merge threshold to the current dit length estimate (a third of a dit). */
+void edge_filter_set_dit_len(edge_filter_t *f, int32_t dit_len);
+
+/**
+ * @param e edge, as in morse_sample
+ * @return edge to pass down to the decoder or 0 if the edge was held back / merged
+ */
+int32_t edge_filter_update(edge_filter_t *f, int32_t e);
+
+/** Releases the held back edge (e.g. on a long pause), returns 0 if there was none. */
+int32_t edge_filter_flush(edge_filter_t *f);
+
+#endif // EDGE_FILTER_H_
@@ -0,0 +1,108 @@
+#include "edge_trace.h"
+
+#include <math.h>
+#include <string.h>
+
+// range is stored as round(RANGE_STEPS * log2(range)), quarter octave steps
+#define RANGE_STEPS (4.0f)
+
+static uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+
+static int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+static size_t put_varint(uint8_t *p, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+static bool get_varint(edge_trace_reader_t *r, uint32_t *v) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35 && r->p < r->end; shift += 7) {
+    uint8_t b = *r->p++;
+    result |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *v = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+static int32_t quantize_range(float range) {
+  if (!(range > 1e-9f)) {
+    return INT16_MIN;
+  }
+  return (int32_t)lrintf(RANGE_STEPS * log2f(range));
+}
+
+void edge_trace_init(edge_trace_t *t, uint8_t *mem, uint32_t blocks) {
+  t->mem = mem;
+  t->blocks = blocks;
+  edge_trace_clear(t);
+}
+
+void edge_trace_clear(edge_trace_t *t) {
+  t->started = 0;
+  t->pos = EDGE_TRACE_BLOCK; // the first record starts a block
+  t->range_q = 0;
+  t->edges = 0;
+}
+
+void edge_trace_record(edge_trace_t *t, int32_t e, float range) {
+  uint8_t rec[EDGE_TRACE_RECORD_MAX];
+  int32_t q = quantize_range(range);
+
+  if (e == 0 || t->blocks == 0) {
+    return;
+  }
+
+  size_t n = put_varint(rec, zigzag(e));
+  n += put_varint(rec + n, zigzag(q - t->range_q));
+
+  if (t->pos + n > EDGE_TRACE_BLOCK) {
+    // start a new block, range restarts from 0 so the block decodes on its own
+    uint8_t *block = t->mem + (size_t)(t->started % t->blocks) * EDGE_TRACE_BLOCK;
+    memset(block, 0, EDGE_TRACE_BLOCK);
+    t->started++;
+    t->pos = 0;
+    t->range_q = 0;
+    n = put_varint(rec, zigzag(e));
+    n += put_varint(rec + n, zigzag(q));
+  }
+
+  memcpy(t->mem + (size_t)((t->started - 1) % t->blocks) * EDGE_TRACE_BLOCK + t->pos, rec, n);
+  t->pos += n;
+  t->range_q = q;
+  t->edges++;
+}
+
+uint32_t edge_trace_block_count(const edge_trace_t *t) { return t->started < t->blocks ? t->started : t->blocks; }
+
+const uint8_t *edge_trace_block(const edge_trace_t *t, uint32_t i) {
+  uint32_t first = t->started - edge_trace_block_count(t);
+  return t->mem + (size_t)((first + i) % t->blocks) * EDGE_TRACE_BLOCK;
+}
+
+void edge_trace_reader_init(edge_trace_reader_t *r, const uint8_t *block, size_t len) {
+  r->p = block;
+  r->end = block + len;
+  r->range_q = 0;
+}
+
+bool edge_trace_next(edge_trace_reader_t *r, int32_t *e, float *range) {
+  uint32_t ze, zq;
+
+  if (r->p >= r->end || *r->p == 0 || !get_varint(r, &ze) || !get_varint(r, &zq)) {
+    return false;
+  }
+
+  *e = unzigzag(ze);
+  r->range_q += unzigzag(zq);
+  *range = r->range_q == INT16_MIN ? 0.0f : exp2f(r->range_q / RANGE_STEPS);
+  return true;
+}
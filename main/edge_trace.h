@@ -0,0 +1,67 @@
+/**
+ * @file edge_trace.h
+ * @brief Compact binary encoding of the OOK edge stream, for capture on the device and replay on a host.
+ *
+ * An edge is a zigzag varint of its signed duration (2 bytes for typical CW timing) followed by a zigzag
+ * varint of the change of the quantized OOK range (usually 1 byte). Records are packed into fixed size
+ * blocks that decode independently, so a ring of blocks can drop its oldest block and the rest still
+ * decodes. A 0 byte (an edge of length 0, which never happens) ends a block early.
+ *
+ * A dump is a edge_trace_file_header_t followed by blocks, oldest first.
+ */
+#ifndef EDGE_TRACE_H_
+#define EDGE_TRACE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define EDGE_TRACE_MAGIC (0x31544445) // "EDT1"
+#define EDGE_TRACE_BLOCK (256)
+// longest record, two 5 byte varints
+#define EDGE_TRACE_RECORD_MAX (10)
+
+typedef struct {
+  uint32_t magic;
+  uint32_t block_size;  // bytes
+  uint32_t sample_rate; // edge durations are in samples at this rate
+  uint32_t blocks;      // number of blocks that follow
+} edge_trace_file_header_t;
+
+// ring of blocks, the newest block is being filled
+typedef struct {
+  uint8_t *mem;        // blocks * EDGE_TRACE_BLOCK bytes
+  uint32_t blocks;     // ring length
+  uint32_t started;    // number of blocks started, the newest is (started - 1) % blocks
+  uint32_t pos;        // write position in the newest block
+  int32_t range_q;     // last quantized range in the newest block
+  uint32_t edges;      // total edges recorded
+} edge_trace_t;
+
+void edge_trace_init(edge_trace_t *t, uint8_t *mem, uint32_t blocks);
+
+/** Drops everything recorded so far. */
+void edge_trace_clear(edge_trace_t *t);
+
+/** Appends an edge, the oldest block is overwritten when the ring is full. */
+void edge_trace_record(edge_trace_t *t, int32_t e, float range);
+
+/** @return number of blocks holding data */
+uint32_t edge_trace_block_count(const edge_trace_t *t);
+
+/** @return i-th block holding data, 0 is the oldest */
+const uint8_t *edge_trace_block(const edge_trace_t *t, uint32_t i);
+
+typedef struct {
+  const uint8_t *p;
+  const uint8_t *end;
+  int32_t range_q;
+} edge_trace_reader_t;
+
+/** Starts decoding a single block. */
+void edge_trace_reader_init(edge_trace_reader_t *r, const uint8_t *block, size_t len);
+
+/** @return false at the end of the block */
+bool edge_trace_next(edge_trace_reader_t *r, int32_t *e, float *range);
+
+#endif // EDGE_TRACE_H_
@@ -0,0 +1,183 @@
+#include "es8388_regs.h"
+
+#include <esp_log.h>
+#include <string.h>
+
+#include "es8388_register_values.h"
+
+static const char *TAG = "ES8388";
+
+// User guide power-up order (steps in the comments), writes within a step are batched where registers are
+// consecutive. ADC_CTRL3/6/7 (0x0B, 0x0E, 0x0F) get their reset values to join a run, they are not guide steps.
+const es8388_reg_t es8388_init_seq[] = {
+    // 2: slave mode
+    {0x08, ES8388_REG08_MASTER_MODE_CTRL},
+    // 3: digital blocks and state machines held in power down while the rest is set up
+    {0x02, 0xF3},
+    // 5, 6: play & record mode, analog and bias power
+    {0x00, ES8388_REG00_CHIP_CONTROL1},
+    {0x01, ES8388_REG01_CHIP_CONTROL2},
+    // analog voltage, low power
+    {0x07, ES8388_REG07_ANALOG_VOLT_MGMT},
+    {0x05, ES8388_REG05_CHIP_LOW_POWER1},
+    {0x06, ES8388_REG06_CHIP_LOW_POWER2},
+    // 4: same LRCK
+    {0x2B, ES8388_REG2B_DAC_CTRL21_LRCKOFFSET},
+    // 7: DAC power, LOUT/ROUT
+    {0x04, ES8388_REG04_DAC_POWER_MGMT},
+    // 8, 9: ADC input, PGA gain
+    {0x0A, ES8388_REG0A_ADC_CTRL2_INSEL},
+    {0x0B, ES8388_REG0B_ADC_CTRL3_DIFFSEL},
+    {0x09, ES8388_REG09_ADC_CTRL1_MICAMP},
+    // 10-13: ADC format, ratio, volume, ALC, noise gate
+    {0x0C, ES8388_REG0C_ADC_CTRL4_FORMAT},
+    {0x0D, ES8388_REG0D_ADC_CTRL5_FSRATIO},
+    {0x0E, ES8388_REG0E_ADC_CTRL6_HPFINV},
+    {0x0F, ES8388_REG0F_ADC_CTRL7_RAMPMUTE},
+    {0x10, ES8388_REG10_ADC_CTRL8_LVOL},
+    {0x11, ES8388_REG11_ADC_CTRL9_RVOL},
+    {0x12, ES8388_REG12_ADC_CTRL10_ALCGAIN},
+    {0x13, ES8388_REG13_ADC_CTRL11_ALCLVLHLD},
+    {0x14, ES8388_REG14_ADC_CTRL12_ALCDCYATK},
+    {0x15, ES8388_REG15_ADC_CTRL13_ALCZCWIN},
+    {0x16, ES8388_REG16_ADC_CTRL14_NG},
+    // 14: ADC power
+    {0x03, ES8388_REG03_ADC_POWER_MGMT},
+    // 15-18: DAC format, ratio, volume, unmute
+    {0x17, ES8388_REG17_DAC_CTRL1_FORMAT},
+    {0x18, ES8388_REG18_DAC_CTRL2_FSRATIO},
+    {0x1A, ES8388_REG1A_DAC_CTRL4_LVOL},
+    {0x1B, ES8388_REG1B_DAC_CTRL5_RVOL},
+    {0x19, ES8388_REG19_DAC_CTRL3_RAMPMUTE},
+    // DAC output, de-emphasis, shelving filter, analog stage
+    {0x1C, ES8388_REG1C_DAC_CTRL6_DEEMPHINV},
+    {0x1D, ES8388_REG1D_DAC_CTRL7_ZEROSE},
+    {0x1E, ES8388_REG1E_DAC_CTRL8_SHELVINGA29_24},
+    {0x1F, ES8388_REG1F_DAC_CTRL9_SHELVINGA23_16},
+    {0x20, ES8388_REG20_DAC_CTRL10_SHELVINGA15_8},
+    {0x21, ES8388_REG21_DAC_CTRL11_SHELVINGA7_0},
+    {0x22, ES8388_REG22_DAC_CTRL12_SHELVINGB29_24},
+    {0x23, ES8388_REG23_DAC_CTRL13_SHELVINGB23_16},
+    {0x24, ES8388_REG24_DAC_CTRL14_SHELVINGB15_8},
+    {0x25, ES8388_REG25_DAC_CTRL15_SHELVINGB7_0},
+    {0x2C, ES8388_REG2C_DAC_CTRL22_OFFSETVAL},
+    {0x2D, ES8388_REG2D_DAC_CTRL23_VROI},
+    // 19: mixer
+    {0x26, ES8388_REG26_DAC_CTRL16_MIXSEL},
+    {0x27, ES8388_REG27_DAC_CTRL17_LD2LOVOL},
+    {0x28, ES8388_REG28_DAC_CTRL18},
+    {0x29, ES8388_REG29_DAC_CTRL19},
+    {0x2A, ES8388_REG2A_DAC_CTRL20_RD2ROVOL},
+    // 20: output volumes, headphone and speaker references
+    {0x2E, ES8388_REG2E_DAC_CTRL24_LOUT1VOL},
+    {0x2F, ES8388_REG2F_DAC_CTRL25_ROUT1VOL},
+    {0x30, ES8388_REG30_DAC_CTRL26_LOUT2VOL},
+    {0x31, ES8388_REG31_DAC_CTRL27_ROUT2VOL},
+    {0x32, ES8388_REG32_DAC_CTRL28},
+    {0x33, ES8388_REG33_DAC_CTRL29_HPLOUT1REF},
+    {0x34, ES8388_REG34_DAC_CTRL30_SPKLOUT2REF},
+    // 21: power up DEM and STM
+    {0x02, ES8388_REG02_CHIP_POWER_MGMT},
+};
+
+const size_t es8388_init_seq_len = sizeof(es8388_init_seq) / sizeof(es8388_init_seq[0]);
+
+// runs of consecutive registers as one write each when batched
+static esp_err_t write_seq(const es8388_bus_t *bus, const es8388_reg_t *seq, size_t n, bool batched,
+                           es8388_program_stats_t *stats) {
+  uint8_t data[ES8388_REG_LAST + 1];
+  for (size_t i = 0; i < n;) {
+    size_t len = 1;
+    data[0] = seq[i].val;
+    while (batched && i + len < n && seq[i + len].reg == seq[i].reg + len) {
+      data[len] = seq[i + len].val;
+      len++;
+    }
+    esp_err_t err = bus->write(bus->ctx, seq[i].reg, data, len);
+    stats->writes++;
+    if (err != ESP_OK) {
+      ESP_LOGE(TAG, "Write of %u registers at 0x%02x failed: %s", (unsigned)len, seq[i].reg, esp_err_to_name(err));
+      return err;
+    }
+    i += len;
+  }
+  return ESP_OK;
+}
+
+// reads back every written register in bulk, the ones that differ are read again on their own
+static esp_err_t check(const es8388_bus_t *bus, const uint8_t *expected, const bool *written, bool final, int *wrong,
+                       es8388_program_stats_t *stats) {
+  uint8_t got[ES8388_REG_LAST + 1];
+  *wrong = 0;
+
+  for (int reg = 0; reg <= ES8388_REG_LAST;) {
+    if (!written[reg]) {
+      reg++;
+      continue;
+    }
+    int end = reg;
+    while (end < ES8388_REG_LAST && written[end + 1]) {
+      end++;
+    }
+    esp_err_t err = bus->read(bus->ctx, reg, got + reg, end - reg + 1);
+    stats->reads++;
+    if (err != ESP_OK) {
+      ESP_LOGE(TAG, "Readback at 0x%02x failed: %s", reg, esp_err_to_name(err));
+      return err;
+    }
+    reg = end + 1;
+  }
+
+  for (int reg = 0; reg <= ES8388_REG_LAST; reg++) {
+    if (!written[reg] || got[reg] == expected[reg]) {
+      continue;
+    }
+    // a chip that doesn't increment on reads shifts the bulk readback
+    esp_err_t err = bus->read(bus->ctx, reg, &got[reg], 1);
+    stats->reads++;
+    if (err != ESP_OK) {
+      return err;
+    }
+    if (got[reg] != expected[reg]) {
+      (*wrong)++;
+      if (final) {
+        ESP_LOGW(TAG, "Register 0x%02x reads 0x%02x, wrote 0x%02x", reg, got[reg], expected[reg]);
+      }
+    }
+  }
+  return ESP_OK;
+}
+
+esp_err_t es8388_program(const es8388_bus_t *bus, const es8388_reg_t *seq, size_t n, es8388_program_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+  stats->registers = n;
+
+  uint8_t expected[ES8388_REG_LAST + 1];
+  bool written[ES8388_REG_LAST + 1] = {false};
+  for (size_t i = 0; i < n; i++) {
+    if (seq[i].reg > ES8388_REG_LAST) {
+      return ESP_ERR_INVALID_ARG;
+    }
+    expected[seq[i].reg] = seq[i].val;
+    written[seq[i].reg] = true;
+  }
+
+  esp_err_t err = write_seq(bus, seq, n, true, stats);
+  if (err == ESP_OK) {
+    err = check(bus, expected, written, false, &stats->mismatches, stats);
+  }
+  if (err != ESP_OK || stats->mismatches == 0) {
+    return err;
+  }
+
+  ESP_LOGW(TAG, "%d registers differ after batched writes, rewriting one at a time", stats->mismatches);
+  stats->unbatched = true;
+  err = write_seq(bus, seq, n, false, stats);
+  if (err == ESP_OK) {
+    err = check(bus, expected, written, true, &stats->failed, stats);
+  }
+  if (err == ESP_OK && stats->failed > 0) {
+    err = ESP_ERR_INVALID_RESPONSE;
+  }
+  return err;
+}
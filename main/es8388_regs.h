@@ -0,0 +1,57 @@
+/**
+ * @file es8388_regs.h
+ * @brief ES8388 register programming: the init sequence as a table, batched writes and a readback check.
+ *
+ * Runs of consecutive registers in the sequence go out as one bus write each, the chip increments the
+ * register address after every data byte. All written registers are then read back in bulk and compared with
+ * the last value written to each. If any differ, the whole sequence is written again one register per write
+ * (the order of the table matters for the power-up sequence) and checked again. No platform dependencies,
+ * the bus is an interface, see tools/es8388_sim for a register file on a host.
+ */
+#ifndef ES8388_REGS_H_
+#define ES8388_REGS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// Registers 0x00..ES8388_REG_LAST are programmed and checked
+#define ES8388_REG_LAST (0x34)
+
+typedef struct {
+  uint8_t reg;
+  uint8_t val;
+} es8388_reg_t;
+
+typedef struct {
+  // writes len registers from reg in one transaction
+  esp_err_t (*write)(void *ctx, uint8_t reg, const uint8_t *data, size_t len);
+  // reads len registers from reg in one transaction
+  esp_err_t (*read)(void *ctx, uint8_t reg, uint8_t *data, size_t len);
+  void *ctx;
+} es8388_bus_t;
+
+typedef struct {
+  int writes;     // write transactions
+  int reads;      // read transactions
+  int registers;  // register writes in the sequence
+  int mismatches; // registers that read back wrong after the batched writes
+  int failed;     // registers still wrong after the one by one rewrite
+  bool unbatched; // the sequence was rewritten one register at a time
+} es8388_program_stats_t;
+
+// ADC and DAC paths of this firmware, LineIn -> ADC -> I2S -> DAC -> LineOut, values from es8388_register_values.h
+extern const es8388_reg_t es8388_init_seq[];
+extern const size_t es8388_init_seq_len;
+
+/**
+ * @brief Writes the sequence and checks the result.
+ *
+ * @return ESP_OK when every register reads back as written, ESP_ERR_INVALID_RESPONSE if some still differ
+ * after the rewrite, the bus error otherwise
+ */
+esp_err_t es8388_program(const es8388_bus_t *bus, const es8388_reg_t *seq, size_t n, es8388_program_stats_t *stats);
+
+#endif // ES8388_REGS_H_
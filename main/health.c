@@ -0,0 +1,171 @@
+#include "health.h"
+
+#include "esp_heap_caps.h"
+#include "freertos/task.h"
+#include "ringbuf.h"
+#include "sdkconfig.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "static_alloc.h"
+
+static const char *TAG = "HEALTH";
+
+#ifdef CONFIG_HEALTH_PERIOD_S
+#define HEALTH_PERIOD_MS (CONFIG_HEALTH_PERIOD_S * 1000)
+#else
+#define HEALTH_PERIOD_MS (5000)
+#endif
+
+#ifdef CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+typedef configRUN_TIME_COUNTER_TYPE run_time_t;
+#else
+typedef uint32_t run_time_t;
+#endif
+
+static audio_element_handle_t dsp_el = NULL;
+
+// published snapshot, written by the monitor task, read by the console
+static health_t snapshot;
+static portMUX_TYPE snapshot_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static float rb_fill(ringbuf_handle_t rb) {
+  int size = rb ? rb_get_size(rb) : 0;
+  return size > 0 ? 100.0f * rb_bytes_filled(rb) / size : 0.0f;
+}
+
+#ifdef CONFIG_FREERTOS_USE_TRACE_FACILITY
+// task list, run time counters of the previous period by task number
+static TaskStatus_t status[HEALTH_MAX_TASKS];
+static struct {
+  UBaseType_t number;
+  run_time_t run_time;
+} prev[HEALTH_MAX_TASKS];
+static int n_prev = 0;
+static run_time_t prev_total = 0;
+
+static run_time_t prev_run_time(UBaseType_t number) {
+  for (int i = 0; i < n_prev; i++) {
+    if (prev[i].number == number) {
+      return prev[i].run_time;
+    }
+  }
+  return 0;
+}
+
+// CPU shares since the last call and stack headroom, from the FreeRTOS task list
+static void sample_tasks(health_t *h) {
+  run_time_t total = 0;
+  UBaseType_t n = uxTaskGetSystemState(status, HEALTH_MAX_TASKS, &total);
+  if (n == 0) {
+    ESP_LOGW(TAG, "More than %d tasks, no task statistics", HEALTH_MAX_TASKS);
+    return;
+  }
+#ifdef CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  // run time counters wrap, differences are right as long as a period is shorter than the wrap
+  run_time_t elapsed = total - prev_total;
+#endif
+
+  h->n_tasks = n;
+  for (UBaseType_t i = 0; i < n; i++) {
+    health_task_t *t = &h->tasks[i];
+    snprintf(t->name, sizeof(t->name), "%s", status[i].pcTaskName);
+    t->stack_free = status[i].usStackHighWaterMark;
+#ifdef CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    run_time_t run = status[i].ulRunTimeCounter - prev_run_time(status[i].xTaskNumber);
+    t->cpu = elapsed > 0 && n_prev > 0 ? 100.0f * run / elapsed : 0.0f;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+      if (status[i].xHandle == xTaskGetIdleTaskHandleForCore(core)) {
+        h->core_load[core] = 100.0f - t->cpu;
+      }
+    }
+#endif
+    if (t->stack_free < HEALTH_STACK_LOW) {
+      ESP_LOGW(TAG, "%s: %" PRIu32 " bytes of stack left", t->name, t->stack_free);
+    }
+    prev[i].number = status[i].xTaskNumber;
+    prev[i].run_time = status[i].ulRunTimeCounter;
+  }
+  n_prev = n;
+  prev_total = total;
+}
+#else
+static void sample_tasks(health_t *h) {}
+#endif
+
+static void health_task(void *pvParameters) {
+  TickType_t wake = xTaskGetTickCount();
+  TickType_t period_start = wake;
+  float in_peak = 0.0f;
+  float out_peak = 0.0f;
+
+  while (1) {
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(HEALTH_SAMPLE_MS));
+    in_peak = fmaxf(in_peak, rb_fill(audio_element_get_input_ringbuf(dsp_el)));
+    out_peak = fmaxf(out_peak, rb_fill(audio_element_get_output_ringbuf(dsp_el)));
+    if (wake - period_start < pdMS_TO_TICKS(HEALTH_PERIOD_MS)) {
+      continue;
+    }
+    period_start = wake;
+
+    static health_t h;
+    memset(&h, 0, sizeof(h));
+    h.heap_free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    h.heap_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    h.in_rb_peak = in_peak;
+    h.out_rb_peak = out_peak;
+    sample_tasks(&h);
+    in_peak = out_peak = 0.0f;
+
+    portENTER_CRITICAL(&snapshot_lock);
+    snapshot = h;
+    portEXIT_CRITICAL(&snapshot_lock);
+
+    char record[96];
+    health_format(&h, record, sizeof(record));
+    ESP_LOGI(TAG, "%s", record);
+  }
+}
+
+esp_err_t health_init(audio_element_handle_t dsp) {
+  dsp_el = dsp;
+  if (STATIC_TASK_CREATE(health_task, "Health", 3072, NULL, tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create health task");
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+void health_get(health_t *out) {
+  portENTER_CRITICAL(&snapshot_lock);
+  *out = snapshot;
+  portEXIT_CRITICAL(&snapshot_lock);
+}
+
+int health_format(const health_t *h, char *buf, size_t len) {
+  int n = snprintf(buf, len, "cpu=");
+  for (int core = 0; core < portNUM_PROCESSORS && n < (int)len; core++) {
+    n += snprintf(buf + n, len - n, "%s%.0f", core ? "/" : "", h->core_load[core]);
+  }
+  if (n < (int)len) {
+    n += snprintf(buf + n, len - n, "%% heap=%" PRIu32 "/%" PRIu32 " rb=%.0f/%.0f%%", h->heap_free, h->heap_min_free,
+                  h->in_rb_peak, h->out_rb_peak);
+  }
+  return n;
+}
+
+void health_print(void) {
+  static health_t h;
+  health_get(&h);
+
+  char record[96];
+  health_format(&h, record, sizeof(record));
+  printf("%s\n", record);
+  printf("%-16s %6s %6s\n", "task", "cpu%", "stack");
+  for (int i = 0; i < h.n_tasks; i++) {
+    printf("%-16s %6.1f %6" PRIu32 "\n", h.tasks[i].name, h.tasks[i].cpu, h.tasks[i].stack_free);
+  }
+}
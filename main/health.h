@@ -0,0 +1,59 @@
+/**
+ * @file health.h
+ * @brief System health: CPU share and stack headroom of every task, heap and DSP ringbuffer fill.
+ *
+ * A low priority monitor task samples the ringbuffers around the DSP element every HEALTH_SAMPLE_MS and keeps
+ * the peak, and once a period (CONFIG_HEALTH_PERIOD_S) takes the FreeRTOS task list and heap figures. A one
+ * line summary is logged every period, the "health" console command prints the task table. CPU shares need
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS, they read 0 without it.
+ */
+#ifndef HEALTH_H_
+#define HEALTH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "audio_element.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Ringbuffer fill sampling interval, milliseconds
+#define HEALTH_SAMPLE_MS (100)
+// Tasks reported, the rest are left out
+#define HEALTH_MAX_TASKS (24)
+// A task with less stack than this never used is logged as a warning, bytes
+#define HEALTH_STACK_LOW (512)
+
+typedef struct {
+  char name[configMAX_TASK_NAME_LEN];
+  float cpu;           // share of one core over the last period, percent
+  uint32_t stack_free; // stack never used since the task started, bytes
+} health_task_t;
+
+typedef struct {
+  float core_load[portNUM_PROCESSORS]; // 100 - idle task share, percent
+  uint32_t heap_free;                  // 8 bit capable, bytes
+  uint32_t heap_min_free;              // lowest since boot, bytes
+  float in_rb_peak;                    // DSP input ringbuffer peak fill over the period, percent
+  float out_rb_peak;                   // DSP output ringbuffer peak fill, percent, 0 without one
+  int n_tasks;
+  health_task_t tasks[HEALTH_MAX_TASKS];
+} health_t;
+
+/**
+ * @brief Starts the monitor task.
+ *
+ * @param dsp the DSP element, its ringbuffers are sampled once the pipeline is linked
+ */
+esp_err_t health_init(audio_element_handle_t dsp);
+
+/** Returns the most recently published snapshot. */
+void health_get(health_t *out);
+
+/** Formats the one line summary, e.g. "cpu=35/12% heap=102400/98304 rb=40/3%". */
+int health_format(const health_t *h, char *buf, size_t len);
+
+/** Prints the snapshot with the task table to stdout. */
+void health_print(void);
+
+#endif // HEALTH_H_
@@ -0,0 +1,304 @@
+#include "latency.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+// hooks run in the source, DSP and decoder tasks
+static portMUX_TYPE latency_lock = portMUX_INITIALIZER_UNLOCKED;
+#define LATENCY_LOCK() portENTER_CRITICAL(&latency_lock)
+#define LATENCY_UNLOCK() portEXIT_CRITICAL(&latency_lock)
+#else
+#define LATENCY_LOCK()
+#define LATENCY_UNLOCK()
+#endif
+
+// key-ups between the generator and the decoder, a few characters
+#define LATENCY_PENDING (16)
+// dequeue times of the most recent edges, more than the decoder queue holds
+#define LATENCY_DEQUEUED (64)
+
+#define T_UNSET INT64_MIN
+
+enum { T_TRUE, T_EMIT, T_INPUT, T_DETECT, T_DEQUEUE, T_GLYPH, T_POINTS };
+
+typedef struct {
+  char c;
+  uint64_t sample;
+  int64_t t[T_POINTS];
+  uint32_t edge;  // number of the key-up edge, valid with t[T_DETECT]
+  bool confirmed; // character gap after the key-up edge seen
+} keyup_t;
+
+static struct {
+  bool active;
+  latency_clock_fn clock;
+  uint32_t sample_rate;
+  uint32_t dit;
+  bool paced;
+  int64_t origin;
+  bool inputs; // DSP input blocks are in the source sample domain (not loopback)
+
+  keyup_t pending[LATENCY_PENDING];
+  uint32_t head;
+  uint32_t tail; // oldest
+
+  uint32_t edges; // queued so far
+  uint32_t dequeued;
+  int64_t dequeue_t[LATENCY_DEQUEUED];
+
+  latency_stats_t stats;
+} lat;
+
+static const char *stage_names[LATENCY_STAGES] = {"block", "ringbuffer", "filter", "loop", "queue", "decoder", "total"};
+
+static void clear_stats(void) {
+  memset(&lat.stats, 0, sizeof(lat.stats));
+  for (int i = 0; i < LATENCY_STAGES; i++) {
+    lat.stats.stage[i].min_us = INT64_MAX;
+  }
+}
+
+void latency_start(latency_clock_fn clock, uint32_t sample_rate, uint32_t dit) {
+  LATENCY_LOCK();
+  lat.clock = clock;
+  lat.sample_rate = sample_rate;
+  lat.dit = dit;
+  lat.paced = false;
+  lat.inputs = false;
+  lat.head = lat.tail = 0;
+  lat.edges = lat.dequeued = 0;
+  clear_stats();
+  lat.active = true;
+  LATENCY_UNLOCK();
+}
+
+void latency_set_origin(int64_t t0_us) {
+  LATENCY_LOCK();
+  lat.origin = t0_us;
+  lat.paced = true;
+  LATENCY_UNLOCK();
+}
+
+void latency_keyup(char c, uint64_t sample, void *ctx) {
+  if (!lat.active) {
+    return;
+  }
+  LATENCY_LOCK();
+  if (lat.head - lat.tail == LATENCY_PENDING) {
+    lat.tail++;
+    lat.stats.missed++;
+  }
+  keyup_t *k = &lat.pending[lat.head++ % LATENCY_PENDING];
+  k->c = c;
+  k->sample = sample;
+  for (int i = 0; i < T_POINTS; i++) {
+    k->t[i] = T_UNSET;
+  }
+  if (lat.paced) {
+    k->t[T_TRUE] = lat.origin + (int64_t)(sample * 1000000 / lat.sample_rate);
+  }
+  k->confirmed = false;
+  LATENCY_UNLOCK();
+}
+
+static void stamp_block(int point, uint64_t end) {
+  int64_t now = lat.clock();
+  for (uint32_t i = lat.tail; i != lat.head; i++) {
+    keyup_t *k = &lat.pending[i % LATENCY_PENDING];
+    if (k->t[point] == T_UNSET && k->sample < end) {
+      k->t[point] = now;
+    }
+  }
+}
+
+void latency_source_block(uint64_t end) {
+  if (!lat.active) {
+    return;
+  }
+  LATENCY_LOCK();
+  stamp_block(T_EMIT, end);
+  LATENCY_UNLOCK();
+}
+
+void latency_dsp_block(uint64_t end) {
+  if (!lat.active) {
+    return;
+  }
+  LATENCY_LOCK();
+  lat.inputs = true;
+  stamp_block(T_INPUT, end);
+  LATENCY_UNLOCK();
+}
+
+// oldest key-up the DSP has seen and no character gap confirmed yet
+static keyup_t *detect_target(void) {
+  for (uint32_t i = lat.tail; i != lat.head; i++) {
+    keyup_t *k = &lat.pending[i % LATENCY_PENDING];
+    if (!k->confirmed) {
+      bool seen = lat.inputs ? k->t[T_INPUT] != T_UNSET : k->t[T_EMIT] != T_UNSET;
+      return seen ? k : NULL;
+    }
+  }
+  return NULL;
+}
+
+void latency_edge(int32_t e) {
+  if (!lat.active) {
+    return;
+  }
+  LATENCY_LOCK();
+  uint32_t n = lat.edges++;
+  keyup_t *k = detect_target();
+  if (k && e < 0) {
+    // every element ends with a key-up, the last one of the character is followed by a long gap
+    k->t[T_DETECT] = lat.clock();
+    k->edge = n;
+  } else if (k && e > 2 * (int32_t)lat.dit && k->t[T_DETECT] != T_UNSET) {
+    k->confirmed = true;
+  }
+  LATENCY_UNLOCK();
+}
+
+void latency_dequeue(void) {
+  if (!lat.active) {
+    return;
+  }
+  LATENCY_LOCK();
+  lat.dequeue_t[lat.dequeued++ % LATENCY_DEQUEUED] = lat.clock();
+  LATENCY_UNLOCK();
+}
+
+// 4 buckets per octave from 100us, bucket 0 is below that
+static int bucket_of(int64_t us) {
+  if (us < 100) {
+    return 0;
+  }
+  int b = 1 + (int)(4.0f * log2f(us / 100.0f));
+  return b < LATENCY_BUCKETS ? b : LATENCY_BUCKETS - 1;
+}
+
+static float bucket_top_ms(int b) { return 0.1f * exp2f(b / 4.0f); }
+
+static void add(latency_stage_t stage, int64_t from, int64_t to) {
+  if (from == T_UNSET || to == T_UNSET) {
+    return;
+  }
+  int64_t us = to > from ? to - from : 0; // stamps from different cores can be a few us apart
+  latency_hist_t *h = &lat.stats.stage[stage];
+  h->count++;
+  h->sum_us += us;
+  h->min_us = us < h->min_us ? us : h->min_us;
+  h->max_us = us > h->max_us ? us : h->max_us;
+  h->buckets[bucket_of(us)]++;
+}
+
+// pending key-up the glyph belongs to, its index from the tail, -1 if none
+static int find_keyup(uint64_t end_sample) {
+  if (!lat.inputs) {
+    // loopback, in order: a character confirmed before the previous one got its glyph was lost by the decoder
+    while (lat.head - lat.tail >= 2 && lat.pending[lat.tail % LATENCY_PENDING].confirmed &&
+           lat.pending[(lat.tail + 1) % LATENCY_PENDING].confirmed) {
+      lat.tail++;
+      lat.stats.missed++;
+    }
+    bool detected = lat.head != lat.tail && lat.pending[lat.tail % LATENCY_PENDING].t[T_DETECT] != T_UNSET;
+    return detected ? 0 : -1;
+  }
+  // the edge comes the filter delay after the key-up, the next character's key-up at least 4 dits later
+  for (uint32_t i = lat.tail; i != lat.head; i++) {
+    uint64_t s = lat.pending[i % LATENCY_PENDING].sample;
+    if (s + 3 * (uint64_t)lat.dit > end_sample && s <= end_sample + lat.dit) {
+      return (int)(i - lat.tail);
+    }
+  }
+  return -1;
+}
+
+void latency_glyph(char c, uint64_t end_sample) {
+  if (!lat.active) {
+    return;
+  }
+  LATENCY_LOCK();
+  int64_t now = lat.clock();
+
+  int found = find_keyup(end_sample);
+  if (found < 0) {
+    lat.stats.spurious++;
+    LATENCY_UNLOCK();
+    return;
+  }
+  // older key-ups without a glyph were lost by the decoder
+  lat.stats.missed += found;
+  lat.tail += found;
+  keyup_t *k = &lat.pending[lat.tail++ % LATENCY_PENDING];
+
+  if (k->c != c) {
+    lat.stats.mismatches++;
+    LATENCY_UNLOCK();
+    return;
+  }
+  lat.stats.chars++;
+
+  k->t[T_GLYPH] = now;
+  if (k->t[T_DETECT] != T_UNSET && lat.dequeued - k->edge - 1 < LATENCY_DEQUEUED) {
+    k->t[T_DEQUEUE] = lat.dequeue_t[k->edge % LATENCY_DEQUEUED];
+  }
+  add(LATENCY_BLOCK, k->t[T_TRUE], k->t[T_EMIT]);
+  if (k->t[T_INPUT] != T_UNSET) {
+    add(LATENCY_RINGBUFFER, k->t[T_EMIT], k->t[T_INPUT]);
+    add(LATENCY_FILTER, k->t[T_INPUT], k->t[T_DETECT]);
+  } else {
+    add(LATENCY_LOOP, k->t[T_EMIT], k->t[T_DETECT]);
+  }
+  add(LATENCY_QUEUE, k->t[T_DETECT], k->t[T_DEQUEUE]);
+  add(LATENCY_DECODER, k->t[T_DEQUEUE], k->t[T_GLYPH]);
+  add(LATENCY_TOTAL, k->t[T_TRUE] != T_UNSET ? k->t[T_TRUE] : k->t[T_EMIT], k->t[T_GLYPH]);
+  LATENCY_UNLOCK();
+}
+
+void latency_get_stats(latency_stats_t *stats) {
+  LATENCY_LOCK();
+  *stats = lat.stats;
+  LATENCY_UNLOCK();
+}
+
+// upper edge of the bucket holding the p-th fraction, clipped to the maximum
+static float percentile_ms(const latency_hist_t *h, float p) {
+  uint32_t want = (uint32_t)ceilf(p * h->count);
+  uint32_t seen = 0;
+  for (int b = 0; b < LATENCY_BUCKETS; b++) {
+    seen += h->buckets[b];
+    if (seen >= want && seen > 0) {
+      float top = bucket_top_ms(b);
+      return top < h->max_us / 1000.0f ? top : h->max_us / 1000.0f;
+    }
+  }
+  return h->max_us / 1000.0f;
+}
+
+void latency_report(void) {
+  static latency_stats_t s; // too big for the console task stack
+  latency_get_stats(&s);
+
+  printf("Latency, %lu chars, %lu mismatched, %lu missed, %lu spurious\n", (unsigned long)s.chars,
+         (unsigned long)s.mismatches, (unsigned long)s.missed, (unsigned long)s.spurious);
+  printf("%-10s %8s %8s %8s %8s %8s %8s  ms\n", "stage", "min", "p50", "p90", "p99", "max", "avg");
+  for (int i = 0; i < LATENCY_STAGES; i++) {
+    const latency_hist_t *h = &s.stage[i];
+    if (h->count == 0) {
+      continue;
+    }
+    printf("%-10s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f\n", stage_names[i], h->min_us / 1000.0f,
+           percentile_ms(h, 0.5f), percentile_ms(h, 0.9f), percentile_ms(h, 0.99f), h->max_us / 1000.0f,
+           h->sum_us / 1000.0f / h->count);
+  }
+}
+
+void latency_clear(void) {
+  LATENCY_LOCK();
+  clear_stats();
+  LATENCY_UNLOCK();
+}
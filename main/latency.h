@@ -0,0 +1,101 @@
+/**
+ * @file latency.h
+ * @brief Key-up to glyph latency of the self-test, split into pipeline stages.
+ *
+ * The CW generator reports the sample index of each character's key-up. Each stage stamps the pending
+ * key-ups with its clock as the sample moves through the pipeline:
+ *
+ *   true     key-up sample, origin + sample / rate (paced sources only)
+ *   emit     end of the source block holding it (I2S DMA buffer size, or the generator block)
+ *   input    DSP element reads that block (ringbuffer between the elements)
+ *   detect   key-up edge of the character's last element, confirmed by the gap after it (filters)
+ *   dequeue  decoder task takes that edge off the queue
+ *   glyph    handle_pause shows the character (decoder, mostly waiting for the character gap)
+ *
+ * In loopback the generator writes into the DAC output and the input sample domain is not known, emit
+ * is the DSP writing the output block and the codec round trip and filters are one LOOP stage.
+ * Glyphs are paired with the key-up whose sample is closest before the character's last key-up edge (within
+ * the filter delay), key-ups older than a paired one never got a glyph and count as missed, a different
+ * character counts as a mismatch. In loopback the sample domains differ and glyphs pair in order.
+ *
+ * Platform free, the clock is passed in (esp_timer on the device, simulated by tools/selftest_sim).
+ * Hooks do nothing until latency_start().
+ */
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+  LATENCY_BLOCK,      // key-up sample to its source block
+  LATENCY_RINGBUFFER, // source block to the DSP element
+  LATENCY_FILTER,     // DSP input to the key-up edge
+  LATENCY_LOOP,       // loopback: DAC output block to the key-up edge
+  LATENCY_QUEUE,      // key-up edge to the decoder task
+  LATENCY_DECODER,    // decoder task to the glyph
+  LATENCY_TOTAL,      // key-up to glyph
+  LATENCY_STAGES,
+} latency_stage_t;
+
+#define LATENCY_BUCKETS (64)
+
+typedef struct {
+  uint32_t count;
+  int64_t sum_us;
+  int64_t min_us;
+  int64_t max_us;
+  uint32_t buckets[LATENCY_BUCKETS]; // 4 per octave from 100us, see latency.c
+} latency_hist_t;
+
+typedef struct {
+  latency_hist_t stage[LATENCY_STAGES];
+  uint32_t chars;      // glyphs paired with their key-up
+  uint32_t mismatches; // paired with a different character
+  uint32_t missed;     // key-ups without a glyph
+  uint32_t spurious;   // glyphs without a key-up
+} latency_stats_t;
+
+/** @return microseconds, monotonic */
+typedef int64_t (*latency_clock_fn)(void);
+
+/**
+ * @brief Clears the statistics and starts accounting.
+ *
+ * @param dit generator dit length in samples, a key-up followed by a gap over 2 dits ends a character
+ */
+void latency_start(latency_clock_fn clock, uint32_t sample_rate, uint32_t dit);
+
+/** Time of sample 0 for sources paced by a clock, enables the BLOCK stage. */
+void latency_set_origin(int64_t t0_us);
+
+/** Key-up of character c at sample, a cw_gen_keyup_fn (ctx unused). */
+void latency_keyup(char c, uint64_t sample, void *ctx);
+
+/** Source (or loopback DSP output) block ending before sample end is out. */
+void latency_source_block(uint64_t end);
+
+/** DSP element read the block ending before sample end, same sample domain as the source. */
+void latency_dsp_block(uint64_t end);
+
+/** OOK edge queued for the decoder, e < 0 ends an on-segment. */
+void latency_edge(int32_t e);
+
+/** Decoder task took an edge off the queue. */
+void latency_dequeue(void);
+
+/**
+ * @brief Decoder showed glyph c.
+ *
+ * @param end_sample DSP input sample of the key-up edge ending the character's last element
+ */
+void latency_glyph(char c, uint64_t end_sample);
+
+void latency_get_stats(latency_stats_t *stats);
+
+/** Prints the distribution of each stage, ms. */
+void latency_report(void);
+
+void latency_clear(void);
+
+#endif // LATENCY_H_
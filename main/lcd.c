@@ -5,6 +5,7 @@
 #include "u8g2.h"
 #include "u8g2_esp32_hal.h"
 #include <ctype.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
@@ -23,8 +24,10 @@ static const char *TAG = "LCD";
 // https://github.com/olikraus/u8g2/wiki/fntlistmono#6-pixel-height
 #define FONT (u8g2_font_5x8_mf)
 // top line of pixels is clear, 7 lines, -1 y offset, 7*7-1=48
+// first line is the status line, the rest is scrolling text
 #define CHAR_HEIGHT (7)
-#define TEXT_LINES (7)
+#define STATUS_LINES (1)
+#define TEXT_LINES (7 - STATUS_LINES)
 // right line of pixels is clear, 17 columns, 17*5-1=84
 // #define CHAR_WIDTH (5)
 #define TEXT_COLUMNS (17)
@@ -32,8 +35,11 @@ static const char *TAG = "LCD";
 static u8g2_t u8g2;
 // text_buf stores TEXT_BUF_LEN characters, 0-terminated lines
 static char text_buf[TEXT_LINES][TEXT_COLUMNS + 1] = {0};
+static char status_buf[TEXT_COLUMNS + 1] = {0};
 static int current_line = 0;
 static int current_column = 0;
+// lcd_init() may run in a task of its own during boot, text printed before it is done shows with the next flush
+static atomic_bool ready = false;
 
 void lcd_init() {
   ESP_LOGI(TAG, "Starting U8g2 PCD8544...");
@@ -55,6 +61,7 @@ void lcd_init() {
   u8g2_SetPowerSave(&u8g2, 0);
 
   u8g2_SetFont(&u8g2, FONT);
+  atomic_store(&ready, true);
 
   ESP_LOGI(TAG, "Initialized PCD8544");
 }
@@ -74,14 +81,19 @@ void lcd_test() {
 }
 
 void lcd_flush() {
+  if (!atomic_load(&ready)) {
+    return;
+  }
   u8g2_ClearBuffer(&u8g2);
 
+  u8g2_DrawStr(&u8g2, 0, CHAR_HEIGHT - 1, status_buf);
+
   // current line is always at the bottom
   int y;
   int buf_line = current_line;
 
   for (int l = TEXT_LINES - 1; l >= 0; l--) {
-    y = (CHAR_HEIGHT - 1) + (CHAR_HEIGHT)*l;
+    y = (CHAR_HEIGHT - 1) + (CHAR_HEIGHT) * (l + STATUS_LINES);
     u8g2_DrawStr(&u8g2, 0, y, text_buf[buf_line]);
     buf_line--;
     if (buf_line < 0) {
@@ -118,6 +130,25 @@ void lcd_print(char ch) {
   text_buf[current_line][current_column] = 0;
 }
 
+void lcd_backspace() {
+  if (current_column == 0) {
+    // back to the end of the previous line
+    current_line = (current_line == 0) ? TEXT_LINES - 1 : current_line - 1;
+    current_column = strlen(text_buf[current_line]);
+  }
+
+  if (current_column > 0) {
+    current_column--;
+    text_buf[current_line][current_column] = 0;
+  }
+}
+
+void lcd_set_status(const char *cp) {
+  strncpy(status_buf, cp, TEXT_COLUMNS);
+  status_buf[TEXT_COLUMNS] = 0;
+  lcd_flush();
+}
+
 void lcd_print_flush(char ch) {
   lcd_print(ch);
   lcd_flush();
@@ -1,6 +1,7 @@
 #ifndef LCD_H_
 #define LCD_H_
 
+// text can be printed before lcd_init() is done, e.g. while it runs in another task, earlier flushes are skipped
 void lcd_init();
 
 void lcd_flush();
@@ -10,6 +11,12 @@ void lcd_print_str(const char *cp);
 
 void lcd_print_flush(char ch);
 
+// erases the last printed character, does not flush
+void lcd_backspace();
+
+// replaces the top status line and flushes
+void lcd_set_status(const char *cp);
+
 void lcd_test();
 
 #endif // LCD_H_
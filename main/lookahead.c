@@ -0,0 +1,166 @@
+#include "lookahead.h"
+
+#include <stdlib.h>
+
+#include "morse_code_table.h"
+#include "morse_decoder.h"
+#include "soft_decoder.h"
+#include "trace.h"
+
+void lookahead_reset(lookahead_t *la, int32_t dit_th) {
+  la->n = 0;
+  la->live_gaps = 0;
+  la->word_th = dit_th;
+  la->n_timing = 0;
+}
+
+void lookahead_push_timing(lookahead_t *la, int32_t dit_len, int32_t dah_len) {
+  if (la->n_timing >= LOOKAHEAD_MAX_CHARS) {
+    return;
+  }
+  la->dit_lens[la->n_timing] = dit_len;
+  la->dah_lens[la->n_timing] = dah_len;
+  la->n_timing++;
+}
+
+// upper median, insertion sort of a copy, at most LOOKAHEAD_MAX_CHARS values
+static int32_t median(const int32_t *v, int n) {
+  int32_t s[LOOKAHEAD_MAX_CHARS];
+  for (int i = 0; i < n; i++) {
+    int j = i;
+    for (; j > 0 && s[j - 1] > v[i]; j--) {
+      s[j] = s[j - 1];
+    }
+    s[j] = v[i];
+  }
+  return s[n / 2];
+}
+
+void lookahead_timing(const lookahead_t *la, int32_t *dit_len, int32_t *dah_len) {
+  if (la->n_timing == 0) {
+    return;
+  }
+  *dit_len = median(la->dit_lens, la->n_timing);
+  *dah_len = median(la->dah_lens, la->n_timing);
+}
+
+bool lookahead_push(lookahead_t *la, int32_t e, bool char_gap) {
+  if (la->n >= LOOKAHEAD_MAX_EDGES) {
+    return false;
+  }
+  if (char_gap) {
+    la->live_gaps |= 1ULL << la->n;
+  }
+  la->edges[la->n++] = e;
+  return true;
+}
+
+bool lookahead_threshold_shifted(const lookahead_t *la, int32_t dit_th) {
+  return la->n > 0 && abs(dit_th - la->word_th) * 4 > la->word_th;
+}
+
+// hard decision first, the most likely character of the same length if the sequence is not defined.
+// The soft decoder only runs for that fallback or when the confidence is asked for.
+static char lookup(uint16_t key, const int32_t *durations, int len, int32_t dit_len, int32_t dah_len,
+                   float *confidence) {
+  if (len > MORSE_CODE_MAX_LEN) {
+    return '~';
+  }
+
+  char c = morse_decoder_lookup(key);
+  if (c && confidence == NULL) {
+    return c;
+  }
+
+  soft_candidate_t candidates[SOFT_CANDIDATES];
+  float best = 0.0f;
+  int found = soft_decode(durations, len, dit_len, dah_len, candidates, SOFT_CANDIDATES, &best);
+  if (c) {
+    *confidence += soft_confidence_of(candidates, found, best, c);
+    return c;
+  }
+
+  // same floor as the live decode, see handle_pause()
+  if (found > 0 && best >= SOFT_MIN_CONFIDENCE) {
+    if (confidence != NULL) {
+      *confidence += best;
+    }
+    return candidates[0].character;
+  }
+  return '~';
+}
+
+int lookahead_decode(lookahead_t *la, int32_t dit_len, int32_t dah_len, bool final, char *out, int out_len,
+                     float *confidence) {
+  if (confidence != NULL) {
+    *confidence = 0.0f;
+  }
+  int32_t dit_th = dit_len + (dah_len - dit_len) / 2;
+  uint16_t key = MORSE_CODE_KEY_EMPTY;
+  int32_t durations[MORSE_CODE_MAX_LEN];
+  int code_len = 0;
+  int n = 0;
+
+  for (int i = 0; i < la->n && n < out_len; i++) {
+    int32_t e = la->edges[i];
+
+    if (e < 0) {
+      // key down, dit or dah
+      if (code_len < MORSE_CODE_MAX_LEN) {
+        key = morse_code_key_push(key, -e >= dit_th);
+        durations[code_len] = -e;
+      }
+      code_len++;
+    } else if (e >= dit_th && code_len > 0) {
+      // gap between characters
+      out[n] = lookup(key, durations, code_len, dit_len, dah_len, confidence);
+      n++;
+      key = MORSE_CODE_KEY_EMPTY;
+      code_len = 0;
+    }
+  }
+
+  if (final && code_len > 0 && n < out_len) {
+    out[n] = lookup(key, durations, code_len, dit_len, dah_len, confidence);
+    n++;
+  }
+
+  la->word_th = dit_th;
+  TRACE(LM, TRACE_REDECODE, la->n, n, 0);
+  return n;
+}
+
+// confidence of the given character for the durations, 0 if undecodable
+static float score(char c, const int32_t *durations, int len, int32_t dit_len, int32_t dah_len) {
+  soft_candidate_t candidates[SOFT_CANDIDATES];
+  float best = 0.0f;
+  if (c == '~' || len == 0 || len > MORSE_CODE_MAX_LEN) {
+    return 0.0f;
+  }
+  int found = soft_decode(durations, len, dit_len, dah_len, candidates, SOFT_CANDIDATES, &best);
+  return soft_confidence_of(candidates, found, best, c);
+}
+
+float lookahead_live_confidence(const lookahead_t *la, int32_t dit_len, int32_t dah_len, const char *live, int n) {
+  int32_t durations[MORSE_CODE_MAX_LEN];
+  int code_len = 0;
+  int k = 0;
+  float confidence = 0.0f;
+
+  for (int i = 0; i < la->n && k < n; i++) {
+    int32_t e = la->edges[i];
+    if (e < 0) {
+      if (code_len < MORSE_CODE_MAX_LEN) {
+        durations[code_len] = -e;
+      }
+      code_len++;
+    } else if (la->live_gaps & (1ULL << i)) {
+      confidence += score(live[k++], durations, code_len, dit_len, dah_len);
+      code_len = 0;
+    }
+  }
+  if (code_len > 0 && k < n) {
+    confidence += score(live[k], durations, code_len, dit_len, dah_len);
+  }
+  return confidence;
+}
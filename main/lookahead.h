@@ -0,0 +1,92 @@
+/**
+ * @file lookahead.h
+ * @brief Bounded buffer of the current word's edges, re-classified when the word ends or the timing model shifts.
+ *
+ * Edges are classified live against whatever the dit threshold happens to be at the time, so the first
+ * characters after a speed change come out wrong. The word's edges are kept here (fixed memory, no allocations)
+ * and decoded again with the updated threshold.
+ */
+#ifndef LOOKAHEAD_H_
+#define LOOKAHEAD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "morse_code_table.h"
+
+// Maximum number of edges buffered per word, ~ 10 characters
+#define LOOKAHEAD_MAX_EDGES (64)
+// Edges a character needs: the gap before it, the elements of the longest code and one more to tell it is too
+// long, the gaps between them
+#define LOOKAHEAD_CHAR_EDGES (2 * MORSE_CODE_MAX_LEN + 2)
+// Maximum number of characters a buffered word can decode into
+#define LOOKAHEAD_MAX_CHARS (LOOKAHEAD_MAX_EDGES / 2)
+
+typedef enum {
+  MORSE_LOOKAHEAD_OFF,     // characters are final as soon as they end, lowest latency
+  MORSE_LOOKAHEAD_CORRECT, // characters are shown as soon as they end and corrected when the word is re-decoded
+  MORSE_LOOKAHEAD_DEFER,   // words are shown once they end, already re-decoded
+} morse_lookahead_mode_t;
+
+typedef struct {
+  int32_t edges[LOOKAHEAD_MAX_EDGES];    // edges of the current word, as in morse_sample
+  int n;                                 // number of buffered edges
+  int32_t word_th;                       // dit threshold the buffered edges were last decoded with
+  uint64_t live_gaps;                    // bit i set if edge i ended a character in the live decode
+  int32_t dit_lens[LOOKAHEAD_MAX_CHARS]; // dit/dah estimates after each key down of the word
+  int32_t dah_lens[LOOKAHEAD_MAX_CHARS];
+  int n_timing;                          // number of recorded estimates
+} lookahead_t;
+
+void lookahead_reset(lookahead_t *la, int32_t dit_th);
+
+/**
+ * @param char_gap the live decode took the edge for a gap between characters
+ * @return false if the buffer is full, the edge is not stored
+ */
+bool lookahead_push(lookahead_t *la, int32_t e, bool char_gap);
+
+/** Records the dit/dah estimates after a key down edge of the word */
+void lookahead_push_timing(lookahead_t *la, int32_t dit_len, int32_t dah_len);
+
+/**
+ * @brief Median of the dit/dah estimates recorded for the word.
+ *
+ * A noise pulse at the end of a word moves the histogram peaks for its last element only, the median keeps
+ * the timing the rest of the word was sent with. Left unchanged if nothing was recorded.
+ */
+void lookahead_timing(const lookahead_t *la, int32_t *dit_len, int32_t *dah_len);
+
+/** @return true if the threshold moved by more than 25% since the word was last decoded */
+bool lookahead_threshold_shifted(const lookahead_t *la, int32_t dit_th);
+
+/**
+ * @brief Decodes buffered edges with the given timing model.
+ *
+ * Dit/dah and element/character gap threshold is half way between dit and dah lengths,
+ * undefined sequences fall back to the soft decoder's best candidate above SOFT_MIN_CONFIDENCE.
+ *
+ * @param dit_len dit length estimate, samples
+ * @param dah_len dah length estimate, samples
+ * @param final true at the end of the word, the trailing (not yet terminated by a gap) character is decoded too
+ * @param[out] out decoded characters, '~' for undecodable ones, not 0-terminated
+ * @param out_len size of out
+ * @param[out] confidence sum of the soft decoder confidences of the decoded characters, 0 for '~', may be NULL,
+ * the soft decoder then only runs for sequences that are not a code
+ * @return number of decoded characters
+ */
+int lookahead_decode(lookahead_t *la, int32_t dit_len, int32_t dah_len, bool final, char *out, int out_len,
+                     float *confidence);
+
+/**
+ * @brief Scores the live characters of the word with the given timing model, as lookahead_decode() does.
+ *
+ * The buffered edges are split where the live decode ended its characters, the trailing character is included.
+ *
+ * @param live characters the live decode reported for the buffered edges, '~' for undecodable ones
+ * @param n number of live characters
+ * @return sum of the soft decoder confidences of the live characters
+ */
+float lookahead_live_confidence(const lookahead_t *la, int32_t dit_len, int32_t dah_len, const char *live, int n);
+
+#endif // LOOKAHEAD_H_
@@ -1,31 +1,104 @@
 #include "audio_dsp.h"
 #include "audio_pipeline.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "freertos/task.h"
 #include "i2s_stream.h"
+#include "sdkconfig.h"
+#include <inttypes.h>
 
+#include "boot.h"
 #include "configure_es8388.h"
+#include "console.h"
+#include "cw_source.h"
+#include "decode_stream.h"
+#include "health.h"
 #include "lcd.h"
 #include "leds.h"
 #include "morse.h"
+#include "replay_stream.h"
+#include "static_alloc.h"
+#include "trace.h"
+#include "transcript.h"
 
 static const char *TAG = "MAIN";
 
+#ifdef CONFIG_AUDIO_SOURCE_REPLAY
+// Nothing follows the DSP element when replaying at max speed, its output is dropped here
+static int discard(audio_element_handle_t self, char *buffer, int len, TickType_t ticks_to_wait, void *context) {
+  return len;
+}
+
+// Prints throughput, DSP cost and the text decoded from the recording
+static void replay_report(audio_element_handle_t replay, audio_element_handle_t dsp) {
+  replay_stream_stats_t r;
+  audio_dsp_stats_t d;
+  replay_stream_get_stats(replay, &r);
+  audio_dsp_get_stats(dsp, &d);
+
+  float secs = r.elapsed_us / 1e6f;
+  ESP_LOGI(TAG, "Replay: %" PRIu64 " samples in %.3f s, %.0f samples/s, %.1fx realtime", r.samples, secs,
+           secs > 0 ? r.samples / secs : 0.0f, secs > 0 ? r.samples / secs / 44100.0f : 0.0f);
+  if (d.blocks > 0) {
+    ESP_LOGI(TAG, "DSP: %" PRIu32 " blocks, cycles/block min %" PRIu32 " avg %" PRIu64 " max %" PRIu32
+                  ", %.1f cycles/sample",
+             d.blocks, d.cycles_min, d.cycles / d.blocks, d.cycles_max, (float)d.cycles / d.samples);
+  }
+
+  // the decoder finishes the last word after a second of silence, the transcript writes it out in batches
+  vTaskDelay(pdMS_TO_TICKS(TRANSCRIPT_FLUSH_MS + 2000));
+  char text[65];
+  size_t n;
+  uint64_t text_from = transcript_boot_offset();
+  printf("Decoded text:\n");
+  while ((n = transcript_read(&text_from, text, sizeof(text) - 1)) > 0) {
+    text[n] = 0;
+    printf("%s", text);
+  }
+  printf("\n");
+}
+#endif
+
+// The display comes up on its own SPI bus while the codec is set up over I2C, text decoded before it is
+// ready shows with the next flush
+static void lcd_init_task(void *pvParameters) {
+  lcd_init();
+  boot_mark("lcd");
+  vTaskDelete(NULL);
+}
+
+// Boot order: what the first decoded character depends on (decoder, codec, pipeline) first, the LCD alongside,
+// then the console and the health monitor. The transcript mounts in its writer task, see transcript.h.
 void app_main(void) {
   // esp_log_level_set("*", ESP_LOG_INFO);
   // esp_log_level_set(TAG, ESP_LOG_DEBUG);
+  size_t heap_at_start = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  boot_mark("app_main");
 
   leds_init();
-  lcd_init();
+  if (STATIC_TASK_CREATE(lcd_init_task, "LcdInit", 3072, NULL, tskIDLE_PRIORITY + 2, NULL) != pdPASS) {
+    lcd_init();
+  }
+  trace_init();
+
+  if (transcript_init() != ESP_OK) {
+    ESP_LOGW(TAG, "Transcript is not saved");
+  }
 
+#ifdef CONFIG_DECODE_STREAM
+  if (decode_stream_init() != ESP_OK) {
+    ESP_LOGW(TAG, "No decode stream");
+  }
+#endif
   ESP_ERROR_CHECK(morse_init());
+  boot_mark("decoder");
 
   audio_pipeline_handle_t pipeline;
-  audio_element_handle_t i2s_stream_writer, i2s_stream_reader, audio_dsp_el;
-
+  audio_element_handle_t i2s_stream_writer, source_el, audio_dsp_el;
   ESP_LOGI(TAG, "Start codec chip");
   configure_es8388();
+  boot_mark("codec");
   // ESP_ERROR_CHECK(es8388_pa_power(true)); // enable speaker amp power
 
   ESP_LOGI(TAG, "Create audio pipeline for playback");
@@ -37,10 +110,26 @@ void app_main(void) {
   i2s_cfg.type = AUDIO_STREAM_WRITER;
   i2s_stream_writer = i2s_stream_init(&i2s_cfg);
 
+#ifdef CONFIG_AUDIO_SOURCE_REPLAY
+  ESP_LOGI(TAG, "Create replay stream to read the recording from flash");
+  replay_stream_cfg_t replay_cfg = DEFAULT_REPLAY_STREAM_CONFIG();
+  replay_cfg.loops = CONFIG_REPLAY_LOOPS;
+  source_el = replay_stream_init(&replay_cfg);
+  mem_assert(source_el);
+#elif defined(CONFIG_AUDIO_SOURCE_SELFTEST)
+  ESP_LOGI(TAG, "Create CW generator for the self-test");
+  cw_source_cfg_t cw_cfg = DEFAULT_CW_SOURCE_CONFIG();
+  cw_cfg.text = CONFIG_SELFTEST_TEXT;
+  cw_cfg.wpm = CONFIG_SELFTEST_WPM;
+  cw_cfg.freq_hz = CONFIG_SELFTEST_FREQ;
+  source_el = cw_source_init(&cw_cfg);
+  mem_assert(source_el);
+#else
   ESP_LOGI(TAG, "Create i2s stream to read data from codec chip");
   i2s_stream_cfg_t i2s_cfg_read = I2S_STREAM_CFG_DEFAULT();
   i2s_cfg_read.type = AUDIO_STREAM_READER;
-  i2s_stream_reader = i2s_stream_init(&i2s_cfg_read);
+  source_el = i2s_stream_init(&i2s_cfg_read);
+#endif
 
   ESP_LOGI(TAG, "Create audio dsp element");
   audio_dsp_cfg_t dsp_cfg = DEFAULT_AUDIO_DSP_CONFIG();
@@ -48,15 +137,25 @@ void app_main(void) {
   mem_assert(audio_dsp_el);
 
   ESP_LOGI(TAG, "Register all elements to audio pipeline");
-  audio_pipeline_register(pipeline, i2s_stream_reader, "i2s_read");
+  audio_pipeline_register(pipeline, source_el, "source");
   audio_pipeline_register(pipeline, audio_dsp_el, "dsp");
   audio_pipeline_register(pipeline, i2s_stream_writer, "i2s_write");
 
+#ifdef CONFIG_REPLAY_MAX_SPEED
+  ESP_LOGI(TAG, "Link elements: "
+                "[flash]-->source-->audio_dsp");
+  audio_element_set_write_cb(audio_dsp_el, discard, NULL);
+  audio_element_handle_t last_el = audio_dsp_el;
+  const char *link_tag[2] = {"source", "dsp"};
+  audio_pipeline_link(pipeline, &link_tag[0], 2);
+#else
   ESP_LOGI(TAG, "Link elements: "
-                "[codec]-->i2s_read-->audio_dsp-->i2s_write-->[codec]");
+                "[codec/flash/generator]-->source-->audio_dsp-->i2s_write-->[codec]");
+  audio_element_handle_t last_el = i2s_stream_writer;
   // Define the tags for linking in the correct order
-  const char *link_tag[3] = {"i2s_read", "dsp", "i2s_write"};
+  const char *link_tag[3] = {"source", "dsp", "i2s_write"};
   audio_pipeline_link(pipeline, &link_tag[0], 3);
+#endif
 
   ESP_LOGI(TAG, "Set up  event listener");
   audio_event_iface_cfg_t evt_cfg = AUDIO_EVENT_IFACE_DEFAULT_CFG();
@@ -67,6 +166,19 @@ void app_main(void) {
 
   ESP_LOGI(TAG, "Start audio_pipeline");
   audio_pipeline_run(pipeline);
+  boot_mark("pipeline");
+
+  if (health_init(audio_dsp_el) != ESP_OK) {
+    ESP_LOGW(TAG, "No health monitor");
+  }
+
+  if (console_init() != ESP_OK) {
+    ESP_LOGW(TAG, "No console");
+  }
+  // with CONFIG_STATIC_MEMORY this is ADF, the drivers and the console only, tools/ram_budget.py has the rest
+  boot_mark("console");
+  size_t heap_free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  ESP_LOGI(TAG, "Startup took %u bytes of heap, %u left", (unsigned)(heap_at_start - heap_free), (unsigned)heap_free);
 
   ESP_LOGI(TAG, "Listen for all pipeline events");
   while (1) {
@@ -77,9 +189,9 @@ void app_main(void) {
       continue;
     }
 
-    /* Stop when the last pipeline element (i2s_stream_writer in this case)
+    /* Stop when the last pipeline element (i2s_stream_writer, or dsp when replaying at max speed)
      * receives stop event */
-    if (msg.source_type == AUDIO_ELEMENT_TYPE_ELEMENT && msg.source == (void *)i2s_stream_writer &&
+    if (msg.source_type == AUDIO_ELEMENT_TYPE_ELEMENT && msg.source == (void *)last_el &&
         msg.cmd == AEL_MSG_CMD_REPORT_STATUS &&
         (((int)msg.data == AEL_STATUS_STATE_STOPPED) || ((int)msg.data == AEL_STATUS_STATE_FINISHED))) {
       ESP_LOGW(TAG, "[ * ] Stop event received");
@@ -87,12 +199,16 @@ void app_main(void) {
     }
   }
 
+#ifdef CONFIG_AUDIO_SOURCE_REPLAY
+  replay_report(source_el, audio_dsp_el);
+#endif
+
   ESP_LOGI(TAG, "Stop audio_pipeline");
   audio_pipeline_stop(pipeline);
   audio_pipeline_wait_for_stop(pipeline);
   audio_pipeline_terminate(pipeline);
 
-  audio_pipeline_unregister(pipeline, i2s_stream_reader);
+  audio_pipeline_unregister(pipeline, source_el);
   audio_pipeline_unregister(pipeline, audio_dsp_el);
   audio_pipeline_unregister(pipeline, i2s_stream_writer);
 
@@ -106,6 +222,6 @@ void app_main(void) {
 
   /* Release all resources */
   audio_pipeline_deinit(pipeline);
-  audio_element_deinit(i2s_stream_reader);
+  audio_element_deinit(source_el);
   audio_element_deinit(i2s_stream_writer);
 }
@@ -1,165 +1,201 @@
 #include "morse.h"
 
-#include "char_buffer.h"
-#include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "freertos/task.h"
+#include "sdkconfig.h"
 #include <esp_check.h> // For ESP_RETURN_ON_FALSE checks
 #include <esp_err.h>
 #include <esp_log.h>
-#include <inttypes.h>
+#include <esp_timer.h>
 #include <math.h>
 #include <stdint.h>
-#include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 
-#include "char_buffer.h"
-#include "decaying_histogram.h"
-#include "lcd.h"
-#include "leds.h"
-#include "morse_decoder.h"
+#include "boot.h"
+#include "edge_capture.h"
+#include "latency.h"
+#include "morse_core.h"
+#include "params.h"
+#include "static_alloc.h"
+#include "telemetry.h"
+#include "timing.h"
+#include "trace.h"
 
 static const char *TAG = "MORSE";
 
-// pulses shorted than this will be merged with the longer pulse, value is in units of time/sample
-static const int32_t PULSE_WIDTH_MIN = 1000;
-static const int32_t PULSE_WIDTH_MAX = 12000;
+#ifdef CONFIG_REPLAY_MAX_SPEED
+// the DSP runs ahead of realtime and must not lose edges, it waits for the decoder instead
+#define MORSE_QUEUE_WAIT portMAX_DELAY
+#else
+#define MORSE_QUEUE_WAIT 0
+#endif
 
-// Queue of decoded edge transitions, uint32_t elements
+// Queue of decoded edge transitions, morse_edge_t elements
 static QueueHandle_t morse_ook_queue;
 
-// "dit/dah" pulse length histogram
-static decaying_histogram_t dit_dah_len_his;
-
-static char_buffer_t *dit_dah_buf = NULL;
-static char_buffer_t *text_buf = NULL;
-
-// current dit threshold
-static int32_t dit_th = 0;
-
-// active low/high range, just for debugging
-static float range = 0.0f;
-
-#define TSECS(samples) ((float)samples / 44100.0)
+static struct {
+  morse_char_fn fn;
+  morse_word_fn word_fn;
+  void *ctx;
+} listeners[MORSE_CHAR_LISTENERS];
+static int n_listeners = 0;
+
+// stamps the decision time, feeds the latency telemetry and the listeners
+static void on_char(const morse_char_t *ch, void *ctx) {
+  morse_char_t stamped = *ch;
+  stamped.decoded_us = esp_timer_get_time();
+
+  static bool first = true;
+  if (first) {
+    boot_mark("first char");
+    first = false;
+  }
 
-esp_err_t morse_init() {
-  morse_ook_queue = xQueueCreate(16, sizeof(uint32_t));
-  ESP_RETURN_ON_FALSE(morse_ook_queue != NULL, ESP_ERR_INVALID_STATE, TAG, "failed to create queue");
+  if (stamped.queued_us != 0) {
+    // waiting for the gap in samples, then the DSP to decoder stages in time
+    float gap_ms = (stamped.decided_sample - stamped.end_sample) * 1000.0f / MORSE_SAMPLE_RATE;
+    telemetry_record_latency(gap_ms + (stamped.decoded_us - stamped.queued_us) / 1000.0f);
+  }
+  for (int i = 0; i < n_listeners; i++) {
+    if (listeners[i].fn) {
+      listeners[i].fn(&stamped, listeners[i].ctx);
+    }
+  }
+}
 
-  BaseType_t task_created =
-      xTaskCreate(morse_sample_handler_task, "MorseHandler", configMINIMAL_STACK_SIZE * 4, NULL, 5, NULL);
+// stamps the decision time of a finished word for the listeners
+static void on_word(const morse_word_t *w, void *ctx) {
+  morse_word_t stamped = *w;
+  stamped.decoded_us = esp_timer_get_time();
 
-  if (task_created != pdPASS) {
-    ESP_LOGE(TAG, "Failed to create morse sample handler task");
-    vQueueDelete(morse_ook_queue);
-    return ESP_ERR_INVALID_STATE;
+  for (int i = 0; i < n_listeners; i++) {
+    if (listeners[i].word_fn) {
+      listeners[i].word_fn(&stamped, listeners[i].ctx);
+    }
   }
+}
 
-  ESP_ERROR_CHECK(decaying_histogram_init(&dit_dah_len_his, PULSE_WIDTH_MIN, PULSE_WIDTH_MAX, 256, 0.8f));
+// decoder settings last applied, the histogram is only rebuilt when one of them changes
+static uint32_t params_generation_applied = 0;
+static float pulse_params[4];
+// re-decoding restarts the current word when the mode changes
+static morse_lookahead_mode_t lookahead_mode;
+
+static void apply_modes(const float *v) {
+  morse_lookahead_mode_t mode = (morse_lookahead_mode_t)lroundf(v[PARAM_LOOKAHEAD]);
+  if (mode != lookahead_mode) {
+    morse_core_set_lookahead_mode(mode);
+    lookahead_mode = mode;
+  }
+}
 
-  dit_dah_buf = char_buffer_init(64);
-  text_buf = char_buffer_init(32);
+static void apply_params(void) {
+  float v[PARAM_COUNT];
+  uint32_t generation;
+  if (!params_snapshot(v, &generation)) {
+    return; // being written, next time
+  }
+  params_generation_applied = generation;
+  apply_modes(v);
 
-  morse_decoder_init();
+  float p[4] = {v[PARAM_PULSE_MIN], v[PARAM_PULSE_MAX], v[PARAM_HIST_BINS], v[PARAM_HIST_DECAY]};
+  if (memcmp(p, pulse_params, sizeof(p)) == 0) {
+    return;
+  }
+  esp_err_t err = morse_core_set_histogram((int32_t)p[0], (int32_t)p[1], (int)p[2], p[3]);
+  if (err == ESP_OK) {
+    memcpy(pulse_params, p, sizeof(p));
+    TRACE(TLM, TRACE_HISTOGRAM, (int32_t)p[1], (int32_t)p[2] << 16 | (int32_t)p[0], (int16_t)lroundf(p[3] * 1000));
+  } else {
+    TRACE(TLM, TRACE_HISTOGRAM, err, 0, -1);
+  }
+}
 
-  ESP_LOGI(TAG, "Initialization complete");
+esp_err_t morse_add_char_listener(morse_char_fn fn, void *ctx) {
+  ESP_RETURN_ON_FALSE(n_listeners < MORSE_CHAR_LISTENERS, ESP_ERR_NO_MEM, TAG, "too many char listeners");
+  listeners[n_listeners].fn = fn;
+  listeners[n_listeners].word_fn = NULL;
+  listeners[n_listeners].ctx = ctx;
+  n_listeners++;
   return ESP_OK;
 }
 
-static void log_buffers() {
-  ESP_LOGW(TAG, "%s", char_buffer_get_string(dit_dah_buf));
-  ESP_LOGW(TAG, "%s", char_buffer_get_string(text_buf));
-  char_buffer_reset(dit_dah_buf);
-  char_buffer_reset(text_buf);
+esp_err_t morse_add_word_listener(morse_word_fn fn, void *ctx) {
+  ESP_RETURN_ON_FALSE(n_listeners < MORSE_CHAR_LISTENERS, ESP_ERR_NO_MEM, TAG, "too many word listeners");
+  listeners[n_listeners].fn = NULL;
+  listeners[n_listeners].word_fn = fn;
+  listeners[n_listeners].ctx = ctx;
+  n_listeners++;
+  return ESP_OK;
 }
 
-static void handle_on_to_off_transition(int32_t abse) {
-  decaying_histogram_add_sample(&dit_dah_len_his, abse);
-  dit_th = decaying_histogram_get_threshold(&dit_dah_len_his);
+esp_err_t morse_init() {
+  morse_ook_queue = STATIC_QUEUE_CREATE(16, sizeof(morse_edge_t));
+  ESP_RETURN_ON_FALSE(morse_ook_queue != NULL, ESP_ERR_INVALID_STATE, TAG, "failed to create queue");
 
-  if (abse >= dit_th) {
-    ESP_LOGD(TAG, "- %0.3f / %0.3f", TSECS(abse), TSECS(dit_th));
-    decode_morse_signal('-');
-    char_buffer_append_char(dit_dah_buf, '-');
-  } else {
-    ESP_LOGD(TAG, ". %0.3f / %0.3f", TSECS(abse), TSECS(dit_th));
-    decode_morse_signal('.');
-    char_buffer_append_char(dit_dah_buf, '.');
+  // decoder state is ready before the first edge arrives
+  ESP_ERROR_CHECK(morse_core_init());
+  morse_core_set_char_fn(on_char, NULL);
+  morse_core_set_word_fn(on_word, NULL);
+  // morse_core_init() starts from the parameter defaults
+  pulse_params[0] = params_desc(PARAM_PULSE_MIN)->def;
+  pulse_params[1] = params_desc(PARAM_PULSE_MAX)->def;
+  pulse_params[2] = params_desc(PARAM_HIST_BINS)->def;
+  pulse_params[3] = params_desc(PARAM_HIST_DECAY)->def;
+  lookahead_mode = (morse_lookahead_mode_t)lroundf(params_desc(PARAM_LOOKAHEAD)->def);
+  morse_core_set_lookahead_mode(lookahead_mode);
+  // warm start from the last saved timing
+  if (timing_init() != ESP_OK) {
+    ESP_LOGW(TAG, "No timing snapshots");
   }
-}
 
-static void handle_pause() {
-  char c = decode_morse_signal(' ');
+  BaseType_t task_created =
+      STATIC_TASK_CREATE(morse_sample_handler_task, "MorseHandler", configMINIMAL_STACK_SIZE * 4, NULL, 5, NULL);
 
-  if (c) {
-    lcd_print_flush(c);
-    if (!char_buffer_append_char(text_buf, c)) {
-      log_buffers();
-      char_buffer_append_char(text_buf, c);
-    }
-    char_buffer_append_char(dit_dah_buf, ' ');
-    ESP_LOGD(TAG, "%c", c);
-  } else {
-    // decaying_histogram_dump(&dit_dah_len_his);
-    ESP_LOGD(TAG, "? %0.3f", TSECS(dit_th));
-    char_buffer_append_char(text_buf, '~');
-    lcd_print_flush('~');
+  if (task_created != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create morse sample handler task");
+    vQueueDelete(morse_ook_queue);
+    return ESP_ERR_INVALID_STATE;
   }
-}
-
-static void handle_off_to_on_transition(int32_t abse) {
-  if (abse >= dit_th) { // dit + (dah - dit)/2
-    handle_pause();
 
-    if (abse > 3 * dit_th) {
-      log_buffers();
-      lcd_print_flush(' ');
-      ESP_LOGD(TAG, "~~~ %0.3f", TSECS(abse));
-      gpio_set_level(LED_PIN_1, 0);
-    } else {
-      ESP_LOGD(TAG, "~~ %0.3f", TSECS(abse));
-      gpio_set_level(LED_PIN_1, 0);
-    }
-  } else {
-    ESP_LOGD(TAG, "~ %0.3f", TSECS(abse));
-    gpio_set_level(LED_PIN_1, 1);
-  }
+  return ESP_OK;
 }
 
 void morse_sample_handler_task(void *pvParameters) {
-  int32_t e = 0;
-  int32_t abse = 0;
-  bool should_handle_last_pause = true;
+  morse_edge_t edge;
+  bool first_edge = true;
 
   const TickType_t xTicksToWait = pdMS_TO_TICKS(1000); // 1sec max wait
 
   while (1) {
-    if (xQueueReceive(morse_ook_queue, &e, xTicksToWait) == pdTRUE) {
-      should_handle_last_pause = true;
-      abse = abs(e);
-
-      if (e < 0) {
-        handle_on_to_off_transition(abse);
-        gpio_set_level(LED_PIN_2, 0);
-      } else {
-        handle_off_to_on_transition(abse);
-        gpio_set_level(LED_PIN_2, 1);
+    if (xQueueReceive(morse_ook_queue, &edge, xTicksToWait) == pdTRUE) {
+      edge.dequeued_us = esp_timer_get_time();
+      if (first_edge) {
+        boot_mark("first edge");
+        first_edge = false;
       }
+      latency_dequeue();
+      morse_core_edge(&edge);
     } else {
-      if (should_handle_last_pause) {
-        handle_pause();
-        log_buffers();
-      }
-      should_handle_last_pause = false;
-      decaying_histogram_decay(&dit_dah_len_his);
+      morse_core_idle();
+    }
+    timing_poll();
+
+    if (params_generation() != params_generation_applied) {
+      apply_params();
     }
+    telemetry_poll();
   }
 }
 
-esp_err_t morse_sample(int32_t e, float r) {
-  range = r;
-  xQueueSend(morse_ook_queue, (void *)&e, (TickType_t)0);
+esp_err_t morse_sample(int32_t e, float range, uint64_t sample) {
+  edge_capture_record(e, range);
+  morse_edge_t edge = {.e = e, .sample = sample, .queued_us = esp_timer_get_time()};
+  if (xQueueSend(morse_ook_queue, (void *)&edge, (TickType_t)MORSE_QUEUE_WAIT) == pdTRUE) {
+    latency_edge(e);
+  } else {
+    telemetry_record_edge_dropped();
+  }
   return ESP_OK;
 }
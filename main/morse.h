@@ -3,9 +3,13 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include <stdint.h>
 #include "esp_err.h"
+#include "lookahead.h"
+#include "morse_core.h"
+
 
+// Sample rate of the DSP element, edge durations and sample indexes are in these units
+#define MORSE_SAMPLE_RATE (44100)
 
 esp_err_t morse_init();
 
@@ -15,7 +19,21 @@ void morse_sample_handler_task(void *pvParameters);
 /** Sample OOK edge.
  *  @param e edge, sign represents transition +/- for positive/negative, absolute value is the number of samples (pulse duration in units of time/sample)
  *  @param range OOK threshold effective range, the bigger the better, for debugging / display
+ *  @param sample index of the sample that ended the segment, counted by the DSP element since start
+ */
+esp_err_t morse_sample(int32_t e, float range, uint64_t sample);
+
+// Number of morse_add_char_listener() and morse_add_word_listener() slots, shared
+#define MORSE_CHAR_LISTENERS (4)
+
+/** Registers fn for every decoded character with its sample indexes and stage times, see morse_char_t.
+ *  Called from the decoder task, must be quick. Register before morse_init().
+ */
+esp_err_t morse_add_char_listener(morse_char_fn fn, void *ctx);
+
+/** Registers fn for every finished word, re-decoded and corrected, in place of its characters, see morse_word_t.
+ *  Called from the decoder task after the word's characters, must be quick. Register before morse_init().
  */
-esp_err_t morse_sample(int32_t e, float range);
+esp_err_t morse_add_word_listener(morse_word_fn fn, void *ctx);
 
 #endif // MORSE_H_
@@ -0,0 +1,43 @@
+#include "morse_code_table.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#if !defined(CONFIG_MORSE_ALPHABET_LATIN) && !defined(CONFIG_MORSE_ALPHABET_CYRILLIC) &&                            \
+    !defined(CONFIG_MORSE_ALPHABET_WABUN)
+// not configured (e.g. host builds), same as the Kconfig defaults
+#define CONFIG_MORSE_ALPHABET_LATIN 1
+#define CONFIG_MORSE_PROSIGNS 1
+#endif
+
+#include "morse_tables.h"
+
+const char *morse_code_table_name(void) { return MORSE_TABLE_NAME; }
+
+char morse_code_glyph(uint16_t key) { return key < MORSE_CODE_KEYS ? (char)morse_code_glyphs[key] : 0; }
+
+uint16_t morse_code_key_of(char glyph) {
+  for (uint16_t key = MORSE_CODE_KEY_EMPTY + 1; glyph != 0 && key < MORSE_CODE_KEYS; key++) {
+    if (morse_code_glyphs[key] == (uint8_t)glyph) {
+      return key;
+    }
+  }
+  return MORSE_CODE_KEY_EMPTY;
+}
+
+const char *morse_glyph_text(char glyph) {
+  uint8_t g = (uint8_t)glyph;
+  if (g < MORSE_GLYPH_FIRST) {
+    return morse_ascii_texts[g];
+  }
+  return g - MORSE_GLYPH_FIRST < MORSE_GLYPHS ? morse_glyph_texts[g - MORSE_GLYPH_FIRST] : "~";
+}
+
+const char *morse_glyph_lcd_text(char glyph) {
+  uint8_t g = (uint8_t)glyph;
+  if (g < MORSE_GLYPH_FIRST) {
+    return morse_ascii_texts[g];
+  }
+  return g - MORSE_GLYPH_FIRST < MORSE_GLYPHS ? morse_glyph_lcd_texts[g - MORSE_GLYPH_FIRST] : "~";
+}
@@ -0,0 +1,48 @@
+/**
+ * @file morse_code_table.h
+ * @brief Compile-time selected Morse alphabet, shared by the hard and the soft decoders.
+ *
+ * A code is a key, (1 << length) | elements, first element in the most significant bit, dah = 1.
+ * Decoding is a shift per element and a single load from a read-only table generated by
+ * tools/gen_morse_tables.py. Alphabet and prosigns are selected with menuconfig (Morse decoder).
+ *
+ * Decoded characters are glyphs, plain ASCII below MORSE_GLYPH_FIRST, ids of multi byte
+ * transcript text (prosigns, Cyrillic, kana) above it.
+ */
+#ifndef MORSE_CODE_TABLE_H_
+#define MORSE_CODE_TABLE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Longest dit/dah sequence in the table
+#define MORSE_CODE_MAX_LEN (8)
+// Number of keys, every code up to MORSE_CODE_MAX_LEN elements
+#define MORSE_CODE_KEYS (2 << MORSE_CODE_MAX_LEN)
+// Key of the empty code
+#define MORSE_CODE_KEY_EMPTY (1)
+
+/** @return key with one more element, stays >= MORSE_CODE_KEYS once the code is too long */
+static inline uint16_t morse_code_key_push(uint16_t key, bool dah) {
+  return key < MORSE_CODE_KEYS ? (uint16_t)((key << 1) | dah) : key;
+}
+
+/** @return number of elements in the key */
+static inline int morse_code_key_len(uint16_t key) { return 31 - __builtin_clz(key); }
+
+/** @return name of the selected alphabet variant */
+const char *morse_code_table_name(void);
+
+/** @return glyph of the code or 0 if the code is not defined */
+char morse_code_glyph(uint16_t key);
+
+/** @return key of the glyph, MORSE_CODE_KEY_EMPTY if the alphabet has no code for it (linear search) */
+uint16_t morse_code_key_of(char glyph);
+
+/** @return transcript text of the glyph, UTF-8 */
+const char *morse_glyph_text(char glyph);
+
+/** @return LCD text of the glyph, ASCII */
+const char *morse_glyph_lcd_text(char glyph);
+
+#endif // MORSE_CODE_TABLE_H_
@@ -0,0 +1,504 @@
+#include "morse_core.h"
+
+#include "driver/gpio.h"
+#include <esp_err.h>
+#include <esp_log.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#include "audio_capture.h"
+#include "decaying_histogram.h"
+#include "edge_filter.h"
+#include "latency.h"
+#include "lcd.h"
+#include "leds.h"
+#include "lookahead.h"
+#include "morse_code_table.h"
+#include "morse_decoder.h"
+#include "soft_decoder.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "transcript.h"
+
+static const char *TAG = "MORSE";
+
+// pulses shorter than this are not counted towards dit/dah statistics, value is in units of time/sample
+static const int32_t PULSE_WIDTH_MIN = 1000;
+static const int32_t PULSE_WIDTH_MAX = 12000;
+
+// pulses and gaps shorter than a third of a dit are merged with their neighbours by the glitch filter,
+// merge threshold stays within [GLITCH_WIDTH_MIN, PULSE_WIDTH_MIN]
+static const int32_t GLITCH_WIDTH_MIN = 150;
+
+// "dit/dah" pulse length histogram
+static decaying_histogram_t dit_dah_len_his;
+#ifdef CONFIG_STATIC_MEMORY
+// sized for the largest hist_bins parameter, re-initialized in place
+#define MORSE_HIST_MAX_BINS (1024)
+static float dit_dah_len_bins[MORSE_HIST_MAX_BINS];
+#endif
+
+static edge_filter_t glitch_filter;
+
+// edges of the current word, re-decoded when the word ends
+static lookahead_t lookahead;
+static morse_lookahead_mode_t lookahead_mode = MORSE_LOOKAHEAD_CORRECT;
+
+// key down durations of the current character, for the soft decoder
+static int32_t char_elements[MORSE_CODE_MAX_LEN];
+static int char_elements_n = 0;
+
+// sample indexes of the current character, passed to char_fn with the glyph
+static morse_char_t char_times;
+static morse_char_fn char_fn = NULL;
+static void *char_ctx = NULL;
+
+// the current word and the characters reported for it, passed to word_fn once it is re-decoded
+static morse_word_t word_times;
+static int word_reported = 0;
+// live characters of the current word, kept if re-decoding does not beat them
+static char word_live[LOOKAHEAD_MAX_CHARS];
+static morse_word_fn word_fn = NULL;
+static void *word_ctx = NULL;
+
+// input edge being handled (NULL on idle), end sample of the filtered edge released by it
+static const morse_edge_t *cur_edge = NULL;
+static uint64_t edge_end = 0;
+static uint64_t last_sample = 0;
+
+// characters of the current word that are on the LCD, MORSE_LOOKAHEAD_CORRECT only
+static char word_shown[LOOKAHEAD_MAX_CHARS];
+static int word_shown_len = 0;
+
+// current dit/dah length estimates and the threshold between them
+static int32_t dit_len = 0;
+static int32_t dah_len = 0;
+static int32_t dit_th = 0;
+
+// the last pause of a transmission has not been handled yet
+static bool should_handle_last_pause = true;
+// no character reported since the last word gap
+static bool word_ended = true;
+
+esp_err_t morse_core_init(void) {
+#ifdef CONFIG_STATIC_MEMORY
+  ESP_ERROR_CHECK(decaying_histogram_init_static(&dit_dah_len_his, dit_dah_len_bins, PULSE_WIDTH_MIN, PULSE_WIDTH_MAX,
+                                                 256, 0.8f));
+#else
+  ESP_ERROR_CHECK(decaying_histogram_init(&dit_dah_len_his, PULSE_WIDTH_MIN, PULSE_WIDTH_MAX, 256, 0.8f));
+#endif
+  edge_filter_init(&glitch_filter, GLITCH_WIDTH_MIN, PULSE_WIDTH_MIN);
+  lookahead_reset(&lookahead, 0);
+
+  morse_decoder_init();
+  soft_decoder_init();
+  telemetry_init();
+
+  ESP_LOGI(TAG, "Initialization complete");
+  return ESP_OK;
+}
+
+// Marks the end of a word in the trace, the formatter logs its elements and text
+static void log_word() {
+  TRACE(MORSE, TRACE_THRESHOLD, dit_len, dah_len, 0);
+  TRACE(MORSE, TRACE_WORD, 0, 0, 0);
+}
+
+// Appends the transcript text of a glyph to the flash transcript
+static void append_text(char c) {
+  const char *text = morse_glyph_text(c);
+
+  TRACE(MORSE, TRACE_TEXT, (uint8_t)c, 0, 0);
+  transcript_append(text, strlen(text));
+}
+
+static void lcd_print_glyph(char c) { lcd_print_str(morse_glyph_lcd_text(c)); }
+
+// Brings the current word on the LCD in line with the re-decoded one, erases only what changed
+static void correct_shown_word(const char *word, int n) {
+  int same = 0;
+  while (same < n && same < word_shown_len && word[same] == word_shown[same]) {
+    same++;
+  }
+
+  if (same == n && same == word_shown_len) {
+    return;
+  }
+
+  TRACE(MORSE, TRACE_CORRECT, same, n, 0);
+
+  for (int i = same; i < word_shown_len; i++) {
+    for (size_t j = strlen(morse_glyph_lcd_text(word_shown[i])); j > 0; j--) {
+      lcd_backspace();
+    }
+  }
+  for (int i = same; i < n; i++) {
+    lcd_print_glyph(word[i]);
+    word_shown[i] = word[i];
+  }
+  word_shown_len = n;
+  lcd_flush();
+}
+
+// passes the finished word to word_fn, in place of the characters reported since the last one
+static void report_word(const char *word, int n) {
+  int reported = word_reported;
+  word_reported = 0;
+  if (!word_fn || (n == 0 && reported == 0)) {
+    return;
+  }
+  if (reported == 0) {
+    word_times.word_start = false;
+    word_times.start_sample = edge_end;
+  }
+  word_times.glyphs = word;
+  word_times.n = n;
+  word_times.n_reported = reported;
+  word_times.decided_sample = edge_end;
+  word_times.decoded_us = 0;
+  word_fn(&word_times, word_ctx);
+}
+
+// Re-decodes buffered edges of the current word with the latest threshold.
+// final - word has ended, its text goes to word_fn and the transcript and the buffer is cleared
+static void redecode_word(bool final) {
+  if (lookahead_mode == MORSE_LOOKAHEAD_OFF) {
+    word_reported = 0;
+    return;
+  }
+
+  char word[LOOKAHEAD_MAX_CHARS];
+  int32_t word_dit = dit_len;
+  int32_t word_dah = dah_len;
+  lookahead_timing(&lookahead, &word_dit, &word_dah);
+  float confidence = 0.0f;
+  int n = lookahead_decode(&lookahead, word_dit, word_dah, final, word, sizeof(word), final ? &confidence : NULL);
+
+  // The live characters stay unless the re-decoded ones explain the word's timing better: scored with the same
+  // timing, higher mean confidence and no characters split off at gaps the live decode took for element gaps
+  int live = word_reported < LOOKAHEAD_MAX_CHARS ? word_reported : LOOKAHEAD_MAX_CHARS;
+  if (final && live > 0) {
+    float live_confidence = lookahead_live_confidence(&lookahead, word_dit, word_dah, word_live, live);
+    if (n > live || confidence * live < live_confidence * n) {
+      TRACE(LM, TRACE_KEEP_LIVE, (int32_t)(confidence * 1000 / (n > 0 ? n : 1)),
+            (int32_t)(live_confidence * 1000 / live), 0);
+      memcpy(word, word_live, live);
+      n = live;
+    }
+  }
+
+  if (lookahead_mode == MORSE_LOOKAHEAD_CORRECT) {
+    correct_shown_word(word, n);
+  } else if (final) {
+    for (int i = 0; i < n; i++) {
+      lcd_print_glyph(word[i]);
+    }
+    lcd_flush();
+  }
+
+  if (final) {
+    report_word(word, n);
+    for (int i = 0; i < n; i++) {
+      append_text(word[i]);
+    }
+    lookahead_reset(&lookahead, dit_th);
+    word_shown_len = 0;
+  }
+}
+
+// Buffers an edge of the current word. A word that does not fit is cut at a character gap, while the next
+// character still fits, so re-decoding never splits a character. A character too long for any code may not
+// fit, the elements past LOOKAHEAD_CHAR_EDGES are dropped, it decodes to '~' either way.
+static void buffer_edge(int32_t e, bool char_gap) {
+  if (lookahead_mode == MORSE_LOOKAHEAD_OFF) {
+    return;
+  }
+
+  if (char_gap && lookahead.n + LOOKAHEAD_CHAR_EDGES > LOOKAHEAD_MAX_EDGES) {
+    redecode_word(true);
+  }
+  lookahead_push(&lookahead, e, char_gap);
+}
+
+// Live output of a decoded character
+static void show_char(char c) {
+  switch (lookahead_mode) {
+  case MORSE_LOOKAHEAD_OFF:
+    lcd_print_glyph(c);
+    lcd_flush();
+    append_text(c);
+    break;
+  case MORSE_LOOKAHEAD_CORRECT:
+    lcd_print_glyph(c);
+    lcd_flush();
+    if (word_shown_len < LOOKAHEAD_MAX_CHARS) {
+      word_shown[word_shown_len++] = c;
+    }
+    break;
+  case MORSE_LOOKAHEAD_DEFER:
+    break;
+  }
+}
+
+// dit/dah estimates and everything that follows them, from the current histogram
+static void update_dit_dah_len(void) {
+  // same as decaying_histogram_get_threshold but keeps both peaks for telemetry
+  decaying_histogram_get_min_max_values(&dit_dah_len_his, &dit_len, &dah_len);
+  dit_th = dit_len + (dah_len - dit_len) / 2;
+  edge_filter_set_dit_len(&glitch_filter, dit_len);
+}
+
+static void handle_on_to_off_transition(int32_t abse) {
+  decaying_histogram_add_sample(&dit_dah_len_his, abse);
+  update_dit_dah_len();
+
+  buffer_edge(-abse, false);
+  if (lookahead_mode != MORSE_LOOKAHEAD_OFF) {
+    lookahead_push_timing(&lookahead, dit_len, dah_len);
+  }
+  if (lookahead_threshold_shifted(&lookahead, dit_th)) {
+    // fix up characters completed so far, no need to wait for the end of the word
+    redecode_word(false);
+  }
+
+  if (char_elements_n == 0) {
+    char_times.start_sample = edge_end - abse;
+  }
+  if (char_elements_n < MORSE_CODE_MAX_LEN) {
+    char_elements[char_elements_n] = abse;
+    char_times.element_end[char_elements_n] = edge_end;
+  }
+  char_elements_n++;
+
+  TRACE(MORSE, TRACE_ELEMENT, abse, dit_th, 0);
+  decode_morse_signal(abse >= dit_th ? '-' : '.');
+}
+
+// passes the glyph with the sample indexes and stage times of the character to char_fn
+static void report_char(char c, int n, float confidence, bool soft, uint64_t end_sample) {
+  bool word_start = word_ended;
+  word_ended = false;
+  if (word_reported < LOOKAHEAD_MAX_CHARS) {
+    word_live[word_reported] = c;
+  }
+  if (word_reported++ == 0) {
+    word_times.word_start = word_start;
+    word_times.start_sample = n > 0 ? char_times.start_sample : edge_end;
+  }
+  if (!char_fn) {
+    return;
+  }
+  char_times.c = c;
+  char_times.word_start = word_start;
+  char_times.confidence = confidence;
+  char_times.soft = soft;
+  char_times.dit_len = dit_len;
+  char_times.n_elements = n < MORSE_CODE_MAX_LEN ? n : MORSE_CODE_MAX_LEN;
+  if (n == 0) {
+    char_times.start_sample = edge_end;
+  }
+  char_times.end_sample = end_sample;
+  char_times.decided_sample = edge_end;
+  char_times.queued_us = cur_edge ? cur_edge->queued_us : 0;
+  char_times.dequeued_us = cur_edge ? cur_edge->dequeued_us : 0;
+  char_times.decoded_us = 0;
+  char_fn(&char_times, char_ctx);
+}
+
+static void handle_pause() {
+  char c = decode_morse_signal(' ');
+  bool soft = false;
+
+  soft_candidate_t candidates[SOFT_CANDIDATES];
+  float best = 0.0f;
+  int n = char_elements_n;
+  int last = (n < MORSE_CODE_MAX_LEN ? n : MORSE_CODE_MAX_LEN) - 1;
+  uint64_t end_sample = last >= 0 ? char_times.element_end[last] : edge_end;
+  int found = soft_decode(char_elements, char_elements_n, dit_len, dah_len, candidates, SOFT_CANDIDATES, &best);
+  char_elements_n = 0;
+
+  float confidence = 0.0f;
+  if (c) {
+    confidence = soft_confidence_of(candidates, found, best, c);
+  } else if (found > 0 && best >= SOFT_MIN_CONFIDENCE) {
+    // not a valid dit/dah sequence, take the most likely character of the same length if it stands out
+    c = candidates[0].character;
+    confidence = best;
+    soft = true;
+  }
+
+  telemetry_record_char(c != 0, soft, confidence);
+  TRACE(MORSE, TRACE_CHAR, (uint8_t)c, (int32_t)(confidence * 1000), soft);
+  latency_glyph(c ? c : '~', end_sample);
+  report_char(c ? c : '~', n, confidence, soft, end_sample);
+
+  if (c) {
+    show_char(c);
+  } else {
+    // decaying_histogram_dump(&dit_dah_len_his);
+    show_char('~');
+    audio_capture_trigger();
+  }
+}
+
+static void handle_off_to_on_transition(int32_t abse) {
+  if (abse >= dit_th) { // dit + (dah - dit)/2
+    handle_pause();
+
+    if (abse > 3 * dit_th) {
+      word_ended = true;
+      redecode_word(true);
+      append_text(' ');
+      log_word();
+      lcd_print_flush(' ');
+      TRACE(MORSE, TRACE_GAP, abse, dit_th, 3);
+      gpio_set_level(LED_PIN_1, 0);
+    } else {
+      buffer_edge(abse, true);
+      TRACE(MORSE, TRACE_GAP, abse, dit_th, 2);
+      gpio_set_level(LED_PIN_1, 0);
+    }
+  } else {
+    buffer_edge(abse, false);
+    TRACE(MORSE, TRACE_GAP, abse, dit_th, 1);
+    gpio_set_level(LED_PIN_1, 1);
+  }
+}
+
+static void handle_edge(int32_t e) {
+  int32_t abse = abs(e);
+
+  if (e < 0) {
+    handle_on_to_off_transition(abse);
+    gpio_set_level(LED_PIN_2, 0);
+  } else {
+    handle_off_to_on_transition(abse);
+    gpio_set_level(LED_PIN_2, 1);
+  }
+
+  telemetry_record_edge(dit_len, dah_len);
+}
+
+void morse_core_edge(const morse_edge_t *edge) {
+  should_handle_last_pause = true;
+  int32_t e = edge_filter_update(&glitch_filter, edge->e);
+
+  // an edge released by the filter ended where the new one started
+  cur_edge = edge;
+  edge_end = edge->sample - abs(edge->e);
+  last_sample = edge->sample;
+  if (e != 0) {
+    handle_edge(e);
+  }
+  cur_edge = NULL;
+}
+
+void morse_core_idle(void) {
+  if (should_handle_last_pause) {
+    int32_t e = edge_filter_flush(&glitch_filter);
+    edge_end = last_sample;
+    if (e != 0) {
+      handle_edge(e);
+    }
+    handle_pause();
+    word_ended = true;
+    redecode_word(true);
+    append_text(' ');
+    log_word();
+  }
+  should_handle_last_pause = false;
+  decaying_histogram_decay(&dit_dah_len_his);
+}
+
+void morse_core_set_lookahead_mode(morse_lookahead_mode_t mode) {
+  // takes effect from the next word
+  lookahead_reset(&lookahead, dit_th);
+  word_shown_len = 0;
+  word_reported = 0;
+  lookahead_mode = mode;
+}
+
+esp_err_t morse_core_set_histogram(int32_t pulse_min, int32_t pulse_max, int bins, float decay) {
+  decaying_histogram_t his;
+#ifdef CONFIG_STATIC_MEMORY
+  // the counts start over either way, the new range is checked before the bins are cleared
+  if (bins > MORSE_HIST_MAX_BINS) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  esp_err_t err = decaying_histogram_init_static(&his, dit_dah_len_bins, pulse_min, pulse_max, bins, decay);
+#else
+  esp_err_t err = decaying_histogram_init(&his, pulse_min, pulse_max, bins, decay);
+#endif
+  if (err != ESP_OK) {
+    return err;
+  }
+  decaying_histogram_free(&dit_dah_len_his);
+  dit_dah_len_his = his;
+
+  glitch_filter.max_width = pulse_min;
+  edge_filter_set_dit_len(&glitch_filter, dit_len);
+  return ESP_OK;
+}
+
+void morse_core_get_timing(morse_timing_t *t) {
+  memset(t, 0, sizeof(*t));
+  t->pulse_min = dit_dah_len_his.min_val;
+  t->pulse_max = dit_dah_len_his.max_val;
+  t->dit_len = dit_len;
+  t->dah_len = dah_len;
+  if (dit_dah_len_his.num_bins > MORSE_TIMING_MAX_BINS) {
+    return;
+  }
+
+  float max = 0.0f;
+  for (int i = 0; i < dit_dah_len_his.num_bins; i++) {
+    max = fmaxf(max, dit_dah_len_his.bins[i]);
+  }
+  t->bins = dit_dah_len_his.num_bins;
+  t->scale = max > 0.0f ? max / 255 : 1.0f;
+  for (int i = 0; i < dit_dah_len_his.num_bins; i++) {
+    t->counts[i] = (uint8_t)lroundf(dit_dah_len_his.bins[i] / t->scale);
+  }
+}
+
+esp_err_t morse_core_set_timing(const morse_timing_t *t) {
+  if (t->dit_len <= 0 || t->dah_len <= t->dit_len) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  decaying_histogram_t *his = &dit_dah_len_his;
+  if (t->pulse_min == his->min_val && t->pulse_max == his->max_val && t->bins == his->num_bins) {
+    for (int i = 0; i < his->num_bins; i++) {
+      his->bins[i] = t->counts[i] * t->scale;
+    }
+  } else {
+    // histogram settings changed since the snapshot, only the speed carries over
+    if (t->dit_len < his->min_val || t->dah_len > his->max_val) {
+      return ESP_ERR_INVALID_SIZE;
+    }
+    memset(his->bins, 0, his->num_bins * sizeof(float));
+    decaying_histogram_add_sample(his, t->dit_len);
+    decaying_histogram_add_sample(his, t->dah_len);
+  }
+
+  update_dit_dah_len();
+  lookahead_reset(&lookahead, dit_th);
+  ESP_LOGI(TAG, "Timing restored, dit %d dah %d samples", (int)dit_len, (int)dah_len);
+  return ESP_OK;
+}
+
+void morse_core_set_char_fn(morse_char_fn fn, void *ctx) {
+  char_fn = fn;
+  char_ctx = ctx;
+}
+
+void morse_core_set_word_fn(morse_word_fn fn, void *ctx) {
+  word_fn = fn;
+  word_ctx = ctx;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file morse_core.h
+ * @brief Platform free part of the decoder: dit/dah statistics, element, character and word decisions.
+ *
+ * Driven by the decoder task on the device (morse.c) and by host tools replaying recorded edges
+ * (tools/edge_replay), which provide their own LCD, LED and transcript functions. Not thread safe,
+ * all calls come from a single task.
+ */
+#ifndef MORSE_CORE_H_
+#define MORSE_CORE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lookahead.h"
+#include "morse_code_table.h"
+
+/**
+ * An OOK edge as queued for the decoder. Samples are counted by the DSP element from the start of the
+ * pipeline (64 bit, never wraps), edge durations are contiguous so each edge starts where the previous
+ * one ended. Times are esp_timer microseconds, 0 where there is no clock (host tools).
+ */
+typedef struct {
+  int32_t e;           // see morse_sample()
+  uint64_t sample;     // index of the sample that ended the segment
+  int64_t queued_us;   // DSP queued the edge
+  int64_t dequeued_us; // decoder task took it off the queue
+} morse_edge_t;
+
+/** A decoded character with the sample indexes of its elements and the stage times of its decision. */
+typedef struct {
+  char c;                                  // glyph, '~' when nothing matched
+  bool word_start;                         // first character after a word gap or idle
+  float confidence;                        // soft decoder confidence of c, 0..1
+  bool soft;                               // c is the soft decoder's guess, the dit/dah sequence is not a code
+  int32_t dit_len;                         // dit length estimate at the decision, samples
+  int n_elements;                          // elements in element_end, up to MORSE_CODE_MAX_LEN
+  uint64_t start_sample;                   // key-down of the first element
+  uint64_t element_end[MORSE_CODE_MAX_LEN]; // key-up of each element
+  uint64_t end_sample;                     // key-up of the last element
+  uint64_t decided_sample;                 // end of the gap that completed the character
+  int64_t queued_us;                       // edge that completed it queued by the DSP, 0 on idle
+  int64_t dequeued_us;                     // that edge taken by the decoder task, 0 on idle
+  int64_t decoded_us;                      // character decided, stamped by morse.c
+} morse_char_t;
+
+/**
+ * A finished word as it goes to the transcript, re-decoded with the timing learned over it. It
+ * replaces the characters reported for it one by one, lookahead modes other than MORSE_LOOKAHEAD_OFF only.
+ */
+typedef struct {
+  const char *glyphs;      // n glyphs, '~' when nothing matched
+  int n;
+  int n_reported;          // characters of the word passed to morse_char_fn before, the ones it replaces
+  bool word_start;         // after a word gap or idle, false for the rest of a word cut for length
+  uint64_t start_sample;   // key-down of the first element
+  uint64_t decided_sample; // end of the gap that completed the word
+  int64_t decoded_us;      // word decided, stamped by morse.c
+} morse_word_t;
+
+// Bins of the largest histogram a timing snapshot holds, the hist_bins parameter limit
+#define MORSE_TIMING_MAX_BINS (1024)
+
+/**
+ * Learned timing, the dit/dah length histogram quantized to 8 bits per bin. Saved across reboots
+ * (timing.h) so decoding starts at the last speed instead of an empty histogram.
+ */
+typedef struct {
+  int32_t pulse_min; // histogram range and size the counts belong to
+  int32_t pulse_max;
+  int32_t dit_len;   // estimates at the snapshot, samples
+  int32_t dah_len;
+  float scale;       // counts[i] * scale is the decayed count of bin i
+  uint16_t bins;     // entries in counts, 0 when the histogram doesn't fit
+  uint16_t reserved;
+  uint8_t counts[MORSE_TIMING_MAX_BINS];
+} morse_timing_t;
+
+/** Called from the decoder task for every character shown, before the LCD and the transcript. */
+typedef void (*morse_char_fn)(const morse_char_t *ch, void *ctx);
+
+/** Called from the decoder task for every finished word, after its characters and before the transcript. */
+typedef void (*morse_word_fn)(const morse_word_t *w, void *ctx);
+
+esp_err_t morse_core_init(void);
+
+/** Handles an OOK edge, see morse_sample(). */
+void morse_core_edge(const morse_edge_t *edge);
+
+/**
+ * @brief Replaces the dit/dah length histogram, the speed is learned again from the next pulse.
+ *
+ * @param pulse_min shortest pulse counted, samples, also the upper bound of the glitch filter threshold
+ * @param pulse_max longest pulse counted, samples
+ * @param bins number of histogram bins
+ * @param decay histogram decay per idle second, 0..1
+ */
+esp_err_t morse_core_set_histogram(int32_t pulse_min, int32_t pulse_max, int bins, float decay);
+
+/** Takes a snapshot of the learned timing. */
+void morse_core_get_timing(morse_timing_t *t);
+
+/**
+ * @brief Continues from a snapshot. Counts are restored when the histogram still has the same range and size,
+ * otherwise it is seeded with the dit and dah lengths alone.
+ *
+ * @return ESP_ERR_INVALID_ARG if nothing was learned yet, ESP_ERR_INVALID_SIZE if the lengths are out of range
+ */
+esp_err_t morse_core_set_timing(const morse_timing_t *t);
+
+/** Receives every decoded character, NULL turns it off. */
+void morse_core_set_char_fn(morse_char_fn fn, void *ctx);
+
+/** Receives every finished word, NULL turns it off. */
+void morse_core_set_word_fn(morse_word_fn fn, void *ctx);
+
+/** Called when no edge arrived for a second: finishes the last character and word, decays statistics. */
+void morse_core_idle(void);
+
+void morse_core_set_lookahead_mode(morse_lookahead_mode_t mode);
+
+#endif // MORSE_CORE_H_
@@ -0,0 +1,631 @@
+// Generated by tools/gen_morse_tables.py, do not edit
+#ifndef MORSE_TABLES_H_
+#define MORSE_TABLES_H_
+
+#include <stdint.h>
+
+#define MORSE_GLYPH_FIRST (0x80)
+#define MORSE_GLYPHS (96)
+
+// transcript (UTF-8) text of glyph ids >= MORSE_GLYPH_FIRST
+static const char *const morse_glyph_texts[MORSE_GLYPHS] = {
+    "<KN>",
+    "<BT>",
+    "<AR>",
+    "<AS>",
+    "<SK>",
+    "<KA>",
+    "<VE>",
+    "<HH>",
+    "<BK>",
+    "А",
+    "Б",
+    "В",
+    "Г",
+    "Д",
+    "Е",
+    "Ж",
+    "З",
+    "И",
+    "Й",
+    "К",
+    "Л",
+    "М",
+    "Н",
+    "О",
+    "П",
+    "Р",
+    "С",
+    "Т",
+    "У",
+    "Ф",
+    "Х",
+    "Ц",
+    "Ч",
+    "Ш",
+    "Щ",
+    "Ъ",
+    "Ы",
+    "Ь",
+    "Э",
+    "Ю",
+    "Я",
+    "イ",
+    "ロ",
+    "ハ",
+    "ニ",
+    "ホ",
+    "ヘ",
+    "ト",
+    "チ",
+    "リ",
+    "ヌ",
+    "ル",
+    "ヲ",
+    "ワ",
+    "カ",
+    "ヨ",
+    "タ",
+    "レ",
+    "ソ",
+    "ツ",
+    "ネ",
+    "ナ",
+    "ラ",
+    "ム",
+    "ウ",
+    "ヰ",
+    "ノ",
+    "オ",
+    "ク",
+    "ヤ",
+    "マ",
+    "ケ",
+    "フ",
+    "コ",
+    "エ",
+    "テ",
+    "ア",
+    "サ",
+    "キ",
+    "ユ",
+    "メ",
+    "ミ",
+    "シ",
+    "ヱ",
+    "ヒ",
+    "モ",
+    "セ",
+    "ス",
+    "ン",
+    "゛",
+    "゜",
+    "ー",
+    "、",
+    "。",
+    "（",
+    "）",
+};
+
+// LCD (ASCII) text of glyph ids >= MORSE_GLYPH_FIRST
+static const char *const morse_glyph_lcd_texts[MORSE_GLYPHS] = {
+    "<KN>",
+    "<BT>",
+    "<AR>",
+    "<AS>",
+    "<SK>",
+    "<KA>",
+    "<VE>",
+    "<HH>",
+    "<BK>",
+    "A",
+    "B",
+    "V",
+    "G",
+    "D",
+    "E",
+    "ZH",
+    "Z",
+    "I",
+    "J",
+    "K",
+    "L",
+    "M",
+    "N",
+    "O",
+    "P",
+    "R",
+    "S",
+    "T",
+    "U",
+    "F",
+    "H",
+    "C",
+    "CH",
+    "SH",
+    "SC",
+    "\"",
+    "Y",
+    "'",
+    "E",
+    "YU",
+    "YA",
+    "I",
+    "RO",
+    "HA",
+    "NI",
+    "HO",
+    "HE",
+    "TO",
+    "CHI",
+    "RI",
+    "NU",
+    "RU",
+    "WO",
+    "WA",
+    "KA",
+    "YO",
+    "TA",
+    "RE",
+    "SO",
+    "TSU",
+    "NE",
+    "NA",
+    "RA",
+    "MU",
+    "U",
+    "WI",
+    "NO",
+    "O",
+    "KU",
+    "YA",
+    "MA",
+    "KE",
+    "FU",
+    "KO",
+    "E",
+    "TE",
+    "A",
+    "SA",
+    "KI",
+    "YU",
+    "ME",
+    "MI",
+    "SHI",
+    "WE",
+    "HI",
+    "MO",
+    "SE",
+    "SU",
+    "N",
+    "\"",
+    "*",
+    "-",
+    ",",
+    ".",
+    "(",
+    ")",
+};
+
+// text of plain ASCII glyphs, each character followed by a terminator
+static const char morse_ascii_texts[128][2] = {
+    {0x00, 0}, {0x01, 0}, {0x02, 0}, {0x03, 0}, {0x04, 0}, {0x05, 0}, {0x06, 0}, {0x07, 0},
+    {0x08, 0}, {0x09, 0}, {0x0A, 0}, {0x0B, 0}, {0x0C, 0}, {0x0D, 0}, {0x0E, 0}, {0x0F, 0},
+    {0x10, 0}, {0x11, 0}, {0x12, 0}, {0x13, 0}, {0x14, 0}, {0x15, 0}, {0x16, 0}, {0x17, 0},
+    {0x18, 0}, {0x19, 0}, {0x1A, 0}, {0x1B, 0}, {0x1C, 0}, {0x1D, 0}, {0x1E, 0}, {0x1F, 0},
+    {0x20, 0}, {0x21, 0}, {0x22, 0}, {0x23, 0}, {0x24, 0}, {0x25, 0}, {0x26, 0}, {0x27, 0},
+    {0x28, 0}, {0x29, 0}, {0x2A, 0}, {0x2B, 0}, {0x2C, 0}, {0x2D, 0}, {0x2E, 0}, {0x2F, 0},
+    {0x30, 0}, {0x31, 0}, {0x32, 0}, {0x33, 0}, {0x34, 0}, {0x35, 0}, {0x36, 0}, {0x37, 0},
+    {0x38, 0}, {0x39, 0}, {0x3A, 0}, {0x3B, 0}, {0x3C, 0}, {0x3D, 0}, {0x3E, 0}, {0x3F, 0},
+    {0x40, 0}, {0x41, 0}, {0x42, 0}, {0x43, 0}, {0x44, 0}, {0x45, 0}, {0x46, 0}, {0x47, 0},
+    {0x48, 0}, {0x49, 0}, {0x4A, 0}, {0x4B, 0}, {0x4C, 0}, {0x4D, 0}, {0x4E, 0}, {0x4F, 0},
+    {0x50, 0}, {0x51, 0}, {0x52, 0}, {0x53, 0}, {0x54, 0}, {0x55, 0}, {0x56, 0}, {0x57, 0},
+    {0x58, 0}, {0x59, 0}, {0x5A, 0}, {0x5B, 0}, {0x5C, 0}, {0x5D, 0}, {0x5E, 0}, {0x5F, 0},
+    {0x60, 0}, {0x61, 0}, {0x62, 0}, {0x63, 0}, {0x64, 0}, {0x65, 0}, {0x66, 0}, {0x67, 0},
+    {0x68, 0}, {0x69, 0}, {0x6A, 0}, {0x6B, 0}, {0x6C, 0}, {0x6D, 0}, {0x6E, 0}, {0x6F, 0},
+    {0x70, 0}, {0x71, 0}, {0x72, 0}, {0x73, 0}, {0x74, 0}, {0x75, 0}, {0x76, 0}, {0x77, 0},
+    {0x78, 0}, {0x79, 0}, {0x7A, 0}, {0x7B, 0}, {0x7C, 0}, {0x7D, 0}, {0x7E, 0}, {0x7F, 0},
+};
+
+#if defined(CONFIG_MORSE_ALPHABET_LATIN) && !defined(CONFIG_MORSE_PROSIGNS)
+#define MORSE_TABLE_NAME "LATIN"
+static const uint8_t morse_code_glyphs[512] = {
+    [0x002] = 'E', // . E
+    [0x003] = 'T', // - T
+    [0x004] = 'I', // .. I
+    [0x005] = 'A', // .- A
+    [0x006] = 'N', // -. N
+    [0x007] = 'M', // -- M
+    [0x008] = 'S', // ... S
+    [0x009] = 'U', // ..- U
+    [0x00A] = 'R', // .-. R
+    [0x00B] = 'W', // .-- W
+    [0x00C] = 'D', // -.. D
+    [0x00D] = 'K', // -.- K
+    [0x00E] = 'G', // --. G
+    [0x00F] = 'O', // --- O
+    [0x010] = 'H', // .... H
+    [0x011] = 'V', // ...- V
+    [0x012] = 'F', // ..-. F
+    [0x014] = 'L', // .-.. L
+    [0x016] = 'P', // .--. P
+    [0x017] = 'J', // .--- J
+    [0x018] = 'B', // -... B
+    [0x019] = 'X', // -..- X
+    [0x01A] = 'C', // -.-. C
+    [0x01B] = 'Y', // -.-- Y
+    [0x01C] = 'Z', // --.. Z
+    [0x01D] = 'Q', // --.- Q
+    [0x020] = '5', // ..... 5
+    [0x021] = '4', // ....- 4
+    [0x023] = '3', // ...-- 3
+    [0x027] = '2', // ..--- 2
+    [0x028] = '&', // .-... &
+    [0x02A] = '+', // .-.-. +
+    [0x02F] = '1', // .---- 1
+    [0x030] = '6', // -.... 6
+    [0x031] = '=', // -...- =
+    [0x032] = '/', // -..-. /
+    [0x036] = '(', // -.--. (
+    [0x038] = '7', // --... 7
+    [0x03C] = '8', // ---.. 8
+    [0x03E] = '9', // ----. 9
+    [0x03F] = '0', // ----- 0
+    [0x04C] = '?', // ..--.. ?
+    [0x04D] = '_', // ..--.- _
+    [0x052] = '"', // .-..-. "
+    [0x055] = '.', // .-.-.- .
+    [0x05A] = '@', // .--.-. @
+    [0x05E] = '\'', // .----. '
+    [0x061] = '-', // -....- -
+    [0x06A] = ';', // -.-.-. ;
+    [0x06B] = '!', // -.-.-- !
+    [0x06D] = ')', // -.--.- )
+    [0x073] = ',', // --..-- ,
+    [0x078] = ':', // ---... :
+    [0x089] = '$', // ...-..- $
+};
+#elif defined(CONFIG_MORSE_ALPHABET_LATIN) && defined(CONFIG_MORSE_PROSIGNS)
+#define MORSE_TABLE_NAME "LATIN_PROSIGNS"
+static const uint8_t morse_code_glyphs[512] = {
+    [0x002] = 'E', // . E
+    [0x003] = 'T', // - T
+    [0x004] = 'I', // .. I
+    [0x005] = 'A', // .- A
+    [0x006] = 'N', // -. N
+    [0x007] = 'M', // -- M
+    [0x008] = 'S', // ... S
+    [0x009] = 'U', // ..- U
+    [0x00A] = 'R', // .-. R
+    [0x00B] = 'W', // .-- W
+    [0x00C] = 'D', // -.. D
+    [0x00D] = 'K', // -.- K
+    [0x00E] = 'G', // --. G
+    [0x00F] = 'O', // --- O
+    [0x010] = 'H', // .... H
+    [0x011] = 'V', // ...- V
+    [0x012] = 'F', // ..-. F
+    [0x014] = 'L', // .-.. L
+    [0x016] = 'P', // .--. P
+    [0x017] = 'J', // .--- J
+    [0x018] = 'B', // -... B
+    [0x019] = 'X', // -..- X
+    [0x01A] = 'C', // -.-. C
+    [0x01B] = 'Y', // -.-- Y
+    [0x01C] = 'Z', // --.. Z
+    [0x01D] = 'Q', // --.- Q
+    [0x020] = '5', // ..... 5
+    [0x021] = '4', // ....- 4
+    [0x022] = 0x86, // ...-. <VE>
+    [0x023] = '3', // ...-- 3
+    [0x027] = '2', // ..--- 2
+    [0x028] = 0x83, // .-... <AS>
+    [0x02A] = 0x82, // .-.-. <AR>
+    [0x02F] = '1', // .---- 1
+    [0x030] = '6', // -.... 6
+    [0x031] = 0x81, // -...- <BT>
+    [0x032] = '/', // -..-. /
+    [0x035] = 0x85, // -.-.- <KA>
+    [0x036] = 0x80, // -.--. <KN>
+    [0x038] = '7', // --... 7
+    [0x03C] = '8', // ---.. 8
+    [0x03E] = '9', // ----. 9
+    [0x03F] = '0', // ----- 0
+    [0x045] = 0x84, // ...-.- <SK>
+    [0x04C] = '?', // ..--.. ?
+    [0x04D] = '_', // ..--.- _
+    [0x052] = '"', // .-..-. "
+    [0x055] = '.', // .-.-.- .
+    [0x05A] = '@', // .--.-. @
+    [0x05E] = '\'', // .----. '
+    [0x061] = '-', // -....- -
+    [0x06A] = ';', // -.-.-. ;
+    [0x06B] = '!', // -.-.-- !
+    [0x06D] = ')', // -.--.- )
+    [0x073] = ',', // --..-- ,
+    [0x078] = ':', // ---... :
+    [0x089] = '$', // ...-..- $
+    [0x0C5] = 0x88, // -...-.- <BK>
+    [0x100] = 0x87, // ........ <HH>
+};
+#elif defined(CONFIG_MORSE_ALPHABET_CYRILLIC) && !defined(CONFIG_MORSE_PROSIGNS)
+#define MORSE_TABLE_NAME "CYRILLIC"
+static const uint8_t morse_code_glyphs[512] = {
+    [0x002] = 0x8E, // . Е
+    [0x003] = 0x9B, // - Т
+    [0x004] = 0x91, // .. И
+    [0x005] = 0x89, // .- А
+    [0x006] = 0x96, // -. Н
+    [0x007] = 0x95, // -- М
+    [0x008] = 0x9A, // ... С
+    [0x009] = 0x9C, // ..- У
+    [0x00A] = 0x99, // .-. Р
+    [0x00B] = 0x8B, // .-- В
+    [0x00C] = 0x8D, // -.. Д
+    [0x00D] = 0x93, // -.- К
+    [0x00E] = 0x8C, // --. Г
+    [0x00F] = 0x97, // --- О
+    [0x010] = 0x9E, // .... Х
+    [0x011] = 0x8F, // ...- Ж
+    [0x012] = 0x9D, // ..-. Ф
+    [0x013] = 0xA7, // ..-- Ю
+    [0x014] = 0x94, // .-.. Л
+    [0x015] = 0xA8, // .-.- Я
+    [0x016] = 0x98, // .--. П
+    [0x017] = 0x92, // .--- Й
+    [0x018] = 0x8A, // -... Б
+    [0x019] = 0xA5, // -..- Ь
+    [0x01A] = 0x9F, // -.-. Ц
+    [0x01B] = 0xA4, // -.-- Ы
+    [0x01C] = 0x90, // --.. З
+    [0x01D] = 0xA2, // --.- Щ
+    [0x01E] = 0xA0, // ---. Ч
+    [0x01F] = 0xA1, // ---- Ш
+    [0x020] = '5', // ..... 5
+    [0x021] = '4', // ....- 4
+    [0x023] = '3', // ...-- 3
+    [0x024] = 0xA6, // ..-.. Э
+    [0x027] = '2', // ..--- 2
+    [0x028] = '&', // .-... &
+    [0x02A] = '+', // .-.-. +
+    [0x02F] = '1', // .---- 1
+    [0x030] = '6', // -.... 6
+    [0x031] = '=', // -...- =
+    [0x032] = '/', // -..-. /
+    [0x036] = '(', // -.--. (
+    [0x038] = '7', // --... 7
+    [0x03B] = 0xA3, // --.-- Ъ
+    [0x03C] = '8', // ---.. 8
+    [0x03E] = '9', // ----. 9
+    [0x03F] = '0', // ----- 0
+    [0x04C] = '?', // ..--.. ?
+    [0x04D] = '_', // ..--.- _
+    [0x052] = '"', // .-..-. "
+    [0x055] = '.', // .-.-.- .
+    [0x05A] = '@', // .--.-. @
+    [0x05E] = '\'', // .----. '
+    [0x061] = '-', // -....- -
+    [0x06A] = ';', // -.-.-. ;
+    [0x06B] = '!', // -.-.-- !
+    [0x06D] = ')', // -.--.- )
+    [0x073] = ',', // --..-- ,
+    [0x078] = ':', // ---... :
+    [0x089] = '$', // ...-..- $
+};
+#elif defined(CONFIG_MORSE_ALPHABET_CYRILLIC) && defined(CONFIG_MORSE_PROSIGNS)
+#define MORSE_TABLE_NAME "CYRILLIC_PROSIGNS"
+static const uint8_t morse_code_glyphs[512] = {
+    [0x002] = 0x8E, // . Е
+    [0x003] = 0x9B, // - Т
+    [0x004] = 0x91, // .. И
+    [0x005] = 0x89, // .- А
+    [0x006] = 0x96, // -. Н
+    [0x007] = 0x95, // -- М
+    [0x008] = 0x9A, // ... С
+    [0x009] = 0x9C, // ..- У
+    [0x00A] = 0x99, // .-. Р
+    [0x00B] = 0x8B, // .-- В
+    [0x00C] = 0x8D, // -.. Д
+    [0x00D] = 0x93, // -.- К
+    [0x00E] = 0x8C, // --. Г
+    [0x00F] = 0x97, // --- О
+    [0x010] = 0x9E, // .... Х
+    [0x011] = 0x8F, // ...- Ж
+    [0x012] = 0x9D, // ..-. Ф
+    [0x013] = 0xA7, // ..-- Ю
+    [0x014] = 0x94, // .-.. Л
+    [0x015] = 0xA8, // .-.- Я
+    [0x016] = 0x98, // .--. П
+    [0x017] = 0x92, // .--- Й
+    [0x018] = 0x8A, // -... Б
+    [0x019] = 0xA5, // -..- Ь
+    [0x01A] = 0x9F, // -.-. Ц
+    [0x01B] = 0xA4, // -.-- Ы
+    [0x01C] = 0x90, // --.. З
+    [0x01D] = 0xA2, // --.- Щ
+    [0x01E] = 0xA0, // ---. Ч
+    [0x01F] = 0xA1, // ---- Ш
+    [0x020] = '5', // ..... 5
+    [0x021] = '4', // ....- 4
+    [0x022] = 0x86, // ...-. <VE>
+    [0x023] = '3', // ...-- 3
+    [0x024] = 0xA6, // ..-.. Э
+    [0x027] = '2', // ..--- 2
+    [0x028] = 0x83, // .-... <AS>
+    [0x02A] = 0x82, // .-.-. <AR>
+    [0x02F] = '1', // .---- 1
+    [0x030] = '6', // -.... 6
+    [0x031] = 0x81, // -...- <BT>
+    [0x032] = '/', // -..-. /
+    [0x035] = 0x85, // -.-.- <KA>
+    [0x036] = 0x80, // -.--. <KN>
+    [0x038] = '7', // --... 7
+    [0x03B] = 0xA3, // --.-- Ъ
+    [0x03C] = '8', // ---.. 8
+    [0x03E] = '9', // ----. 9
+    [0x03F] = '0', // ----- 0
+    [0x045] = 0x84, // ...-.- <SK>
+    [0x04C] = '?', // ..--.. ?
+    [0x04D] = '_', // ..--.- _
+    [0x052] = '"', // .-..-. "
+    [0x055] = '.', // .-.-.- .
+    [0x05A] = '@', // .--.-. @
+    [0x05E] = '\'', // .----. '
+    [0x061] = '-', // -....- -
+    [0x06A] = ';', // -.-.-. ;
+    [0x06B] = '!', // -.-.-- !
+    [0x06D] = ')', // -.--.- )
+    [0x073] = ',', // --..-- ,
+    [0x078] = ':', // ---... :
+    [0x089] = '$', // ...-..- $
+    [0x0C5] = 0x88, // -...-.- <BK>
+    [0x100] = 0x87, // ........ <HH>
+};
+#elif defined(CONFIG_MORSE_ALPHABET_WABUN) && !defined(CONFIG_MORSE_PROSIGNS)
+#define MORSE_TABLE_NAME "WABUN"
+static const uint8_t morse_code_glyphs[512] = {
+    [0x002] = 0xAE, // . ヘ
+    [0x003] = 0xBF, // - ム
+    [0x004] = 0xD9, // .. ゛
+    [0x005] = 0xA9, // .- イ
+    [0x006] = 0xB8, // -. タ
+    [0x007] = 0xB7, // -- ヨ
+    [0x008] = 0xBE, // ... ラ
+    [0x009] = 0xC0, // ..- ウ
+    [0x00A] = 0xBD, // .-. ナ
+    [0x00B] = 0xC5, // .-- ヤ
+    [0x00C] = 0xAD, // -.. ホ
+    [0x00D] = 0xB5, // -.- ワ
+    [0x00E] = 0xB1, // --. リ
+    [0x00F] = 0xB9, // --- レ
+    [0x010] = 0xB2, // .... ヌ
+    [0x011] = 0xC4, // ...- ク
+    [0x012] = 0xB0, // ..-. チ
+    [0x013] = 0xC2, // ..-- ノ
+    [0x014] = 0xB6, // .-.. カ
+    [0x015] = 0xAA, // .-.- ロ
+    [0x016] = 0xBB, // .--. ツ
+    [0x017] = 0xB4, // .--- ヲ
+    [0x018] = 0xAB, // -... ハ
+    [0x019] = 0xC6, // -..- マ
+    [0x01A] = 0xAC, // -.-. ニ
+    [0x01B] = 0xC7, // -.-- ケ
+    [0x01C] = 0xC8, // --.. フ
+    [0x01D] = 0xBC, // --.- ネ
+    [0x01E] = 0xBA, // ---. ソ
+    [0x01F] = 0xC9, // ---- コ
+    [0x020] = '5', // ..... 5
+    [0x021] = '4', // ....- 4
+    [0x023] = '3', // ...-- 3
+    [0x024] = 0xAF, // ..-.. ト
+    [0x025] = 0xD1, // ..-.- ミ
+    [0x026] = 0xDA, // ..--. ゜
+    [0x027] = '2', // ..--- 2
+    [0x028] = 0xC3, // .-... オ
+    [0x029] = 0xC1, // .-..- ヰ
+    [0x02A] = 0xD8, // .-.-. ン
+    [0x02B] = 0xCB, // .-.-- テ
+    [0x02C] = 0xD3, // .--.. ヱ
+    [0x02D] = 0xDB, // .--.- ー
+    [0x02E] = 0xD6, // .---. セ
+    [0x02F] = '1', // .---- 1
+    [0x030] = '6', // -.... 6
+    [0x031] = 0xD0, // -...- メ
+    [0x032] = 0xD5, // -..-. モ
+    [0x033] = 0xCF, // -..-- ユ
+    [0x034] = 0xCE, // -.-.. キ
+    [0x035] = 0xCD, // -.-.- サ
+    [0x036] = 0xB3, // -.--. ル
+    [0x037] = 0xCA, // -.--- エ
+    [0x038] = '7', // --... 7
+    [0x039] = 0xD4, // --..- ヒ
+    [0x03A] = 0xD2, // --.-. シ
+    [0x03B] = 0xCC, // --.-- ア
+    [0x03C] = '8', // ---.. 8
+    [0x03D] = 0xD7, // ---.- ス
+    [0x03E] = '9', // ----. 9
+    [0x03F] = '0', // ----- 0
+    [0x052] = 0xDF, // .-..-. ）
+    [0x054] = 0xDD, // .-.-.. 。
+    [0x055] = 0xDC, // .-.-.- 、
+    [0x06D] = 0xDE, // -.--.- （
+};
+#elif defined(CONFIG_MORSE_ALPHABET_WABUN) && defined(CONFIG_MORSE_PROSIGNS)
+// prosign codes decoded as letters: <AR> ン, <BT> メ, <KN> ル, <AS> オ, <KA> サ
+#define MORSE_TABLE_NAME "WABUN_PROSIGNS"
+static const uint8_t morse_code_glyphs[512] = {
+    [0x002] = 0xAE, // . ヘ
+    [0x003] = 0xBF, // - ム
+    [0x004] = 0xD9, // .. ゛
+    [0x005] = 0xA9, // .- イ
+    [0x006] = 0xB8, // -. タ
+    [0x007] = 0xB7, // -- ヨ
+    [0x008] = 0xBE, // ... ラ
+    [0x009] = 0xC0, // ..- ウ
+    [0x00A] = 0xBD, // .-. ナ
+    [0x00B] = 0xC5, // .-- ヤ
+    [0x00C] = 0xAD, // -.. ホ
+    [0x00D] = 0xB5, // -.- ワ
+    [0x00E] = 0xB1, // --. リ
+    [0x00F] = 0xB9, // --- レ
+    [0x010] = 0xB2, // .... ヌ
+    [0x011] = 0xC4, // ...- ク
+    [0x012] = 0xB0, // ..-. チ
+    [0x013] = 0xC2, // ..-- ノ
+    [0x014] = 0xB6, // .-.. カ
+    [0x015] = 0xAA, // .-.- ロ
+    [0x016] = 0xBB, // .--. ツ
+    [0x017] = 0xB4, // .--- ヲ
+    [0x018] = 0xAB, // -... ハ
+    [0x019] = 0xC6, // -..- マ
+    [0x01A] = 0xAC, // -.-. ニ
+    [0x01B] = 0xC7, // -.-- ケ
+    [0x01C] = 0xC8, // --.. フ
+    [0x01D] = 0xBC, // --.- ネ
+    [0x01E] = 0xBA, // ---. ソ
+    [0x01F] = 0xC9, // ---- コ
+    [0x020] = '5', // ..... 5
+    [0x021] = '4', // ....- 4
+    [0x022] = 0x86, // ...-. <VE>
+    [0x023] = '3', // ...-- 3
+    [0x024] = 0xAF, // ..-.. ト
+    [0x025] = 0xD1, // ..-.- ミ
+    [0x026] = 0xDA, // ..--. ゜
+    [0x027] = '2', // ..--- 2
+    [0x028] = 0xC3, // .-... オ
+    [0x029] = 0xC1, // .-..- ヰ
+    [0x02A] = 0xD8, // .-.-. ン
+    [0x02B] = 0xCB, // .-.-- テ
+    [0x02C] = 0xD3, // .--.. ヱ
+    [0x02D] = 0xDB, // .--.- ー
+    [0x02E] = 0xD6, // .---. セ
+    [0x02F] = '1', // .---- 1
+    [0x030] = '6', // -.... 6
+    [0x031] = 0xD0, // -...- メ
+    [0x032] = 0xD5, // -..-. モ
+    [0x033] = 0xCF, // -..-- ユ
+    [0x034] = 0xCE, // -.-.. キ
+    [0x035] = 0xCD, // -.-.- サ
+    [0x036] = 0xB3, // -.--. ル
+    [0x037] = 0xCA, // -.--- エ
+    [0x038] = '7', // --... 7
+    [0x039] = 0xD4, // --..- ヒ
+    [0x03A] = 0xD2, // --.-. シ
+    [0x03B] = 0xCC, // --.-- ア
+    [0x03C] = '8', // ---.. 8
+    [0x03D] = 0xD7, // ---.- ス
+    [0x03E] = '9', // ----. 9
+    [0x03F] = '0', // ----- 0
+    [0x045] = 0x84, // ...-.- <SK>
+    [0x052] = 0xDF, // .-..-. ）
+    [0x054] = 0xDD, // .-.-.. 。
+    [0x055] = 0xDC, // .-.-.- 、
+    [0x06D] = 0xDE, // -.--.- （
+    [0x0C5] = 0x88, // -...-.- <BK>
+    [0x100] = 0x87, // ........ <HH>
+};
+#else
+#error "Unknown Morse alphabet"
+#endif
+
+#endif // MORSE_TABLES_H_
@@ -0,0 +1,119 @@
+#include "noise_blanker.h"
+
+#include <esp_log.h>
+#include <math.h>
+
+#include "trace.h"
+
+static const char *TAG = "NB";
+
+// Average magnitude follows each sub-block with this weight, ~25ms time constant
+static const float AVG_ALPHA = 0.06f;
+
+void noise_blanker_init(noise_blanker_t *nb, float threshold_mult) {
+  nb->enabled = true;
+  nb->threshold_mult = threshold_mult;
+  nb->avg = 0.0f;
+  nb->hold = false;
+  nb->blanked = 0;
+  nb->passed = 0;
+  ESP_LOGD(TAG, "Initialized, threshold x%.1f", threshold_mult);
+}
+
+void noise_blanker_set_enabled(noise_blanker_t *nb, bool enabled) {
+  if (nb->enabled != enabled) {
+    TRACE(TLM, TRACE_NB, enabled, 0, 0);
+  }
+  nb->enabled = enabled;
+}
+
+typedef struct {
+  int over;  // samples over the limit
+  int first; // index of the first one, len if none
+  int last;  // index of the last one, -1 if none
+} burst_t;
+
+// @return sum of the magnitudes
+static float find_burst(const float *buf, int len, float limit, burst_t *b) {
+  float sum = 0.0f;
+  b->over = 0;
+  b->first = len;
+  b->last = -1;
+  for (int i = 0; i < len; i++) {
+    float m = fabsf(buf[i]);
+    int o = m > limit;
+    b->over += o;
+    b->first = (o && i < b->first) ? i : b->first;
+    b->last = o ? i : b->last;
+    sum += m;
+  }
+  return sum;
+}
+
+// most of the sub-block over the limit (a level step) or over-limit samples too far apart for an impulse
+static bool looks_like_signal(const burst_t *b, int len) {
+  return b->over > len / 2 || b->last - b->first >= NOISE_BLANKER_MAX_BURST;
+}
+
+// next - the following sub-block of the same input block, NULL for the last one
+static int process_subblock(noise_blanker_t *nb, float *buf, int len, const float *next, int next_len) {
+  float limit = nb->threshold_mult * nb->avg;
+
+  burst_t b;
+  float sum = find_burst(buf, len, limit, &b);
+
+  if (nb->avg <= 0.0f || b.over > len / 2) {
+    // first sub-block or a sustained level change (a signal rather than an impulse), let it through and re-learn
+    nb->passed += (b.over > 0);
+    nb->hold = b.over > 0;
+    nb->avg = sum / (float)len;
+    return 0;
+  }
+
+  if (b.over > 0) {
+    // a key down edge late in the sub-block only shows as a signal in the next one, at the end of the input
+    // block a burst running into its last samples is given the benefit of the doubt
+    burst_t ahead = {0, 0, -1};
+    if (next != NULL) {
+      find_burst(next, next_len, limit, &ahead);
+    }
+    bool onset = next != NULL ? looks_like_signal(&ahead, next_len) : b.last >= len - NOISE_BLANKER_MAX_BURST;
+    bool signal = nb->hold || onset || looks_like_signal(&b, len);
+    nb->hold = signal;
+    if (signal) {
+      nb->passed++;
+      nb->avg += AVG_ALPHA * (sum / (float)len - nb->avg);
+      return 0;
+    }
+
+    sum = 0.0f;
+    for (int i = 0; i < len; i++) {
+      float m = fabsf(buf[i]);
+      float keep = (m > limit) ? 0.0f : 1.0f;
+      buf[i] *= keep;
+      sum += m * keep;
+    }
+    len -= b.over;
+  } else {
+    nb->hold = false;
+  }
+
+  nb->avg += AVG_ALPHA * (sum / (float)len - nb->avg);
+  return b.over;
+}
+
+int noise_blanker_process(noise_blanker_t *nb, float *buf, int len) {
+  if (!nb->enabled) {
+    return 0;
+  }
+
+  int blanked = 0;
+  for (int i = 0; i < len; i += NOISE_BLANKER_SUBBLOCK) {
+    int n = (len - i) < NOISE_BLANKER_SUBBLOCK ? (len - i) : NOISE_BLANKER_SUBBLOCK;
+    int next = i + n < len ? ((len - i - n) < NOISE_BLANKER_SUBBLOCK ? (len - i - n) : NOISE_BLANKER_SUBBLOCK) : 0;
+    blanked += process_subblock(nb, buf + i, n, next > 0 ? buf + i + n : NULL, next);
+  }
+
+  nb->blanked += blanked;
+  return blanked;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file noise_blanker.h
+ * @brief Impulse noise blanker, runs on the raw input block ahead of the band-pass filter.
+ *
+ * The block is processed in short sub-blocks. Samples whose magnitude exceeds a multiple of the
+ * running average magnitude are zeroed only if they form a short burst with no signal around it: a
+ * sub-block where most samples exceed the limit is a level step (e.g. key down) and re-learns the
+ * average, one whose samples over the limit spread wider than NOISE_BLANKER_MAX_BURST is a tone
+ * near the limit, and the sub-blocks before and after a signal are left alone so its key down edge
+ * is not trimmed. Loops are branch free so the compiler can vectorize/pipeline them.
+ */
+#ifndef NOISE_BLANKER_H_
+#define NOISE_BLANKER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sub-block length, ~1.5ms at 44.1kHz
+#define NOISE_BLANKER_SUBBLOCK (64)
+// Longest burst taken for an impulse, ~0.4ms at 44.1kHz. Any CW tone above 500Hz has two crests this far apart
+// in every sub-block, so a tone over the limit never fits.
+#define NOISE_BLANKER_MAX_BURST (16)
+// Default gating threshold, multiple of the average magnitude
+#define NOISE_BLANKER_DEFAULT_MULT (8.0f)
+
+typedef struct {
+  volatile bool enabled; // "nb" parameter, load shedding may turn it off, takes effect on the next block
+  float threshold_mult;  // samples above threshold_mult * avg are blanked
+  float avg;             // running average magnitude
+  bool hold;             // the last sub-block looked like a signal, the next one is not blanked
+  uint32_t blanked;      // total number of blanked samples
+  uint32_t passed;       // total number of sub-blocks that were over the threshold but looked like a signal
+} noise_blanker_t;
+
+void noise_blanker_init(noise_blanker_t *nb, float threshold_mult);
+
+void noise_blanker_set_enabled(noise_blanker_t *nb, bool enabled);
+
+/**
+ * @brief Blanks impulses in place.
+ *
+ * @param[in,out] buf samples
+ * @param len number of samples
+ * @return number of samples blanked in this block
+ */
+int noise_blanker_process(noise_blanker_t *nb, float *buf, int len);
+
+#endif // NOISE_BLANKER_H_
@@ -7,12 +7,11 @@
 #include <esp_check.h>
 #include <esp_log.h>
 #include <limits.h>
+#include <math.h>
 
-static const char *TAG = "OOKE";
+#include "trace.h"
 
-// Thresholds with some histeresis
-static const uint32_t LOW_TO_HIGH_THRESHOLD = UINT32_MAX / 2;
-static const uint32_t HIGH_TO_LOW_THRESHOLD = UINT32_MAX / 4;
+static const char *TAG = "OOKE";
 
 // --- Function Implementations ---
 
@@ -20,16 +19,23 @@ esp_err_t ook_edge_detector_init(ook_edge_detector_t *edge_state) {
 
   edge_state->samples_in_state = 0;
   edge_state->below_threshold = true;
+  edge_state->level[0] = 0.0f;
+  edge_state->level[1] = 1.0f;
+  edge_state->spread[0] = edge_state->spread[1] = 0.0f;
+  edge_state->prev = 0;
+  edge_state->offset = 0.0f;
+  edge_state->duration = 0.0f;
 
   ESP_LOGD(TAG, "Initialized");
   return ESP_OK;
 }
 
-int32_t ook_edge_detector_update(ook_edge_detector_t *edge_state, uint32_t sample) {
+int32_t ook_edge_detector_update(ook_edge_detector_t *edge_state, uint32_t sample, uint32_t low_to_high,
+                                 uint32_t high_to_low) {
 
   // 3. Determine the new state based on the current sample
-  bool new_sample_is_high = (sample >= LOW_TO_HIGH_THRESHOLD);
-  bool new_sample_is_low = (sample <= HIGH_TO_LOW_THRESHOLD);
+  bool new_sample_is_high = (sample >= low_to_high);
+  bool new_sample_is_low = (sample <= high_to_low);
 
   bool is_rising_edge = new_sample_is_high && edge_state->below_threshold;
   bool is_falling_edge = new_sample_is_low && (!edge_state->below_threshold);
@@ -44,7 +50,7 @@ int32_t ook_edge_detector_update(ook_edge_detector_t *edge_state, uint32_t sampl
     int32_t clamped_count;                       // Changed to int32_t
     if (samples_in_previous_state > INT32_MAX) { // Check against INT32_MAX
       clamped_count = INT32_MAX;                 // Clamp to INT32_MAX
-      ESP_LOGW(TAG, "Sample count (%lu) exceeded INT32_MAX, clamping.", (unsigned long)samples_in_previous_state);
+      TRACE(DSP, TRACE_CLAMP, INT32_MAX, 0, 0);
     } else {
       clamped_count = (int32_t)samples_in_previous_state; // Cast to int32_t
     }
@@ -54,34 +60,91 @@ int32_t ook_edge_detector_update(ook_edge_detector_t *edge_state, uint32_t sampl
       // Check if clamped_count is INT32_MAX to avoid overflow when negating
       if (clamped_count == INT32_MAX) {
         return_value = INT32_MIN; // Assign INT32_MIN directly if count was maxed out
-        ESP_LOGW(TAG, "Falling edge duration clamped to INT32_MIN");
       } else {
         return_value = -clamped_count; // Negative value indicates falling edge
       }
-      ESP_LOGV(TAG, "Falling edge detected after %ld samples above.", (long)clamped_count); // Use %ld for int32_t
 
       edge_state->below_threshold = true;
     } else if (is_rising_edge) {
       // Rising edge (was below, now above)
       return_value = clamped_count; // Positive value indicates rising edge
-      ESP_LOGV(TAG, "Rising edge detected after %ld samples below.", (long)clamped_count); // Use %ld for int32_t
 
       edge_state->below_threshold = false;
     }
 
+    // where between the previous sample and this one the envelope crossed the threshold
+    float threshold = is_rising_edge ? (float)low_to_high : (float)high_to_low;
+    float offset = sample != edge_state->prev ? ((float)sample - threshold) / ((float)sample - (float)edge_state->prev)
+                                              : 0.0f;
+    offset = fminf(fmaxf(offset, 0.0f), 1.0f);
+    edge_state->duration = (float)samples_in_previous_state - offset + edge_state->offset;
+    edge_state->offset = offset;
+    edge_state->prev = sample;
+
+    TRACE(DSP, TRACE_EDGE, return_value, 0, 0);
     edge_state->samples_in_state = 1; // Start count for the new state
     return return_value;
   } else {
     // --- No Edge Detected ---
+    edge_state->prev = sample;
     // Increment sample counter for the current state
     // Check for potential overflow of the uint32_t counter
     if (edge_state->samples_in_state < UINT32_MAX) {
       edge_state->samples_in_state++;
     } else {
       // Handle extremely rare overflow case (e.g., reset or log)
-      ESP_LOGW(TAG, "Sample counter overflowed (UINT32_MAX reached)!");
+      TRACE(DSP, TRACE_CLAMP, INT32_MAX, 0, 0);
       // Optionally reset or saturate: edge_state->samples_in_state = 1;
     }
     return 0; // No edge
   }
 }
+
+// fraction of the range to a threshold on the rescaled envelope
+static uint32_t from_fraction(float f) { return f >= 1.0f ? UINT32_MAX : (uint32_t)(f * 4294967296.0f); }
+
+int32_t ook_edge_detector_update_adaptive(ook_edge_detector_t *edge_state, uint32_t sample, uint32_t low_to_high,
+                                          uint32_t high_to_low, float spread_mult) {
+  const float to_fraction = 1.0f / 4294967296.0f;
+  int state = edge_state->below_threshold ? 0 : 1;
+  float center = ((float)low_to_high + (float)high_to_low) / 2 * to_fraction;
+  float x = sample * to_fraction;
+
+  // The envelope is still settling right after an edge, and the next edge starts to move it before the
+  // threshold is crossed. Deviations are clipped to twice the spread so those tails can't widen the band much,
+  // samples on the other side of the center are left out.
+  if (edge_state->samples_in_state >= OOK_ADAPT_SETTLE && (x >= center) == (state == 1)) {
+    float clip = fmaxf(2 * edge_state->spread[state], OOK_ADAPT_MIN_HALF);
+    float d = fminf(fmaxf(x - edge_state->level[state], -clip), clip);
+    edge_state->level[state] += OOK_ADAPT_WEIGHT * d;
+    edge_state->spread[state] += OOK_ADAPT_WEIGHT * (fabsf(d) - edge_state->spread[state]);
+  }
+
+  // same place between the measured levels as the center of the given thresholds is in the range
+  float mid = edge_state->level[0] + center * (edge_state->level[1] - edge_state->level[0]);
+  mid = fminf(fmaxf(mid, 2 * OOK_ADAPT_MIN_HALF), 1.0f - 2 * OOK_ADAPT_MIN_HALF);
+  // the key-up spread is the noise, key-down also moves with the decaying min/max of the rescaling
+  float half = fmaxf(spread_mult * edge_state->spread[0], OOK_ADAPT_MIN_HALF);
+  half = fminf(half, fminf(mid, 1.0f - mid) - OOK_ADAPT_MIN_HALF);
+  return ook_edge_detector_update(edge_state, sample, from_fraction(mid + half), from_fraction(mid - half));
+}
+
+float ook_edge_detector_duration(const ook_edge_detector_t *edge_state) { return edge_state->duration; }
+
+int32_t ook_edge_detector_hold_low(ook_edge_detector_t *edge_state, uint32_t n) {
+  int32_t e = 0;
+  if (!edge_state->below_threshold) {
+    // the pulse in progress ends with the first of the n samples
+    e = edge_state->samples_in_state > INT32_MAX ? INT32_MIN : -(int32_t)edge_state->samples_in_state;
+    TRACE(DSP, TRACE_EDGE, e, 0, 0);
+    edge_state->duration = (float)edge_state->samples_in_state + edge_state->offset;
+    edge_state->offset = 0.0f;
+    edge_state->below_threshold = true;
+    edge_state->samples_in_state = 0;
+  }
+
+  edge_state->prev = 0;
+  edge_state->samples_in_state =
+      edge_state->samples_in_state <= UINT32_MAX - n ? edge_state->samples_in_state + n : UINT32_MAX;
+  return e;
+}
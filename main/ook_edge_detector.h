@@ -9,10 +9,28 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+// Default thresholds with some hysteresis, on the rescaled envelope
+#define OOK_LOW_TO_HIGH_THRESHOLD (UINT32_MAX / 2)
+#define OOK_HIGH_TO_LOW_THRESHOLD (UINT32_MAX / 4)
+
+// Adaptive hysteresis: envelope statistics are taken once a state is this old, samples (~46ms at 44.1kHz)...
+#define OOK_ADAPT_SETTLE (2048)
+// ...with this weight per sample
+#define OOK_ADAPT_WEIGHT (1.0f / 2048)
+// Narrowest half band, fraction of the range
+#define OOK_ADAPT_MIN_HALF (1.0f / 64)
+
 // Structure to hold the state of the edge detector
 typedef struct {
   bool below_threshold;      // Current state: true if last sample was below threshold
   uint32_t samples_in_state; // Counter for consecutive samples in the current state
+  // envelope in the low [0] and high [1] state, fractions of the range, ook_edge_detector_update_adaptive only
+  float level[2];  // average
+  float spread[2]; // mean absolute deviation from the average
+  // sub-sample timing of the last edge
+  uint32_t prev;  // previous sample
+  float offset;   // threshold crossing before the sample the edge was detected at, 0..1 sample
+  float duration; // previous state, samples, between the interpolated crossings
 } ook_edge_detector_t;
 
 /**
@@ -31,6 +49,8 @@ esp_err_t ook_edge_detector_init(ook_edge_detector_t *edge_state);
  *
  * @param[in,out] edge_state Pointer to the initialized ook_edge_detector_t struct. Must not be NULL.
  * @param[in] sample The new input sample, normalized to fill full uint32_t range
+ * @param[in] low_to_high A sample at or above this is high, e.g. OOK_LOW_TO_HIGH_THRESHOLD
+ * @param[in] high_to_low A sample at or below this is low, e.g. OOK_HIGH_TO_LOW_THRESHOLD
  *
  * @return int32_t
  * - Positive value: Rising edge detected. Value is the count of samples previously below threshold (clamped to
@@ -39,6 +59,31 @@ esp_err_t ook_edge_detector_init(ook_edge_detector_t *edge_state);
  * to INT32_MIN).
  * - 0: No edge detected in this sample.
  */
-int32_t ook_edge_detector_update(ook_edge_detector_t *edge_state, uint32_t sample);
+int32_t ook_edge_detector_update(ook_edge_detector_t *edge_state, uint32_t sample, uint32_t low_to_high,
+                                 uint32_t high_to_low);
+
+/**
+ * @brief Same as ook_edge_detector_update with the hysteresis band taken from the envelope noise.
+ *
+ * The band sits between the measured key-up and key-down levels where the center of the given thresholds is
+ * in the range, on each side spread_mult times the mean absolute deviation of the key-up envelope: wider in
+ * noise, tighter on a clean signal. It is at least OOK_ADAPT_MIN_HALF wide on each side and keeps that far
+ * from the ends of the range. tools/ook_bench measures the timing error against SNR.
+ */
+int32_t ook_edge_detector_update_adaptive(ook_edge_detector_t *edge_state, uint32_t sample, uint32_t low_to_high,
+                                          uint32_t high_to_low, float spread_mult);
+
+/**
+ * @brief Duration of the state that ended with the last edge, with its ends interpolated between samples where
+ * the envelope crossed the threshold. Edges count whole samples, this is for finer timing at low sample rates.
+ */
+float ook_edge_detector_duration(const ook_edge_detector_t *edge_state);
+
+/**
+ * @brief Counts n samples as low without looking at them, e.g. while the squelch is closed.
+ *
+ * @return falling edge of a pulse in progress, which ends at the first of the samples, 0 otherwise
+ */
+int32_t ook_edge_detector_hold_low(ook_edge_detector_t *edge_state, uint32_t n);
 
 #endif // OOK_EDGE_DETECTOR_H
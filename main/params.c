@@ -0,0 +1,118 @@
+#include "params.h"
+
+#include <string.h>
+
+// Defaults are the values the DSP and the decoder were tuned with
+static const param_desc_t descs[PARAM_COUNT] = {
+    [PARAM_BPF_HZ] = {"bpf_hz", "band-pass center, Hz", 749.7f, 200.0f, 3000.0f},
+    [PARAM_BPF_Q] = {"bpf_q", "band-pass Q", 20.0f, 0.5f, 100.0f},
+    [PARAM_LPF_HZ] = {"lpf_hz", "envelope low-pass cutoff, Hz", 22.05f, 2.0f, 200.0f},
+    [PARAM_ENV_DECAY] = {"env_decay", "envelope min/max shrink per block", 0.010f, 0.0f, 0.5f},
+    [PARAM_OOK_HIGH] = {"ook_high", "OOK low to high threshold, fraction of range", 0.5f, 0.0f, 1.0f},
+    [PARAM_OOK_LOW] = {"ook_low", "OOK high to low threshold, fraction of range", 0.25f, 0.0f, 1.0f},
+    [PARAM_PULSE_MIN] = {"pulse_min", "shortest pulse in dit/dah statistics, samples", 1000.0f, 100.0f, 20000.0f},
+    [PARAM_PULSE_MAX] = {"pulse_max", "longest pulse in dit/dah statistics, samples", 12000.0f, 1000.0f, 100000.0f},
+    [PARAM_HIST_BINS] = {"hist_bins", "dit/dah histogram bins", 256.0f, 16.0f, 1024.0f},
+    [PARAM_HIST_DECAY] = {"hist_decay", "dit/dah histogram decay per idle second", 0.8f, 0.01f, 0.99f},
+    [PARAM_SQUELCH] = {"squelch", "squelch open margin over the noise, dB, 0 off", 10.0f, 0.0f, 40.0f},
+    [PARAM_SQUELCH_HANG] = {"squelch_hang", "squelch hang time, ms", 2000.0f, 0.0f, 10000.0f},
+    [PARAM_OOK_ADAPT] = {"ook_adapt", "OOK hysteresis, multiple of the noise spread, 0 fixed", 0.0f, 0.0f, 10.0f},
+    [PARAM_NB] = {"nb", "impulse noise blanker, 1 on, 0 off", 1.0f, 0.0f, 1.0f},
+    [PARAM_NB_MULT] = {"nb_mult", "noise blanker threshold, multiple of average magnitude", 8.0f, 2.0f, 50.0f},
+    [PARAM_LOOKAHEAD] = {"lookahead", "word re-decoding, 0 off, 1 correct shown, 2 show words", 1.0f, 0.0f, 2.0f},
+};
+
+// a torn copy is retried this many times before the reader gives up until its next poll
+#define SNAPSHOT_TRIES (4)
+
+static float values[PARAM_COUNT];
+// odd while a write is in progress, generation is seq / 2
+static uint32_t seq = 0;
+static bool initialized = false;
+
+static void init_values(void) {
+  for (int i = 0; i < PARAM_COUNT; i++) {
+    values[i] = descs[i].def;
+  }
+  initialized = true;
+}
+
+const param_desc_t *params_desc(param_id_t id) { return id < PARAM_COUNT ? &descs[id] : NULL; }
+
+int params_find(const char *name) {
+  for (int i = 0; i < PARAM_COUNT; i++) {
+    if (strcmp(descs[i].name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+float params_get(param_id_t id) {
+  float v[PARAM_COUNT];
+  uint32_t generation;
+  while (!params_snapshot(v, &generation)) {
+  }
+  return v[id];
+}
+
+// a value that does not fit the ones it pairs with
+static bool inconsistent(param_id_t id, float value) {
+  switch (id) {
+  case PARAM_OOK_HIGH:
+    return value <= values[PARAM_OOK_LOW];
+  case PARAM_OOK_LOW:
+    return value >= values[PARAM_OOK_HIGH];
+  case PARAM_PULSE_MIN:
+    return value >= values[PARAM_PULSE_MAX];
+  case PARAM_PULSE_MAX:
+    return value <= values[PARAM_PULSE_MIN];
+  default:
+    return false;
+  }
+}
+
+esp_err_t params_set(param_id_t id, float value) {
+  if (id >= PARAM_COUNT || !(value >= descs[id].min && value <= descs[id].max)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!initialized) {
+    init_values();
+  }
+  if (inconsistent(id, value)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  __atomic_store_n(&seq, seq + 1, __ATOMIC_RELEASE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  values[id] = value;
+  __atomic_store_n(&seq, seq + 1, __ATOMIC_RELEASE);
+  return ESP_OK;
+}
+
+uint32_t params_generation(void) { return __atomic_load_n(&seq, __ATOMIC_ACQUIRE) / 2; }
+
+bool params_snapshot(float *out, uint32_t *generation) {
+  for (int i = 0; i < SNAPSHOT_TRIES; i++) {
+    uint32_t before = __atomic_load_n(&seq, __ATOMIC_ACQUIRE);
+    if (before & 1) {
+      continue;
+    }
+    float copy[PARAM_COUNT];
+    if (before == 0) {
+      // never written, the defaults
+      for (int j = 0; j < PARAM_COUNT; j++) {
+        copy[j] = descs[j].def;
+      }
+    } else {
+      memcpy(copy, values, sizeof(copy));
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&seq, __ATOMIC_ACQUIRE) == before) {
+      memcpy(out, copy, sizeof(copy));
+      *generation = before / 2;
+      return true;
+    }
+  }
+  return false;
+}
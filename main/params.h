@@ -0,0 +1,73 @@
+/**
+ * @file params.h
+ * @brief Registry of the DSP and decoder tuning parameters, changed live from the "param" console command.
+ *
+ * Values are floats with a default and a range. A setter (the console task, the only writer) bumps a sequence
+ * number around each write. Consumers poll params_generation() at their own safe points, the DSP element between
+ * blocks and the decoder task between edges, and take a consistent copy with params_snapshot(). Readers never
+ * lock or wait: a copy torn by a concurrent write is retried a few times and otherwise left for the next poll.
+ * Values are not persisted, a reboot starts from the defaults.
+ */
+#ifndef PARAMS_H_
+#define PARAMS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum {
+  PARAM_BPF_HZ,       // band-pass center, Hz
+  PARAM_BPF_Q,        // band-pass Q
+  PARAM_LPF_HZ,       // envelope low-pass cutoff, Hz
+  PARAM_ENV_DECAY,    // envelope min/max shrink per block
+  PARAM_OOK_HIGH,     // OOK low to high threshold, fraction of the envelope range
+  PARAM_OOK_LOW,      // OOK high to low threshold, fraction of the envelope range
+  PARAM_PULSE_MIN,    // shortest pulse counted for dit/dah statistics, samples
+  PARAM_PULSE_MAX,    // longest pulse counted, samples
+  PARAM_HIST_BINS,    // dit/dah histogram bins
+  PARAM_HIST_DECAY,   // dit/dah histogram decay per idle second
+  PARAM_SQUELCH,      // squelch open margin over the noise, dB, 0 off
+  PARAM_SQUELCH_HANG, // squelch hang time, ms
+  PARAM_OOK_ADAPT,    // OOK hysteresis band, multiple of the envelope noise spread, 0 fixed thresholds
+  PARAM_NB,           // impulse noise blanker, 1 on, 0 off
+  PARAM_NB_MULT,      // noise blanker threshold, multiple of the average magnitude
+  PARAM_LOOKAHEAD,    // word re-decoding, morse_lookahead_mode_t: 0 off, 1 correct, 2 defer
+  PARAM_COUNT,
+} param_id_t;
+
+typedef struct {
+  const char *name;
+  const char *help;
+  float def;
+  float min;
+  float max;
+} param_desc_t;
+
+const param_desc_t *params_desc(param_id_t id);
+
+/** @return id of the parameter called name, -1 if there is none */
+int params_find(const char *name);
+
+float params_get(param_id_t id);
+
+/**
+ * @brief Sets a value, consumers pick it up at their next poll. Single writer.
+ *
+ * @return ESP_ERR_INVALID_ARG when out of range or inconsistent with another value (e.g. OOK low above high)
+ */
+esp_err_t params_set(param_id_t id, float value);
+
+/** Changes with every params_set(). */
+uint32_t params_generation(void);
+
+/**
+ * @brief Consistent copy of all values.
+ *
+ * @param[out] values PARAM_COUNT values, unchanged on failure
+ * @param[out] generation generation of the copy
+ * @return false if writes kept tearing the copy, try again later
+ */
+bool params_snapshot(float *values, uint32_t *generation);
+
+#endif // PARAMS_H_
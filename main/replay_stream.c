@@ -0,0 +1,205 @@
+#include "replay_stream.h"
+
+#include "audio_element.h"
+#include "audio_error.h"
+#include "audio_mem.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include <esp_partition.h>
+#include <esp_timer.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "static_alloc.h"
+
+static const char *TAG = "REPLAY";
+
+#define REPLAY_SAMPLE_RATE (44100)
+
+typedef struct replay_stream {
+  const char *partition;
+  int loops;
+
+  esp_partition_mmap_handle_t mmap;
+  const int16_t *samples; // interleaved, channels per frame
+  uint32_t frames;
+  int channels;
+
+  int loop;
+  uint32_t pos; // frame
+  replay_stream_stats_t stats;
+  int64_t start_us;
+} replay_stream_t;
+
+static uint32_t le32(const uint8_t *p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+
+static uint16_t le16(const uint8_t *p) { return p[0] | p[1] << 8; }
+
+// finds the PCM data of a 16 bit WAV file
+static esp_err_t parse_wav(replay_stream_t *mod, const uint8_t *wav, size_t size) {
+  if (size < 12 || memcmp(wav, "RIFF", 4) != 0 || memcmp(wav + 8, "WAVE", 4) != 0) {
+    ESP_LOGE(TAG, "No WAV file in partition %s", mod->partition);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  mod->channels = 0;
+  for (size_t pos = 12; pos + 8 <= size;) {
+    uint32_t len = le32(wav + pos + 4);
+    const uint8_t *chunk = wav + pos + 8;
+
+    if (memcmp(wav + pos, "fmt ", 4) == 0 && len >= 16) {
+      int format = le16(chunk);
+      mod->channels = le16(chunk + 2);
+      uint32_t rate = le32(chunk + 4);
+      int bits = le16(chunk + 14);
+      if (format != 1 || bits != 16 || rate != REPLAY_SAMPLE_RATE || mod->channels < 1 || mod->channels > 2) {
+        ESP_LOGE(TAG, "Need 16 bit %d Hz mono/stereo PCM, got format %d, %d bits, %lu Hz, %d channels",
+                 REPLAY_SAMPLE_RATE, format, bits, (unsigned long)rate, mod->channels);
+        return ESP_ERR_NOT_SUPPORTED;
+      }
+    } else if (memcmp(wav + pos, "data", 4) == 0 && mod->channels > 0) {
+      if (len > size - pos - 8) {
+        len = size - pos - 8; // recording longer than the partition, play what is there
+      }
+      mod->samples = (const int16_t *)chunk;
+      mod->frames = len / (sizeof(int16_t) * mod->channels);
+      return ESP_OK;
+    }
+    pos += 8 + len + (len & 1);
+  }
+
+  ESP_LOGE(TAG, "No PCM data in partition %s", mod->partition);
+  return ESP_ERR_NOT_FOUND;
+}
+
+static esp_err_t _replay_open(audio_element_handle_t self) {
+  replay_stream_t *mod = (replay_stream_t *)audio_element_getdata(self);
+
+  const esp_partition_t *part =
+      esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, mod->partition);
+  if (part == NULL) {
+    ESP_LOGE(TAG, "No %s partition", mod->partition);
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  const void *data;
+  esp_err_t err = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &data, &mod->mmap);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "mmap failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  err = parse_wav(mod, (const uint8_t *)data, part->size);
+  if (err != ESP_OK) {
+    esp_partition_munmap(mod->mmap);
+    return err;
+  }
+
+  mod->loop = 0;
+  mod->pos = 0;
+  memset(&mod->stats, 0, sizeof(mod->stats));
+  ESP_LOGI(TAG, "Playing %.1f s of %s %d times", (float)mod->frames / REPLAY_SAMPLE_RATE,
+           mod->channels == 1 ? "mono" : "stereo", mod->loops);
+  return ESP_OK;
+}
+
+static int _replay_process(audio_element_handle_t self, char *in_buffer, int in_len) {
+  replay_stream_t *mod = (replay_stream_t *)audio_element_getdata(self);
+
+  if (mod->stats.samples == 0) {
+    mod->start_us = esp_timer_get_time();
+  }
+
+  if (mod->pos == mod->frames) {
+    mod->pos = 0;
+    mod->loop++;
+  }
+  if (mod->loop >= mod->loops || mod->frames == 0) {
+    mod->stats.elapsed_us = esp_timer_get_time() - mod->start_us;
+    mod->stats.done = true;
+    return AEL_IO_DONE;
+  }
+
+  // interleaved stereo out, mono recordings go to both channels
+  int16_t *out = (int16_t *)in_buffer;
+  uint32_t n = in_len / (2 * sizeof(int16_t));
+  if (n > mod->frames - mod->pos) {
+    n = mod->frames - mod->pos;
+  }
+
+  const int16_t *in = mod->samples + mod->pos * mod->channels;
+  if (mod->channels == 2) {
+    memcpy(out, in, n * 2 * sizeof(int16_t));
+  } else {
+    for (uint32_t i = 0; i < n; i++) {
+      out[2 * i] = out[2 * i + 1] = in[i];
+    }
+  }
+  mod->pos += n;
+  mod->stats.samples += n;
+  mod->stats.elapsed_us = esp_timer_get_time() - mod->start_us;
+
+  int w_size = audio_element_output(self, in_buffer, n * 2 * sizeof(int16_t));
+  if (w_size < 0 && w_size != AEL_IO_TIMEOUT) {
+    ESP_LOGE(TAG, "Error writing to output ringbuffer: %d", w_size);
+    audio_element_report_status(self, AEL_STATUS_ERROR_OUTPUT);
+    return ESP_FAIL;
+  }
+  return w_size;
+}
+
+static esp_err_t _replay_close(audio_element_handle_t self) {
+  replay_stream_t *mod = (replay_stream_t *)audio_element_getdata(self);
+  if (mod->samples) {
+    esp_partition_munmap(mod->mmap);
+    mod->samples = NULL;
+  }
+  return ESP_OK;
+}
+
+static esp_err_t _replay_destroy(audio_element_handle_t self) {
+  replay_stream_t *mod = (replay_stream_t *)audio_element_getdata(self);
+  if (mod) {
+    STATIC_ELEMENT_FREE(mod);
+  }
+  return ESP_OK;
+}
+
+audio_element_handle_t replay_stream_init(replay_stream_cfg_t *config) {
+  replay_stream_t *mod = STATIC_ELEMENT_CALLOC(replay_stream_t);
+  AUDIO_MEM_CHECK(TAG, mod, {
+    ESP_LOGE(TAG, "Failed to allocate memory for replay_stream_t");
+    return NULL;
+  });
+  mod->partition = config->partition;
+  mod->loops = config->loops;
+
+  audio_element_cfg_t cfg = DEFAULT_AUDIO_ELEMENT_CONFIG();
+  cfg.open = _replay_open;
+  cfg.close = _replay_close;
+  cfg.process = _replay_process;
+  cfg.destroy = _replay_destroy;
+  cfg.tag = "replay";
+  cfg.task_stack = config->task_stack;
+  cfg.task_prio = config->task_prio;
+  cfg.task_core = config->task_core;
+  cfg.out_rb_size = config->out_rb_size;
+  cfg.buffer_len = REPLAY_STREAM_BUF_SIZE;
+
+  audio_element_handle_t el = audio_element_init(&cfg);
+  AUDIO_MEM_CHECK(TAG, el, {
+    ESP_LOGE(TAG, "Failed to initialize audio element");
+    STATIC_ELEMENT_FREE(mod);
+    return NULL;
+  });
+  audio_element_setdata(el, mod);
+
+  audio_element_info_t info = {0};
+  audio_element_setinfo(el, &info);
+  return el;
+}
+
+void replay_stream_get_stats(audio_element_handle_t self, replay_stream_stats_t *stats) {
+  replay_stream_t *mod = (replay_stream_t *)audio_element_getdata(self);
+  *stats = mod->stats;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file replay_stream.h
+ * @brief Audio source element that plays a recording stored in a flash partition, in place of the I2S reader.
+ *
+ * The "recording" partition (see partitions.csv) holds a 44.1kHz 16 bit mono or stereo WAV file, written with
+ * `parttool.py write_partition --partition-name recording --input rec.wav`, e.g. from tools/audio_replay -w.
+ * The partition is memory mapped, blocks are copied out as interleaved stereo. The element does no pacing,
+ * it runs at the speed of the element downstream: realtime in front of i2s_write, as fast as the DSP goes
+ * when nothing follows it.
+ */
+#ifndef REPLAY_STREAM_H_
+#define REPLAY_STREAM_H_
+
+#include "audio_element.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define REPLAY_STREAM_PARTITION "recording"
+
+typedef struct {
+  const char *partition; /*!< Label of the partition holding the WAV file */
+  int loops;             /*!< Number of times the recording is played */
+  int out_rb_size;       /*!< Size of output ringbuffer */
+  int task_stack;        /*!< Task stack size */
+  int task_core;         /*!< Task running core */
+  int task_prio;         /*!< Task priority */
+} replay_stream_cfg_t;
+
+#define REPLAY_STREAM_BUF_SIZE (2048)
+
+#define DEFAULT_REPLAY_STREAM_CONFIG()                                                                                 \
+  {                                                                                                                    \
+      .partition = REPLAY_STREAM_PARTITION,                                                                            \
+      .loops = 1,                                                                                                      \
+      .out_rb_size = 8 * 1024,                                                                                         \
+      .task_stack = 3072,                                                                                              \
+      .task_core = 0,                                                                                                  \
+      .task_prio = 5,                                                                                                  \
+  }
+
+typedef struct {
+  uint64_t samples;   // samples per channel played so far
+  int64_t elapsed_us; // from the first block to the last (or now)
+  bool done;
+} replay_stream_stats_t;
+
+/**
+ * @brief Creates the element, the partition is opened when the pipeline starts.
+ *
+ * @return The audio element handle, or NULL if initialization fails.
+ */
+audio_element_handle_t replay_stream_init(replay_stream_cfg_t *config);
+
+void replay_stream_get_stats(audio_element_handle_t self, replay_stream_stats_t *stats);
+
+#endif // REPLAY_STREAM_H_
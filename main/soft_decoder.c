@@ -0,0 +1,127 @@
+#include "soft_decoder.h"
+
+#include <esp_log.h>
+#include <math.h>
+#include <stdbool.h>
+
+static const char *TAG = "SOFT";
+
+// Spread of element durations around dit/dah lengths, in natural log units.
+// dah/dit = 3 puts the two ~1.1 apart, 0.3 leaves the midpoint ~1.8 sigma from either.
+static const float LOG_SIGMA = 0.3f;
+
+typedef struct {
+  uint8_t bits; // bit i set - element i is a dah
+  char character;
+} soft_code_t;
+
+// codes grouped by length, codes of length l are [by_len[l], by_len[l + 1])
+static soft_code_t codes[128];
+static uint8_t by_len[MORSE_CODE_MAX_LEN + 2];
+static bool initialized = false;
+
+void soft_decoder_init(void) {
+  int n = 0;
+
+  for (int len = 0; len <= MORSE_CODE_MAX_LEN; len++) {
+    by_len[len] = n;
+
+    // keys of length len are [1 << len, 2 << len)
+    for (uint16_t key = 1 << len; key < (2 << len); key++) {
+      char glyph = morse_code_glyph(key);
+      if (!glyph) {
+        continue;
+      }
+      if (n >= sizeof(codes) / sizeof(codes[0])) {
+        ESP_LOGE(TAG, "Code table is too small, key 0x%03x skipped", key);
+        continue;
+      }
+
+      // key has the first element in the most significant bit
+      uint8_t bits = 0;
+      for (int j = 0; j < len; j++) {
+        bits |= ((key >> (len - 1 - j)) & 1) << j;
+      }
+      codes[n].bits = bits;
+      codes[n].character = glyph;
+      n++;
+    }
+  }
+  by_len[MORSE_CODE_MAX_LEN + 1] = n;
+
+  initialized = true;
+  ESP_LOGD(TAG, "Initialized, %d codes", n);
+}
+
+int soft_decode(const int32_t *durations, int n, int32_t dit_len, int32_t dah_len, soft_candidate_t *out, int k,
+                float *confidence) {
+  if (!initialized || n <= 0 || n > MORSE_CODE_MAX_LEN || dit_len <= 0 || dah_len <= dit_len || k <= 0) {
+    return 0;
+  }
+
+  // score = base + sum of delta[i] over dahs
+  const float inv_var = 1.0f / (2.0f * LOG_SIGMA * LOG_SIGMA);
+  const float log_dit = logf((float)dit_len);
+  const float log_dah = logf((float)dah_len);
+  float base = 0.0f;
+  float delta[MORSE_CODE_MAX_LEN];
+
+  for (int i = 0; i < n; i++) {
+    float d = logf((float)(durations[i] > 0 ? durations[i] : 1));
+    float ll_dit = -(d - log_dit) * (d - log_dit) * inv_var;
+    float ll_dah = -(d - log_dah) * (d - log_dah) * inv_var;
+    base += ll_dit;
+    delta[i] = ll_dah - ll_dit;
+  }
+
+  int first = by_len[n];
+  int count = by_len[n + 1] - first;
+  float scores[sizeof(codes) / sizeof(codes[0])];
+  int found = 0;
+
+  for (int c = 0; c < count; c++) {
+    float score = base;
+    for (int i = 0; i < n; i++) {
+      if (codes[first + c].bits & (1 << i)) {
+        score += delta[i];
+      }
+    }
+    scores[c] = score;
+
+    // insert into out, kept sorted best first
+    int pos = found < k ? found : k;
+    while (pos > 0 && out[pos - 1].score < score) {
+      if (pos < k) {
+        out[pos] = out[pos - 1];
+      }
+      pos--;
+    }
+    if (pos < k) {
+      out[pos].character = codes[first + c].character;
+      out[pos].score = score;
+      if (found < k) {
+        found++;
+      }
+    }
+  }
+
+  if (confidence != NULL) {
+    float total = 0.0f;
+    for (int c = 0; c < count; c++) {
+      total += expf(scores[c] - out[0].score);
+    }
+    *confidence = found > 0 ? 1.0f / total : 0.0f;
+  }
+
+  return found;
+}
+
+float soft_confidence_of(const soft_candidate_t *candidates, int found, float confidence, char c) {
+  for (int i = 0; i < found; i++) {
+    if (candidates[i].character == c) {
+      // posteriors share the normalization, the ratio to the best is the likelihood ratio
+      return confidence * expf(candidates[i].score - candidates[0].score);
+    }
+  }
+  return 0.0f;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file soft_decoder.h
+ * @brief Soft-decision character decoder, ranks alphabet characters by the likelihood of raw element durations.
+ *
+ * Element durations are modelled as log-normal around the current dit and dah length estimates. Each character
+ * of matching length is scored as a sum of per element log-likelihoods, using a compact table of
+ * (length, dit/dah bits) built once from the alphabet.
+ */
+#ifndef SOFT_DECODER_H_
+#define SOFT_DECODER_H_
+
+#include <stdint.h>
+
+#include "morse_code_table.h"
+
+// number of candidates kept per character by the decoder
+#define SOFT_CANDIDATES (3)
+// A dit/dah sequence that is not a code is replaced by the best candidate only with at least this confidence,
+// it stays undecodable ('~') otherwise
+#define SOFT_MIN_CONFIDENCE (0.5f)
+
+typedef struct {
+  char character;
+  float score; // log-likelihood of the element durations given this character
+} soft_candidate_t;
+
+/** Builds the compact code table, call once before soft_decode. */
+void soft_decoder_init(void);
+
+/**
+ * @brief Finds the k most likely characters for a sequence of key down durations.
+ *
+ * @param durations key down durations of a single character, samples
+ * @param n number of elements, at most MORSE_CODE_MAX_LEN
+ * @param dit_len current dit length estimate, samples
+ * @param dah_len current dah length estimate, samples
+ * @param[out] out best candidates, most likely first
+ * @param k size of out
+ * @param[out] confidence posterior probability of the best candidate among all characters of this length, 0..1,
+ * may be NULL
+ * @return number of candidates written to out, 0 if no character has n elements
+ */
+int soft_decode(const int32_t *durations, int n, int32_t dit_len, int32_t dah_len, soft_candidate_t *out, int k,
+                float *confidence);
+
+/**
+ * @brief Confidence of a given character from the soft_decode() results.
+ *
+ * @param confidence of the best candidate, as returned by soft_decode()
+ * @return posterior probability of c, 0 if c is not among the found candidates
+ */
+float soft_confidence_of(const soft_candidate_t *candidates, int found, float confidence, char c);
+
+#endif // SOFT_DECODER_H_
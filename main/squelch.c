@@ -0,0 +1,70 @@
+#include "squelch.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "trace.h"
+
+void squelch_init(squelch_t *sq) {
+  memset(sq, 0, sizeof(*sq));
+  sq->window_min = FLT_MAX;
+  sq->noise_ratio = SQUELCH_NOISE_INIT;
+  sq->settle = SQUELCH_SETTLE;
+  sq->open = true;
+}
+
+static void trace_change(const squelch_t *sq) {
+  TRACE(DSP, TRACE_SQUELCH, sq->open, (int32_t)(sq->ratio * 100), (int32_t)fminf(sq->noise_ratio * 100, INT16_MAX));
+}
+
+bool squelch_update(squelch_t *sq, float mean, float peak, int n, float open_margin, uint32_t hang_samples) {
+  if (sq->settle > 0) {
+    // the filters are settling, stays open with a full hang time from the first measured block
+    sq->settle = sq->settle > (uint32_t)n ? sq->settle - n : 0;
+    sq->window += n;
+    sq->hang = hang_samples;
+    sq->open = true;
+    return true;
+  }
+  sq->window_min = fminf(sq->window_min, fmaxf(mean, 1e-3f));
+  sq->window += n;
+  if (sq->window >= SQUELCH_FLOOR_WINDOW) {
+    sq->last_min = sq->window_min;
+    sq->window_min = FLT_MAX;
+    sq->window = 0;
+  }
+  if (open_margin <= 1.0f) {
+    sq->open = true;
+    return true;
+  }
+  // provisional during the first window, from the blocks after the settling time
+  sq->floor = sq->last_min > 0.0f ? fminf(sq->last_min, sq->window_min) : sq->window_min;
+  sq->ratio = peak / sq->floor;
+
+  float open_ratio = sq->noise_ratio * open_margin;
+  // half the margin in dB
+  float hold_ratio = sq->noise_ratio * sqrtf(open_margin);
+
+  if (sq->ratio >= open_ratio || (sq->open && sq->ratio >= hold_ratio)) {
+    if (!sq->open) {
+      sq->open = true;
+      sq->opened++;
+      trace_change(sq);
+    }
+    sq->hang = hang_samples;
+    return true;
+  }
+
+  if (sq->open) {
+    sq->hang = sq->hang > (uint32_t)n ? sq->hang - n : 0;
+    if (sq->hang == 0) {
+      sq->open = false;
+      trace_change(sq);
+    }
+  } else {
+    // learns the noise only while closed, a signal never raises the bar it has to pass
+    sq->noise_ratio += SQUELCH_NOISE_WEIGHT * (sq->ratio - sq->noise_ratio);
+  }
+  return sq->open;
+}
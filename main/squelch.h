@@ -0,0 +1,57 @@
+/**
+ * @file squelch.h
+ * @brief Signal presence squelch, decides per block of the envelope whether a keyed tone is there.
+ *
+ * The noise floor is the lowest block mean of the envelope over the last one to two windows, keyed
+ * signals have key-up blocks in every window so key-down blocks don't lift it. The ratio of the block
+ * peak to the floor is small in noise and jumps with a key-down. While closed, a running average of that
+ * ratio learns what noise alone looks like, and the squelch opens when a block exceeds it by the open
+ * margin. It closes again once no block came within half the margin (in dB) for the hang time, so gaps
+ * between characters and words don't close it. A steady carrier lifts the floor to its own level and closes
+ * the squelch too. It starts open, so a signal present from power-up is not lost: after SQUELCH_SETTLE for
+ * the filters the floor is the lowest block mean so far, refined over the first window, and with no signal in
+ * that time the squelch closes after the hang time.
+ */
+#ifndef SQUELCH_H_
+#define SQUELCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Noise floor window, samples, 1s at 44.1kHz
+#define SQUELCH_FLOOR_WINDOW (44100)
+// Filter settling time at start, samples, 100ms at 44.1kHz
+#define SQUELCH_SETTLE (4410)
+// Weight of a block in the noise ratio average
+#define SQUELCH_NOISE_WEIGHT (0.05f)
+// Noise ratio to start from, peak / floor of a typical noise block
+#define SQUELCH_NOISE_INIT (2.0f)
+
+typedef struct {
+  float floor;       // noise floor, envelope units
+  float window_min;  // lowest block mean in the current window
+  float last_min;    // in the previous window, 0 during the first window
+  uint32_t window;   // samples in the current window
+  uint32_t settle;   // samples left for the filters to settle
+  float noise_ratio; // average peak / floor of the blocks without a signal
+  float ratio;       // peak / floor of the last block
+  uint32_t hang;     // samples left before closing
+  bool open;
+  uint32_t opened; // times opened
+} squelch_t;
+
+void squelch_init(squelch_t *sq);
+
+/**
+ * @brief Updates the state with a block of the envelope.
+ *
+ * @param mean average envelope of the block
+ * @param peak largest envelope sample of the block
+ * @param n samples in the block
+ * @param open_margin block ratio over the noise ratio that opens, 1 or less keeps the squelch open
+ * @param hang_samples samples without a signal before closing
+ * @return true while open
+ */
+bool squelch_update(squelch_t *sq, float mean, float peak, int n, float open_margin, uint32_t hang_samples);
+
+#endif // SQUELCH_H_
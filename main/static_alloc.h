@@ -0,0 +1,92 @@
+/**
+ * @file static_alloc.h
+ * @brief FreeRTOS objects of the application, in .bss with CONFIG_STATIC_MEMORY and on the heap otherwise.
+ *
+ * Each use expands to its own static storage, so a call site creates at most one object in static mode
+ * (all of them run once at startup, or reuse the object after deleting it). The storage then shows up per
+ * module in tools/ram_budget.py.
+ */
+#ifndef STATIC_ALLOC_H_
+#define STATIC_ALLOC_H_
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+#ifdef CONFIG_STATIC_MEMORY
+
+// same as xTaskCreate(), stack_size in bytes
+#define STATIC_TASK_CREATE(fn, name, stack_size, arg, prio, handle)                                                    \
+  ({                                                                                                                   \
+    static StackType_t stack_[(stack_size)];                                                                           \
+    static StaticTask_t tcb_;                                                                                          \
+    TaskHandle_t task_ = xTaskCreateStatic((fn), (name), (stack_size), (arg), (prio), stack_, &tcb_);                  \
+    TaskHandle_t *handle_ = (handle);                                                                                  \
+    if (handle_) {                                                                                                     \
+      *handle_ = task_;                                                                                                \
+    }                                                                                                                  \
+    task_ != NULL ? pdPASS : errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;                                                    \
+  })
+
+#define STATIC_QUEUE_CREATE(length, item_size)                                                                         \
+  ({                                                                                                                   \
+    static uint8_t items_[(length) * (item_size)];                                                                     \
+    static StaticQueue_t queue_;                                                                                       \
+    xQueueCreateStatic((length), (item_size), items_, &queue_);                                                        \
+  })
+
+#define STATIC_STREAM_BUFFER_CREATE(size, trigger_level)                                                               \
+  ({                                                                                                                   \
+    static uint8_t data_[(size) + 1];                                                                                  \
+    static StaticStreamBuffer_t stream_;                                                                               \
+    xStreamBufferCreateStatic((size), (trigger_level), data_, &stream_);                                               \
+  })
+
+#define STATIC_MUTEX_CREATE()                                                                                          \
+  ({                                                                                                                   \
+    static StaticSemaphore_t mutex_;                                                                                   \
+    xSemaphoreCreateMutexStatic(&mutex_);                                                                              \
+  })
+
+#define STATIC_BINARY_SEMAPHORE_CREATE()                                                                               \
+  ({                                                                                                                   \
+    static StaticSemaphore_t semaphore_;                                                                               \
+    xSemaphoreCreateBinaryStatic(&semaphore_);                                                                         \
+  })
+
+#define STATIC_EVENT_GROUP_CREATE()                                                                                    \
+  ({                                                                                                                   \
+    static StaticEventGroup_t group_;                                                                                  \
+    xEventGroupCreateStatic(&group_);                                                                                  \
+  })
+
+// zeroed module data of an audio element, one instance at a time, use STATIC_ELEMENT_FREE() to release it
+#define STATIC_ELEMENT_CALLOC(type)                                                                                    \
+  ({                                                                                                                   \
+    static type data_;                                                                                                 \
+    memset(&data_, 0, sizeof(data_));                                                                                  \
+    &data_;                                                                                                            \
+  })
+#define STATIC_ELEMENT_FREE(ptr) ((void)(ptr))
+
+#else
+
+#define STATIC_TASK_CREATE(fn, name, stack_size, arg, prio, handle)                                                    \
+  xTaskCreate((fn), (name), (stack_size), (arg), (prio), (handle))
+#define STATIC_QUEUE_CREATE(length, item_size) xQueueCreate((length), (item_size))
+#define STATIC_STREAM_BUFFER_CREATE(size, trigger_level) xStreamBufferCreate((size), (trigger_level))
+#define STATIC_MUTEX_CREATE() xSemaphoreCreateMutex()
+#define STATIC_BINARY_SEMAPHORE_CREATE() xSemaphoreCreateBinary()
+#define STATIC_EVENT_GROUP_CREATE() xEventGroupCreate()
+// needs audio_mem.h
+#define STATIC_ELEMENT_CALLOC(type) ((type *)audio_calloc(1, sizeof(type)))
+#define STATIC_ELEMENT_FREE(ptr) audio_free(ptr)
+
+#endif
+
+#endif // STATIC_ALLOC_H_
@@ -0,0 +1,53 @@
+/**
+ * @file storage.h
+ * @brief Minimal NOR flash like storage interface: read, write into erased space, erase whole sectors.
+ *
+ * Backed by a flash partition on the device (storage_partition.c) or by a plain file (storage_file.c),
+ * so code on top of it runs unchanged on Linux for tests and benchmarks. Erased bytes read as 0xFF and
+ * writes may only clear bits, like on flash.
+ */
+#ifndef STORAGE_H_
+#define STORAGE_H_
+
+#include <esp_err.h>
+#include <stddef.h>
+
+typedef struct storage_t storage_t;
+
+struct storage_t {
+  esp_err_t (*read)(storage_t *s, size_t offset, void *buf, size_t len);
+  esp_err_t (*write)(storage_t *s, size_t offset, const void *buf, size_t len);
+  esp_err_t (*erase)(storage_t *s, size_t offset, size_t len); // offset and len are multiples of erase_size
+  size_t size;       // bytes
+  size_t erase_size; // sector size, bytes
+  void *ctx;         // backend specific
+};
+
+static inline esp_err_t storage_read(storage_t *s, size_t offset, void *buf, size_t len) {
+  return s->read(s, offset, buf, len);
+}
+
+static inline esp_err_t storage_write(storage_t *s, size_t offset, const void *buf, size_t len) {
+  return s->write(s, offset, buf, len);
+}
+
+static inline esp_err_t storage_erase(storage_t *s, size_t offset, size_t len) { return s->erase(s, offset, len); }
+
+/**
+ * @brief Opens a data partition by label, ESP-IDF only.
+ *
+ * @return ESP_ERR_NOT_FOUND if the partition table has no such partition
+ */
+esp_err_t storage_partition_open(storage_t *s, const char *label);
+
+/**
+ * @brief Opens (creates if missing) a file of the given size as storage, new files read as erased.
+ *
+ * @param erase_size emulated sector size
+ */
+esp_err_t storage_file_open(storage_t *s, const char *path, size_t size, size_t erase_size);
+
+/** Closes a storage opened with storage_file_open. */
+void storage_file_close(storage_t *s);
+
+#endif // STORAGE_H_
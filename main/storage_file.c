@@ -0,0 +1,109 @@
+#include "storage.h"
+
+#include <esp_log.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "STOR";
+
+static esp_err_t file_read(storage_t *s, size_t offset, void *buf, size_t len) {
+  FILE *f = (FILE *)s->ctx;
+  if (offset + len > s->size || fseek(f, offset, SEEK_SET) != 0 || fread(buf, 1, len, f) != len) {
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+// like flash, a write can only clear bits
+static esp_err_t file_write(storage_t *s, size_t offset, const void *buf, size_t len) {
+  FILE *f = (FILE *)s->ctx;
+  uint8_t chunk[256];
+
+  if (offset + len > s->size) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  for (size_t done = 0; done < len;) {
+    size_t n = len - done < sizeof(chunk) ? len - done : sizeof(chunk);
+    if (file_read(s, offset + done, chunk, n) != ESP_OK) {
+      return ESP_FAIL;
+    }
+    for (size_t i = 0; i < n; i++) {
+      chunk[i] &= ((const uint8_t *)buf)[done + i];
+    }
+    if (fseek(f, offset + done, SEEK_SET) != 0 || fwrite(chunk, 1, n, f) != n) {
+      return ESP_FAIL;
+    }
+    done += n;
+  }
+  return ESP_OK;
+}
+
+static esp_err_t file_erase(storage_t *s, size_t offset, size_t len) {
+  FILE *f = (FILE *)s->ctx;
+  uint8_t ff[256];
+
+  if (offset % s->erase_size != 0 || len % s->erase_size != 0 || offset + len > s->size) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(ff, 0xFF, sizeof(ff));
+  if (fseek(f, offset, SEEK_SET) != 0) {
+    return ESP_FAIL;
+  }
+  for (size_t done = 0; done < len; done += sizeof(ff)) {
+    size_t n = len - done < sizeof(ff) ? len - done : sizeof(ff);
+    if (fwrite(ff, 1, n, f) != n) {
+      return ESP_FAIL;
+    }
+  }
+  return ESP_OK;
+}
+
+esp_err_t storage_file_open(storage_t *s, const char *path, size_t size, size_t erase_size) {
+  if (erase_size == 0 || size % erase_size != 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  FILE *f = fopen(path, "r+b");
+  bool created = false;
+  if (f == NULL) {
+    f = fopen(path, "w+b");
+    created = true;
+  }
+  if (f == NULL) {
+    ESP_LOGE(TAG, "Can't open %s", path);
+    return ESP_FAIL;
+  }
+
+  s->read = file_read;
+  s->write = file_write;
+  s->erase = file_erase;
+  s->size = size;
+  s->erase_size = erase_size;
+  s->ctx = f;
+
+  // a new or short file reads as erased
+  fseek(f, 0, SEEK_END);
+  long have = ftell(f);
+  if (created || have < (long)size) {
+    size_t from = created || have < 0 ? 0 : (size_t)have / erase_size * erase_size;
+    esp_err_t err = file_erase(s, from, size - from);
+    if (err != ESP_OK) {
+      fclose(f);
+      return err;
+    }
+  }
+
+  ESP_LOGI(TAG, "%s, %u bytes", path, (unsigned)size);
+  return ESP_OK;
+}
+
+void storage_file_close(storage_t *s) {
+  if (s->ctx != NULL) {
+    fclose((FILE *)s->ctx);
+    s->ctx = NULL;
+  }
+}
@@ -0,0 +1,37 @@
+#include "storage.h"
+
+#include <esp_log.h>
+#include <esp_partition.h>
+#include <inttypes.h>
+
+static const char *TAG = "STOR";
+
+static esp_err_t partition_read(storage_t *s, size_t offset, void *buf, size_t len) {
+  return esp_partition_read((const esp_partition_t *)s->ctx, offset, buf, len);
+}
+
+static esp_err_t partition_write(storage_t *s, size_t offset, const void *buf, size_t len) {
+  return esp_partition_write((const esp_partition_t *)s->ctx, offset, buf, len);
+}
+
+static esp_err_t partition_erase(storage_t *s, size_t offset, size_t len) {
+  return esp_partition_erase_range((const esp_partition_t *)s->ctx, offset, len);
+}
+
+esp_err_t storage_partition_open(storage_t *s, const char *label) {
+  const esp_partition_t *p = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (p == NULL) {
+    ESP_LOGW(TAG, "No '%s' partition", label);
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  s->read = partition_read;
+  s->write = partition_write;
+  s->erase = partition_erase;
+  s->size = p->size;
+  s->erase_size = p->erase_size;
+  s->ctx = (void *)p;
+
+  ESP_LOGI(TAG, "'%s' at 0x%" PRIx32 ", %" PRIu32 " bytes", label, p->address, p->size);
+  return ESP_OK;
+}
@@ -0,0 +1,183 @@
+#include "telemetry.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <esp_log.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "lcd.h"
+#include "trace.h"
+
+static const char *TAG = "TLM";
+
+static const float SAMPLE_RATE = 44100.0f;
+
+// Counters are only ever incremented by a single task each (decoder or DSP),
+// all fields are 32 bit and are read without locking
+static struct {
+  uint32_t edges;
+  uint32_t chars;
+  uint32_t bad_chars;
+  uint32_t soft_chars;
+  uint32_t blanked;
+  uint32_t dropped;
+  uint32_t blocks;
+  uint32_t open_blocks; // squelch open
+  int32_t shed;
+  float confidence; // sum over chars
+  uint32_t timed_chars;
+  uint32_t latency_us; // sum over timed_chars, wraps, only differences are used
+  int32_t dit_len;
+  int32_t dah_len;
+  float floor;
+  float peak;
+} counters;
+
+// counter values at the time of the last published snapshot
+static uint32_t last_edges = 0;
+static uint32_t last_chars = 0;
+static uint32_t last_bad_chars = 0;
+static uint32_t last_soft_chars = 0;
+static uint32_t last_blanked = 0;
+static uint32_t last_dropped = 0;
+static uint32_t last_blocks = 0;
+static uint32_t last_open_blocks = 0;
+static float last_confidence = 0.0f;
+static uint32_t last_timed_chars = 0;
+static uint32_t last_latency_us = 0;
+static TickType_t last_publish = 0;
+static uint32_t published = 0;
+
+static telemetry_decoder_t snapshot;
+
+void telemetry_init(void) {
+  counters.floor = 1.0f;
+  counters.peak = 1.0f;
+  last_publish = xTaskGetTickCount();
+  ESP_LOGD(TAG, "Initialized");
+}
+
+void telemetry_record_edge(int32_t dit_len, int32_t dah_len) {
+  counters.edges++;
+  counters.dit_len = dit_len;
+  counters.dah_len = dah_len;
+}
+
+void telemetry_record_char(bool decoded, bool soft, float confidence) {
+  counters.confidence += confidence;
+  counters.chars++;
+  if (!decoded) {
+    counters.bad_chars++;
+  }
+  if (soft) {
+    counters.soft_chars++;
+  }
+}
+
+void telemetry_record_latency(float ms) {
+  counters.latency_us += (uint32_t)(ms * 1000.0f);
+  counters.timed_chars++;
+}
+
+void telemetry_record_levels(float floor, float peak) {
+  counters.floor = floor;
+  counters.peak = peak;
+}
+
+void telemetry_record_blanked(int blanked) { counters.blanked += blanked; }
+
+void telemetry_record_squelch(bool open) {
+  counters.open_blocks += open;
+  counters.blocks++;
+}
+
+void telemetry_record_shed(int step) { counters.shed = step; }
+
+void telemetry_record_edge_dropped(void) { counters.dropped++; }
+
+void telemetry_get_decoder(telemetry_decoder_t *out) { *out = snapshot; }
+
+int telemetry_format(const telemetry_decoder_t *t, char *buf, size_t len) {
+  return snprintf(buf, len,
+                  "wpm=%.1f r=%.1f snr=%.0f e/s=%.1f c/s=%.1f bad=%.2f soft=%.2f nb=%.0f conf=%.2f lat=%.0f shed=%d "
+                  "drop=%.1f sq=%.2f",
+                  t->wpm, t->dit_dah_ratio, t->snr_db, t->edges_per_sec, t->chars_per_sec, t->undecodable_rate,
+                  t->soft_rate, t->blanked_per_sec, t->confidence, t->latency_ms, t->shed, t->dropped_per_sec,
+                  t->squelch_open);
+}
+
+static void update_snapshot(float dt) {
+  uint32_t edges = counters.edges;
+  uint32_t chars = counters.chars;
+  uint32_t bad_chars = counters.bad_chars;
+  uint32_t soft_chars = counters.soft_chars;
+  uint32_t blanked = counters.blanked;
+  uint32_t dropped = counters.dropped;
+  // open_blocks is read first, it can't get ahead of blocks
+  uint32_t open_blocks = counters.open_blocks;
+  uint32_t blocks = counters.blocks;
+  float confidence = counters.confidence;
+  uint32_t timed_chars = counters.timed_chars;
+  uint32_t latency_us = counters.latency_us;
+  int32_t dit_len = counters.dit_len;
+  int32_t dah_len = counters.dah_len;
+
+  // PARIS: 50 dit units per word
+  snapshot.wpm = dit_len > 0 ? 1.2f * SAMPLE_RATE / (float)dit_len : 0.0f;
+  snapshot.dit_dah_ratio = dit_len > 0 ? (float)dah_len / (float)dit_len : 0.0f;
+
+  // floor can get close to 0 on a clean signal, limit to something sensible
+  float floor = fmaxf(counters.floor, 1.0f);
+  float peak = fmaxf(counters.peak, floor);
+  snapshot.snr_db = 20.0f * log10f(peak / floor);
+
+  snapshot.edges_per_sec = (float)(edges - last_edges) / dt;
+  snapshot.chars_per_sec = (float)(chars - last_chars) / dt;
+  snapshot.undecodable_rate =
+      chars != last_chars ? (float)(bad_chars - last_bad_chars) / (float)(chars - last_chars) : 0.0f;
+  snapshot.soft_rate =
+      chars != last_chars ? (float)(soft_chars - last_soft_chars) / (float)(chars - last_chars) : 0.0f;
+  snapshot.blanked_per_sec = (float)(blanked - last_blanked) / dt;
+  snapshot.shed = counters.shed;
+  snapshot.dropped_per_sec = (float)(dropped - last_dropped) / dt;
+  snapshot.squelch_open =
+      blocks != last_blocks ? (float)(open_blocks - last_open_blocks) / (float)(blocks - last_blocks) : 0.0f;
+  snapshot.confidence = chars != last_chars ? (confidence - last_confidence) / (float)(chars - last_chars) : 0.0f;
+  snapshot.latency_ms = timed_chars != last_timed_chars
+                            ? (latency_us - last_latency_us) / 1000.0f / (float)(timed_chars - last_timed_chars)
+                            : 0.0f;
+
+  last_edges = edges;
+  last_chars = chars;
+  last_bad_chars = bad_chars;
+  last_soft_chars = soft_chars;
+  last_blanked = blanked;
+  last_dropped = dropped;
+  last_blocks = blocks;
+  last_open_blocks = open_blocks;
+  last_confidence = confidence;
+  last_timed_chars = timed_chars;
+  last_latency_us = latency_us;
+}
+
+void telemetry_poll(void) {
+  TickType_t now = xTaskGetTickCount();
+  TickType_t elapsed = now - last_publish;
+
+  if (elapsed < pdMS_TO_TICKS(TELEMETRY_PERIOD_MS)) {
+    return;
+  }
+
+  last_publish = now;
+  update_snapshot((float)pdTICKS_TO_MS(elapsed) / 1000.0f);
+
+  // the trace formatter task formats and logs the record
+  TRACE(TLM, TRACE_TELEMETRY, ++published, 0, 0);
+
+  // LCD is 17 columns wide, integers only, float formatting is left to the formatter task
+  char status[24];
+  snprintf(status, sizeof(status), "%2dw %2ddB %3d%%", (int)lroundf(snapshot.wpm), (int)lroundf(snapshot.snr_db),
+           (int)lroundf(100.0f * (1.0f - snapshot.undecodable_rate - snapshot.soft_rate)));
+  lcd_set_status(status);
+}
@@ -0,0 +1,85 @@
+/**
+ * @file telemetry.h
+ * @brief Cheap always-on decoder statistics, published periodically to the console and the LCD status line.
+ */
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// How often a telemetry record is published, in milliseconds
+#define TELEMETRY_PERIOD_MS (2000)
+
+// Snapshot of the decoder telemetry, rates are averaged over the last publishing period
+typedef struct {
+  float wpm;              // estimated speed, PARIS standard (dit = 1.2 / wpm seconds)
+  float dit_dah_ratio;    // dah length / dit length, ~3 for well formed morse
+  float snr_db;           // AGC envelope peak / floor ratio
+  float edges_per_sec;    // OOK edges handled by the decoder
+  float chars_per_sec;    // characters emitted, including undecodable ones
+  float undecodable_rate; // fraction of emitted characters that could not be decoded, 0..1
+  float soft_rate;        // fraction of emitted characters guessed by the soft decoder, 0..1
+  float blanked_per_sec;  // input samples gated by the noise blanker
+  float confidence;       // average soft decoder confidence of emitted characters, 0..1
+  float latency_ms;       // average last key-up to decoded character, see morse_char_t
+  int shed;               // DSP load shedding step, see audio_dsp_shed_t
+  float dropped_per_sec;  // edges lost to a full decoder queue
+  float squelch_open;     // fraction of DSP blocks with the squelch open, 0..1
+} telemetry_decoder_t;
+
+void telemetry_init(void);
+
+/** Records a decoder edge, called once per edge from the decoder task.
+ *  @param dit_len current dit length estimate, in samples
+ *  @param dah_len current dah length estimate, in samples
+ */
+void telemetry_record_edge(int32_t dit_len, int32_t dah_len);
+
+/** Records an emitted character.
+ *  @param decoded false if the character could not be decoded
+ *  @param soft the character is a soft decoder guess, not a valid dit/dah sequence
+ *  @param confidence soft decoder confidence of the character, 0..1
+ */
+void telemetry_record_char(bool decoded, bool soft, float confidence);
+
+/** Records the latency of a decoded character, called from the decoder task.
+ *  @param ms last key-up of the character to its decision
+ */
+void telemetry_record_latency(float ms);
+
+/** Records AGC envelope levels, called once per DSP block.
+ *  @param floor envelope minimum
+ *  @param peak envelope maximum
+ */
+void telemetry_record_levels(float floor, float peak);
+
+/** Records a change of the DSP load shedding step, called from the DSP element. */
+void telemetry_record_shed(int step);
+
+/** Records an edge the DSP could not queue for the decoder, called from the DSP element. */
+void telemetry_record_edge_dropped(void);
+
+/** Records the squelch state, called once per DSP block. */
+void telemetry_record_squelch(bool open);
+
+/** Records the number of samples gated by the noise blanker, called once per DSP block. */
+void telemetry_record_blanked(int blanked);
+
+/** Returns the most recently published snapshot. */
+void telemetry_get_decoder(telemetry_decoder_t *out);
+
+/** Formats a compact single line record,
+ *  e.g. "wpm=18.2 r=3.0 snr=21 e/s=12.0 c/s=1.4 bad=0.05 soft=0.02 nb=0 conf=0.92 lat=250 shed=0 drop=0.0
+ *  sq=1.00".
+ */
+int telemetry_format(const telemetry_decoder_t *t, char *buf, size_t len);
+
+/** Publishes a new snapshot if TELEMETRY_PERIOD_MS has elapsed since the last one.
+ *  Called from the decoder task, the record is logged by the trace formatter (TRACE_TELEMETRY) and a summary
+ *  shown on the LCD status line.
+ */
+void telemetry_poll(void);
+
+#endif // TELEMETRY_H_
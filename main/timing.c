@@ -0,0 +1,121 @@
+#include "timing.h"
+
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#include "morse.h"
+#include "morse_core.h"
+#include "static_alloc.h"
+#include "storage.h"
+#include "timing_store.h"
+
+static const char *TAG = "TIMING";
+
+static storage_t storage;
+static timing_store_t store;
+// snapshot handed to the writer, the decoder task fills it only while the writer is not busy
+static morse_timing_t pending;
+static SemaphoreHandle_t save_request = NULL;
+static volatile bool saving = false;
+
+// dit/dah lengths of the last snapshot saved or restored
+static int32_t saved_dit_len = 0;
+static int32_t saved_dah_len = 0;
+static TickType_t last_save = 0;
+// characters decoded since boot, the first save waits for TIMING_SETTLE_CHARS of them, decoder task only
+static uint32_t decoded_chars = 0;
+static bool first_save_done = false;
+
+static void on_char(const morse_char_t *ch, void *ctx) {
+  if (ch->c != 0 && !ch->soft) {
+    decoded_chars++;
+  }
+}
+
+static void timing_task(void *pvParameters) {
+  while (1) {
+    xSemaphoreTake(save_request, portMAX_DELAY);
+    esp_err_t err = timing_store_save(&store, &pending);
+    if (err == ESP_OK) {
+      ESP_LOGI(TAG, "Saved snapshot %" PRIu32 ", dit %d dah %d samples", store.seq, (int)pending.dit_len,
+               (int)pending.dah_len);
+    } else {
+      ESP_LOGW(TAG, "Save failed: %s", esp_err_to_name(err));
+    }
+    saving = false;
+  }
+}
+
+esp_err_t timing_init(void) {
+  esp_err_t err = storage_partition_open(&storage, TIMING_PARTITION);
+  if (err != ESP_OK) {
+    return err;
+  }
+  err = timing_store_open(&store, &storage);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Open failed: %s", esp_err_to_name(err));
+    return err;
+  }
+
+  // the decoder task is not running yet, morse_core can be touched from here
+  err = timing_store_load(&store, &pending);
+  if (err == ESP_OK) {
+    err = morse_core_set_timing(&pending);
+  }
+  if (err == ESP_OK) {
+    saved_dit_len = pending.dit_len;
+    saved_dah_len = pending.dah_len;
+  } else {
+    ESP_LOGI(TAG, "Cold start: %s", esp_err_to_name(err));
+  }
+
+  // morse_init() calls this before the decoder task starts
+  err = morse_add_char_listener(on_char, NULL);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  save_request = STATIC_BINARY_SEMAPHORE_CREATE();
+  if (save_request == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  if (STATIC_TASK_CREATE(timing_task, "TimingSave", 3072, NULL, tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create timing task");
+    save_request = NULL;
+    return ESP_ERR_INVALID_STATE;
+  }
+  last_save = xTaskGetTickCount();
+  return ESP_OK;
+}
+
+void timing_poll(void) {
+  if (save_request == NULL || saving) {
+    return;
+  }
+  // once as soon as the speed settled, then at most every CONFIG_TIMING_SAVE_MIN minutes
+  TickType_t now = xTaskGetTickCount();
+  if (first_save_done ? now - last_save < pdMS_TO_TICKS(CONFIG_TIMING_SAVE_MIN * 60 * 1000)
+                      : decoded_chars < TIMING_SETTLE_CHARS) {
+    return;
+  }
+  first_save_done = true;
+  last_save = now;
+
+  morse_timing_t *t = &pending;
+  morse_core_get_timing(t);
+  // nothing learned, or the same speed as saved, the flash is spared
+  if (t->dit_len <= 0 || t->dah_len <= t->dit_len || (t->dit_len == saved_dit_len && t->dah_len == saved_dah_len)) {
+    return;
+  }
+  saved_dit_len = t->dit_len;
+  saved_dah_len = t->dah_len;
+
+  saving = true;
+  xSemaphoreGive(save_request);
+}
@@ -0,0 +1,32 @@
+/**
+ * @file timing.h
+ * @brief Warm start: the decoder timing (morse_timing_t) is saved to the "timing" flash partition
+ * (see partitions.csv) and restored at boot, so the first characters decode at the last speed.
+ *
+ * The decoder task takes a snapshot once TIMING_SETTLE_CHARS characters decoded after boot, then at most every
+ * CONFIG_TIMING_SAVE_MIN minutes, and only if the dit/dah lengths changed. A low priority task writes it
+ * (timing_store.h) so flash erases never stall decoding.
+ */
+#ifndef TIMING_H_
+#define TIMING_H_
+
+#include <esp_err.h>
+
+// Partition label
+#define TIMING_PARTITION "timing"
+
+// Characters decoded after boot before the first snapshot, the speed has settled by then
+#define TIMING_SETTLE_CHARS (20)
+
+/**
+ * @brief Opens the partition, restores the saved timing into morse_core and starts the writer task.
+ * Called from morse_init() before the decoder task starts, registers a character listener.
+ *
+ * @return ESP_ERR_NOT_FOUND without the partition, timing_poll is a no-op then
+ */
+esp_err_t timing_init(void);
+
+/** Called by the decoder task between edges, hands a snapshot to the writer when one is due. */
+void timing_poll(void);
+
+#endif // TIMING_H_
@@ -0,0 +1,120 @@
+#include "timing_store.h"
+
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "crc32.h"
+
+static const char *TAG = "TSTORE";
+
+// fixed part of morse_timing_t, the counts follow
+#define TIMING_FIXED_LEN (offsetof(morse_timing_t, counts))
+
+static size_t slot_addr(const timing_store_t *ts, int slot) { return (size_t)slot * ts->storage->erase_size; }
+
+static size_t payload_len(const morse_timing_t *t) { return TIMING_FIXED_LEN + t->bins; }
+
+// reads the header of a slot and checks it against the payload
+static bool read_record(timing_store_t *ts, int slot, timing_record_header_t *h) {
+  size_t addr = slot_addr(ts, slot);
+  if (storage_read(ts->storage, addr, h, sizeof(*h)) != ESP_OK || h->magic != TIMING_STORE_MAGIC) {
+    return false;
+  }
+  if (h->version != TIMING_STORE_VERSION) {
+    ESP_LOGW(TAG, "Slot %d has version %u, ignored", slot, (unsigned)h->version);
+    return false;
+  }
+  if (h->len < TIMING_FIXED_LEN || h->len > sizeof(morse_timing_t)) {
+    return false;
+  }
+
+  uint32_t crc = crc32_update(0, h, offsetof(timing_record_header_t, crc));
+  uint8_t chunk[64];
+  for (size_t done = 0; done < h->len;) {
+    size_t n = h->len - done < sizeof(chunk) ? h->len - done : sizeof(chunk);
+    if (storage_read(ts->storage, addr + sizeof(*h) + done, chunk, n) != ESP_OK) {
+      return false;
+    }
+    crc = crc32_update(crc, chunk, n);
+    done += n;
+  }
+  return crc == h->crc;
+}
+
+esp_err_t timing_store_open(timing_store_t *ts, storage_t *storage) {
+  memset(ts, 0, sizeof(*ts));
+  ts->storage = storage;
+  ts->slot = -1;
+
+  if (storage->size / storage->erase_size < 2 ||
+      storage->erase_size < sizeof(timing_record_header_t) + sizeof(morse_timing_t)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  for (int slot = 0; slot < 2; slot++) {
+    timing_record_header_t h;
+    if (read_record(ts, slot, &h) && (ts->slot < 0 || h.seq > ts->seq)) {
+      ts->slot = slot;
+      ts->seq = h.seq;
+    }
+  }
+
+  if (ts->slot >= 0) {
+    ESP_LOGI(TAG, "Snapshot %" PRIu32 " in slot %d", ts->seq, ts->slot);
+  }
+  return ESP_OK;
+}
+
+esp_err_t timing_store_load(timing_store_t *ts, morse_timing_t *t) {
+  timing_record_header_t h;
+  if (ts->slot < 0) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  esp_err_t err = storage_read(ts->storage, slot_addr(ts, ts->slot), &h, sizeof(h));
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  memset(t, 0, sizeof(*t));
+  err = storage_read(ts->storage, slot_addr(ts, ts->slot) + sizeof(h), t, h.len);
+  if (err != ESP_OK) {
+    return err;
+  }
+  // counts past the record length are not there
+  if (payload_len(t) > h.len) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  return ESP_OK;
+}
+
+esp_err_t timing_store_save(timing_store_t *ts, const morse_timing_t *t) {
+  int slot = ts->slot == 0 ? 1 : 0;
+  size_t addr = slot_addr(ts, slot);
+  timing_record_header_t h = {
+      .magic = TIMING_STORE_MAGIC,
+      .version = TIMING_STORE_VERSION,
+      .len = (uint16_t)payload_len(t),
+      .seq = ts->seq + 1,
+  };
+  h.crc = crc32_update(crc32_update(0, &h, offsetof(timing_record_header_t, crc)), t, h.len);
+
+  esp_err_t err = storage_erase(ts->storage, addr, ts->storage->erase_size);
+  if (err == ESP_OK) {
+    err = storage_write(ts->storage, addr + sizeof(h), t, h.len);
+  }
+  if (err == ESP_OK) {
+    // the record is valid from here on
+    err = storage_write(ts->storage, addr, &h, sizeof(h));
+  }
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  ts->slot = slot;
+  ts->seq = h.seq;
+  ts->saves++;
+  return ESP_OK;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file timing_store.h
+ * @brief Decoder timing snapshots (morse_timing_t) on top of a storage_t, platform free.
+ *
+ * Two slots, the first two erase sectors, written alternately so a save torn by a reset leaves the
+ * previous snapshot intact. A record is a header (magic, version, payload length, sequence number, CRC)
+ * followed by the morse_timing_t fields up to the used counts, ~280 bytes with the default histogram.
+ * The payload is written before the header, a slot without a valid header is empty. The valid slot with
+ * the higher sequence number is loaded, records of another version are ignored.
+ *
+ * Not thread safe, see timing.h for the device side.
+ */
+#ifndef TIMING_STORE_H_
+#define TIMING_STORE_H_
+
+#include <esp_err.h>
+#include <stdint.h>
+
+#include "morse_core.h"
+#include "storage.h"
+
+#define TIMING_STORE_MAGIC (0x474E4D54) // "TMNG"
+// Bumped whenever morse_timing_t changes
+#define TIMING_STORE_VERSION (1)
+
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t len; // payload bytes
+  uint32_t seq; // save counter, the newer slot wins
+  uint32_t crc; // of the fields above and the payload
+} timing_record_header_t;
+
+typedef struct {
+  storage_t *storage;
+  int slot;       // holding the newest valid record, -1 for none
+  uint32_t seq;   // of that record
+  uint32_t saves; // records written since open
+} timing_store_t;
+
+/**
+ * @brief Finds the newest valid record.
+ *
+ * @return ESP_ERR_INVALID_SIZE if the storage has less than 2 sectors or a sector can't hold a record
+ */
+esp_err_t timing_store_open(timing_store_t *ts, storage_t *storage);
+
+/** @return ESP_ERR_NOT_FOUND if no slot has a valid record */
+esp_err_t timing_store_load(timing_store_t *ts, morse_timing_t *t);
+
+/** Writes a new record over the older slot. */
+esp_err_t timing_store_save(timing_store_t *ts, const morse_timing_t *t);
+
+#endif // TIMING_STORE_H_
@@ -0,0 +1,103 @@
+#include "trace.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "static_alloc.h"
+
+static const char *TAG = "TRACE";
+
+_Static_assert((TRACE_RING_LEN & (TRACE_RING_LEN - 1)) == 0, "TRACE_RING_LEN must be a power of two");
+
+// How often the formatter looks for new events, milliseconds
+#define TRACE_POLL_MS (50)
+
+typedef struct {
+  _Atomic uint32_t seq; // event index + 1 once written, 0 while a producer is writing
+  trace_event_t ev;
+} trace_slot_t;
+
+static trace_slot_t ring[TRACE_RING_LEN];
+// next event index to hand out to a producer
+static _Atomic uint32_t head = 0;
+// next event index to read, reader only
+static uint32_t tail = 0;
+
+void trace_record(trace_module_t module, trace_type_t type, int32_t a, int32_t b, int16_t c) {
+  uint32_t idx = atomic_fetch_add_explicit(&head, 1, memory_order_relaxed);
+  trace_slot_t *s = &ring[idx & (TRACE_RING_LEN - 1)];
+
+  atomic_store_explicit(&s->seq, 0, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  s->ev.time_us = (uint32_t)esp_timer_get_time();
+  s->ev.module = module;
+  s->ev.type = type;
+  s->ev.c = c;
+  s->ev.a = a;
+  s->ev.b = b;
+  atomic_store_explicit(&s->seq, idx + 1, memory_order_release);
+}
+
+size_t trace_read(trace_event_t *out, size_t len) {
+  size_t n = 0;
+
+  while (n < len) {
+    trace_slot_t *s = &ring[tail & (TRACE_RING_LEN - 1)];
+    uint32_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+
+    if (seq == tail + 1) {
+      trace_event_t ev = s->ev;
+      atomic_thread_fence(memory_order_acquire);
+      if (atomic_load_explicit(&s->seq, memory_order_relaxed) == seq) {
+        out[n++] = ev;
+        tail++;
+        continue;
+      }
+      // overwritten while copying, the reader has been lapped
+    } else if (seq == 0 || (int32_t)(seq - (tail + 1)) < 0) {
+      break; // not written yet, or still being written
+    }
+
+    // lapped, skip ahead to keep half a ring of the newest events
+    uint32_t resume = atomic_load_explicit(&head, memory_order_relaxed) - TRACE_RING_LEN / 2;
+    out[n++] = (trace_event_t){.module = 0xFF, .type = TRACE_LOST, .a = (int32_t)(resume - tail)};
+    tail = resume;
+  }
+
+  return n;
+}
+
+#ifdef CONFIG_TRACE_FORMATTER
+static void trace_task(void *pvParameters) {
+  static trace_formatter_t formatter;
+  trace_event_t events[16];
+  char line[192];
+
+  while (1) {
+    size_t n = trace_read(events, sizeof(events) / sizeof(events[0]));
+    for (size_t i = 0; i < n; i++) {
+      int level = trace_format(&formatter, &events[i], line, sizeof(line));
+      if (level != ESP_LOG_NONE) {
+        ESP_LOG_LEVEL((esp_log_level_t)level, trace_module_name(events[i].module), "%s", line);
+      }
+    }
+
+    if (n == 0) {
+      vTaskDelay(pdMS_TO_TICKS(TRACE_POLL_MS));
+    }
+  }
+}
+#endif
+
+void trace_init(void) {
+#ifdef CONFIG_TRACE_FORMATTER
+  if (STATIC_TASK_CREATE(trace_task, "Trace", 3072, NULL, tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create trace formatter task");
+  }
+#endif
+  ESP_LOGI(TAG, "%d event ring", TRACE_RING_LEN);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file trace.h
+ * @brief Deferred binary trace, fixed size events recorded from any task and formatted later.
+ *
+ * trace_record() timestamps an event and stores it in a lock-free multi-producer ring, no formatting,
+ * no locks, no syscalls. A low priority task (CONFIG_TRACE_FORMATTER) drains the ring and prints the
+ * events with trace_format(), which is platform free so host tools can format captured events too.
+ * When producers lap the reader the oldest events are lost and counted.
+ *
+ * Each module traces through TRACE(MODULE, ...), which compiles out unless CONFIG_TRACE_<MODULE> is set.
+ */
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#else
+// host builds trace everything
+#define CONFIG_TRACE_DSP 1
+#define CONFIG_TRACE_MORSE 1
+#define CONFIG_TRACE_LM 1
+#define CONFIG_TRACE_TLM 1
+#define CONFIG_TRACE_RING_LEN 256
+#endif
+
+#ifdef CONFIG_TRACE_DSP
+#define TRACE_DSP_ENABLED 1
+#else
+#define TRACE_DSP_ENABLED 0
+#endif
+#ifdef CONFIG_TRACE_MORSE
+#define TRACE_MORSE_ENABLED 1
+#else
+#define TRACE_MORSE_ENABLED 0
+#endif
+#ifdef CONFIG_TRACE_LM
+#define TRACE_LM_ENABLED 1
+#else
+#define TRACE_LM_ENABLED 0
+#endif
+#ifdef CONFIG_TRACE_TLM
+#define TRACE_TLM_ENABLED 1
+#else
+#define TRACE_TLM_ENABLED 0
+#endif
+
+// Number of events the ring holds, power of two
+#ifdef CONFIG_TRACE_RING_LEN
+#define TRACE_RING_LEN (CONFIG_TRACE_RING_LEN)
+#else
+#define TRACE_RING_LEN (256)
+#endif
+
+typedef enum {
+  TRACE_MODULE_DSP,   // OOK edge detector, edge filter
+  TRACE_MODULE_MORSE, // decoder task
+  TRACE_MODULE_LM,    // look-ahead re-decoding
+  TRACE_MODULE_TLM,   // telemetry records and settings changes, formatted here instead of the DSP and decoder tasks
+} trace_module_t;
+
+// a, b, c meaning per type
+typedef enum {
+  TRACE_EDGE,      // a = edge, samples, negative - key up
+  TRACE_CLAMP,     // a = samples in state, edge length saturated
+  TRACE_GLITCH,    // a = merged edge, b = threshold
+  TRACE_ELEMENT,   // a = key down duration, b = dit/dah threshold
+  TRACE_GAP,       // a = key up duration, c = 1 element, 2 character, 3 word gap
+  TRACE_CHAR,      // a = glyph, 0 undecodable, b = confidence of the glyph * 1000, c = 1 soft decoder guess
+  TRACE_TEXT,      // a = glyph appended to the transcript
+  TRACE_WORD,      // end of word
+  TRACE_THRESHOLD, // a = dit length, b = dah length
+  TRACE_CORRECT,   // a = characters kept, b = new word length
+  TRACE_REDECODE,  // a = edges, b = characters
+  TRACE_KEEP_LIVE, // a = re-decoded mean confidence * 1000, b = live mean confidence * 1000
+  TRACE_SQUELCH,   // a = 1 opened, 0 closed, b = block peak / floor * 100, c = noise ratio * 100
+  TRACE_TELEMETRY, // a = snapshot published, the formatter takes the record from telemetry_get_decoder()
+  TRACE_SETTINGS,  // a = parameter generation applied by the DSP
+  TRACE_SHED,      // a = load shedding step, b = input ringbuffer fill %, c = block time %
+  TRACE_NB,        // a = 1 noise blanker on, 0 off
+  TRACE_HISTOGRAM, // a = pulse_max, b = bins << 16 | pulse_min, c = decay * 1000; c = -1, a = esp_err_t if rejected
+  TRACE_LOST,      // a = events lost, made up by the reader
+} trace_type_t;
+
+typedef struct {
+  uint32_t time_us; // low 32 bits of esp_timer_get_time()
+  uint8_t module;   // trace_module_t
+  uint8_t type;     // trace_type_t
+  int16_t c;
+  int32_t a;
+  int32_t b;
+} trace_event_t;
+
+#define TRACE(module, type, a, b, c)                                                                                   \
+  do {                                                                                                                 \
+    if (TRACE_##module##_ENABLED) {                                                                                    \
+      trace_record(TRACE_MODULE_##module, (type), (a), (b), (c));                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+/** Starts the formatter task if configured, events are recorded either way. */
+void trace_init(void);
+
+/** Records an event, safe from any task, never blocks. Use TRACE() instead. */
+void trace_record(trace_module_t module, trace_type_t type, int32_t a, int32_t b, int16_t c);
+
+/**
+ * @brief Takes recorded events out of the ring, single reader.
+ *
+ * @param[out] out events, oldest first, a TRACE_LOST event marks a gap
+ * @return number of events written to out
+ */
+size_t trace_read(trace_event_t *out, size_t len);
+
+// state of trace_format, collects elements and text of the current word
+typedef struct {
+  char elements[64];
+  size_t elements_len;
+  char text[64];
+  size_t text_len;
+} trace_formatter_t;
+
+/**
+ * @brief Formats an event.
+ *
+ * @param[out] line 0-terminated text, if any
+ * @return log level for the line (esp_log_level_t values), 0 if the event only updated the formatter state
+ */
+int trace_format(trace_formatter_t *f, const trace_event_t *ev, char *line, size_t len);
+
+/** @return module name, also the log tag */
+const char *trace_module_name(uint8_t module);
+
+#endif // TRACE_H_
@@ -0,0 +1,133 @@
+#include "trace.h"
+
+#include <esp_err.h>
+#include <esp_log.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "morse_code_table.h"
+#include "telemetry.h"
+
+// sample rate of edge and element durations
+#define TRACE_SAMPLE_RATE (44100.0f)
+#define TSECS(samples) ((float)(samples) / TRACE_SAMPLE_RATE)
+
+const char *trace_module_name(uint8_t module) {
+  switch (module) {
+  case TRACE_MODULE_DSP:
+    return "DSP";
+  case TRACE_MODULE_MORSE:
+    return "MORSE";
+  case TRACE_MODULE_LM:
+    return "LM";
+  case TRACE_MODULE_TLM:
+    return "TLM";
+  default:
+    return "TRACE";
+  }
+}
+
+static void append(char *buf, size_t *len, size_t size, const char *text) {
+  while (*text && *len + 1 < size) {
+    buf[(*len)++] = *text++;
+  }
+  buf[*len] = 0;
+}
+
+// audio_dsp_shed_t steps
+static const char *const shed_names[] = {
+    "full processing",
+    "no DAC pass-through",
+    "no DAC pass-through, no noise blanker",
+};
+
+int trace_format(trace_formatter_t *f, const trace_event_t *ev, char *line, size_t len) {
+  static const char *const gaps[] = {"", "~", "~~", "~~~"};
+  line[0] = 0;
+
+  switch (ev->type) {
+  case TRACE_EDGE:
+    snprintf(line, len, "edge %+ld", (long)ev->a);
+    return ESP_LOG_VERBOSE;
+  case TRACE_CLAMP:
+    snprintf(line, len, "sample count %lu clamped", (unsigned long)ev->a);
+    return ESP_LOG_WARN;
+  case TRACE_SQUELCH:
+    snprintf(line, len, "squelch %s, ratio %.2f, noise %.2f", ev->a ? "open" : "closed", ev->b / 100.0, ev->c / 100.0);
+    return ESP_LOG_DEBUG;
+  case TRACE_GLITCH:
+    snprintf(line, len, "glitch %ld < %ld", (long)ev->a, (long)ev->b);
+    return ESP_LOG_VERBOSE;
+  case TRACE_ELEMENT: {
+    char e = ev->a >= ev->b ? '-' : '.';
+    append(f->elements, &f->elements_len, sizeof(f->elements), e == '-' ? "-" : ".");
+    snprintf(line, len, "%c %0.3f / %0.3f", e, TSECS(ev->a), TSECS(ev->b));
+    return ESP_LOG_DEBUG;
+  }
+  case TRACE_GAP:
+    snprintf(line, len, "%s %0.3f", gaps[ev->c & 3], TSECS(ev->a));
+    return ESP_LOG_DEBUG;
+  case TRACE_CHAR:
+    append(f->elements, &f->elements_len, sizeof(f->elements), " ");
+    if (ev->a == 0) {
+      snprintf(line, len, "?");
+    } else if (ev->c) {
+      snprintf(line, len, "soft %s %.2f", morse_glyph_text((char)ev->a), ev->b / 1000.0f);
+    } else {
+      snprintf(line, len, "%s", morse_glyph_text((char)ev->a));
+    }
+    return ESP_LOG_DEBUG;
+  case TRACE_TEXT:
+    append(f->text, &f->text_len, sizeof(f->text), morse_glyph_text((char)ev->a));
+    return 0;
+  case TRACE_WORD:
+    snprintf(line, len, "%s| %s", f->elements, f->text);
+    f->elements_len = f->text_len = 0;
+    f->elements[0] = f->text[0] = 0;
+    return ESP_LOG_WARN;
+  case TRACE_THRESHOLD:
+    snprintf(line, len, "dit %0.3f dah %0.3f", TSECS(ev->a), TSECS(ev->b));
+    return ESP_LOG_DEBUG;
+  case TRACE_CORRECT:
+    snprintf(line, len, "correcting from char %ld, %ld chars", (long)ev->a, (long)ev->b);
+    return ESP_LOG_DEBUG;
+  case TRACE_REDECODE:
+    snprintf(line, len, "re-decoded %ld edges into %ld chars", (long)ev->a, (long)ev->b);
+    return ESP_LOG_VERBOSE;
+  case TRACE_KEEP_LIVE:
+    snprintf(line, len, "re-decoded word dropped, confidence %.3f live %.3f", ev->a / 1000.0f, ev->b / 1000.0f);
+    return ESP_LOG_DEBUG;
+  case TRACE_TELEMETRY: {
+    // published every TELEMETRY_PERIOD_MS, the snapshot is long stable when this runs
+    telemetry_decoder_t t;
+    telemetry_get_decoder(&t);
+    telemetry_format(&t, line, len);
+    return ESP_LOG_INFO;
+  }
+  case TRACE_SETTINGS:
+    snprintf(line, len, "settings %lu applied", (unsigned long)ev->a);
+    return ESP_LOG_INFO;
+  case TRACE_SHED:
+    snprintf(line, len, "load shedding step %ld, %s (input ringbuffer %ld%%, block time %d%%)", (long)ev->a,
+             ev->a >= 0 && ev->a < (int32_t)(sizeof(shed_names) / sizeof(shed_names[0])) ? shed_names[ev->a] : "?",
+             (long)ev->b, (int)ev->c);
+    return ESP_LOG_WARN;
+  case TRACE_NB:
+    snprintf(line, len, "noise blanker %s", ev->a ? "on" : "off");
+    return ESP_LOG_INFO;
+  case TRACE_HISTOGRAM:
+    if (ev->c < 0) {
+      snprintf(line, len, "dit/dah histogram not changed: %s", esp_err_to_name(ev->a));
+      return ESP_LOG_ERROR;
+    }
+    snprintf(line, len, "dit/dah histogram %ld bins over [%ld, %ld], decay %.2f", (long)((uint32_t)ev->b >> 16),
+             (long)(ev->b & 0xFFFF), (long)ev->a, ev->c / 1000.0f);
+    return ESP_LOG_INFO;
+  case TRACE_LOST:
+    snprintf(line, len, "%ld events lost", (long)ev->a);
+    return ESP_LOG_WARN;
+  default:
+    snprintf(line, len, "unknown event %d", ev->type);
+    return ESP_LOG_WARN;
+  }
+}
@@ -0,0 +1,182 @@
+#include "transcript.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "freertos/task.h"
+
+#include "static_alloc.h"
+#include "storage.h"
+#include "transcript_log.h"
+
+static const char *TAG = "TRANSCRIPT";
+
+// Room for text waiting for the writer, a couple of batches
+#define TRANSCRIPT_STREAM_LEN (2 * TRANSCRIPT_BATCH)
+
+static storage_t storage;
+static transcript_log_t tlog;
+#ifdef CONFIG_STATIC_MEMORY
+// page index, the partition in partitions.csv has 144 sectors
+#define TRANSCRIPT_MAX_PAGES (160)
+static transcript_index_entry_t tlog_index[TRANSCRIPT_MAX_PAGES];
+#endif
+// guards tlog, the writer task appends while other tasks read
+static SemaphoreHandle_t log_mutex = NULL;
+// the writer task mounts the log before it takes any text, readers wait for it
+#define MOUNT_DONE (1 << 0)
+#define MOUNT_OK (1 << 1)
+static EventGroupHandle_t mount_state = NULL;
+static StreamBufferHandle_t stream = NULL;
+static uint32_t dropped = 0;
+// end of the log at mount, the writer takes no text before that
+static uint64_t boot_offset = 0;
+
+static uint32_t now_ms(void) { return (uint32_t)(esp_timer_get_time() / 1000); }
+
+static void write_batch(const char *batch, size_t len) {
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  esp_err_t err = transcript_log_append(&tlog, batch, len, now_ms());
+  xSemaphoreGive(log_mutex);
+
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Append failed: %s", esp_err_to_name(err));
+  }
+}
+
+// scanning the page headers takes a while on a big partition, it runs here and doesn't hold up the boot
+static bool mount(void) {
+#ifdef CONFIG_STATIC_MEMORY
+  esp_err_t err = transcript_log_mount_static(&tlog, &storage, tlog_index, TRANSCRIPT_MAX_PAGES);
+#else
+  esp_err_t err = transcript_log_mount(&tlog, &storage);
+#endif
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Mount failed: %s", esp_err_to_name(err));
+    xEventGroupSetBits(mount_state, MOUNT_DONE);
+    return false;
+  }
+
+  boot_offset = transcript_log_end(&tlog);
+  ESP_LOGI(TAG, "Boot %" PRIu32 ", %" PRIu64 "..%" PRIu64, tlog.boot, transcript_log_begin(&tlog), boot_offset);
+  xEventGroupSetBits(mount_state, MOUNT_DONE | MOUNT_OK);
+  return true;
+}
+
+static bool mounted(void) {
+  return mount_state != NULL &&
+         (xEventGroupWaitBits(mount_state, MOUNT_DONE, pdFALSE, pdTRUE, portMAX_DELAY) & MOUNT_OK) != 0;
+}
+
+static void transcript_task(void *pvParameters) {
+  static char batch[TRANSCRIPT_BATCH];
+  size_t fill = 0;
+  TickType_t first = 0;
+
+  if (!mount()) {
+    // text queued so far stays in the stream buffer, transcript_append stops adding more
+    vTaskDelete(NULL);
+  }
+
+  while (1) {
+    TickType_t wait = portMAX_DELAY;
+    if (fill > 0) {
+      TickType_t age = xTaskGetTickCount() - first;
+      wait = age < pdMS_TO_TICKS(TRANSCRIPT_FLUSH_MS) ? pdMS_TO_TICKS(TRANSCRIPT_FLUSH_MS) - age : 0;
+    }
+
+    size_t n = xStreamBufferReceive(stream, batch + fill, sizeof(batch) - fill, wait);
+    if (n > 0 && fill == 0) {
+      first = xTaskGetTickCount();
+    }
+    fill += n;
+
+    if (fill == sizeof(batch) || (fill > 0 && xTaskGetTickCount() - first >= pdMS_TO_TICKS(TRANSCRIPT_FLUSH_MS))) {
+      write_batch(batch, fill);
+      ESP_LOGD(TAG, "Wrote %u bytes, %" PRIu32 " dropped", (unsigned)fill, dropped);
+      fill = 0;
+    }
+  }
+}
+
+esp_err_t transcript_init(void) {
+  esp_err_t err = storage_partition_open(&storage, TRANSCRIPT_PARTITION);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  log_mutex = STATIC_MUTEX_CREATE();
+  mount_state = STATIC_EVENT_GROUP_CREATE();
+  stream = STATIC_STREAM_BUFFER_CREATE(TRANSCRIPT_STREAM_LEN, 1);
+  if (log_mutex == NULL || mount_state == NULL || stream == NULL) {
+    log_mutex = NULL;
+    mount_state = NULL;
+    stream = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  if (STATIC_TASK_CREATE(transcript_task, "Transcript", 3072, NULL, tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create transcript task");
+    log_mutex = NULL;
+    mount_state = NULL;
+    stream = NULL;
+    return ESP_ERR_INVALID_STATE;
+  }
+  return ESP_OK;
+}
+
+void transcript_append(const char *text, size_t len) {
+  if (stream == NULL) {
+    return;
+  }
+  EventBits_t state = xEventGroupGetBits(mount_state);
+  if ((state & MOUNT_DONE) && !(state & MOUNT_OK)) {
+    return;
+  }
+
+  // single writer (the decoder task), no lock needed
+  size_t n = xStreamBufferSend(stream, text, len, 0);
+  dropped += len - n;
+}
+
+void transcript_get_range(uint64_t *begin, uint64_t *end) {
+  *begin = *end = 0;
+  if (!mounted()) {
+    return;
+  }
+
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  *begin = transcript_log_begin(&tlog);
+  *end = transcript_log_end(&tlog);
+  xSemaphoreGive(log_mutex);
+}
+
+uint64_t transcript_boot_offset(void) { return mounted() ? boot_offset : 0; }
+
+uint64_t transcript_find(uint32_t boot, uint32_t time_ms) {
+  if (!mounted()) {
+    return 0;
+  }
+
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  uint64_t offset = transcript_log_find(&tlog, boot, time_ms);
+  xSemaphoreGive(log_mutex);
+  return offset;
+}
+
+size_t transcript_read(uint64_t *offset, char *buf, size_t len) {
+  if (!mounted()) {
+    return 0;
+  }
+
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  size_t n = transcript_log_read(&tlog, offset, buf, len);
+  xSemaphoreGive(log_mutex);
+  return n;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file transcript.h
+ * @brief Persistent decoded text, kept in the "transcript" flash partition (see partitions.csv).
+ *
+ * The decoder hands text over through a stream buffer without blocking. A low priority writer task
+ * collects it into batches and appends them to the transcript_log, so flash writes and sector erases
+ * never stall decoding. Text that arrives while the stream buffer is full is dropped and counted.
+ */
+#ifndef TRANSCRIPT_H_
+#define TRANSCRIPT_H_
+
+#include <esp_err.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Partition label
+#define TRANSCRIPT_PARTITION "transcript"
+// Text is written once this much is collected...
+#define TRANSCRIPT_BATCH (512)
+// ...or when the oldest unwritten text is this old, milliseconds
+#define TRANSCRIPT_FLUSH_MS (10000)
+
+/**
+ * @brief Opens the partition and starts the writer task, which mounts the log in the background.
+ *
+ * Text appended before the mount is done waits in the stream buffer, the read functions wait for the mount.
+ *
+ * @return ESP_ERR_NOT_FOUND without the partition, transcript_append is a no-op then
+ */
+esp_err_t transcript_init(void);
+
+/** Queues text for writing, never blocks. */
+void transcript_append(const char *text, size_t len);
+
+/** @return logical offsets of the oldest text and just past the newest written text */
+void transcript_get_range(uint64_t *begin, uint64_t *end);
+
+/** @return logical offset where the text of this boot starts, waits for the mount */
+uint64_t transcript_boot_offset(void);
+
+/** @return logical offset of the text written around the given uptime of the given boot */
+uint64_t transcript_find(uint32_t boot, uint32_t time_ms);
+
+/**
+ * @brief Reads written text, safe to call from any task.
+ *
+ * @param[in,out] offset logical offset, advanced past the text read
+ * @return number of bytes read, 0 at the end
+ */
+size_t transcript_read(uint64_t *offset, char *buf, size_t len);
+
+#endif // TRANSCRIPT_H_
@@ -0,0 +1,281 @@
+#include "transcript_log.h"
+
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crc32.h"
+
+static const char *TAG = "TLOG";
+
+static uint32_t header_crc(const transcript_page_header_t *h) {
+  return crc32_update(0, h, offsetof(transcript_page_header_t, crc));
+}
+
+static size_t page_addr(const transcript_log_t *log, uint32_t seq) {
+  return (size_t)(seq % log->pages) * log->page_size;
+}
+
+// text in the page ends at the first erased byte, text never contains 0xFF
+static esp_err_t find_fill(transcript_log_t *log, uint32_t seq, uint32_t *fill) {
+  size_t text = page_addr(log, seq) + sizeof(transcript_page_header_t);
+  uint32_t lo = 0;
+  uint32_t hi = log->payload;
+
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    uint8_t b;
+    esp_err_t err = storage_read(log->storage, text + mid, &b, 1);
+    if (err != ESP_OK) {
+      return err;
+    }
+    if (b == 0xFF) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+
+  *fill = lo;
+  return ESP_OK;
+}
+
+// index has max_pages entries, allocated here if NULL
+static esp_err_t mount(transcript_log_t *log, storage_t *storage, transcript_index_entry_t *index, uint32_t max_pages) {
+  memset(log, 0, sizeof(*log));
+  log->storage = storage;
+  log->page_size = storage->erase_size;
+  log->pages = storage->size / storage->erase_size;
+  log->payload = log->page_size - sizeof(transcript_page_header_t);
+  log->empty = true;
+
+  if (log->pages < 2 || log->page_size <= sizeof(transcript_page_header_t)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  if (index != NULL) {
+    if (log->pages > max_pages) {
+      ESP_LOGE(TAG, "%" PRIu32 " pages, index has room for %" PRIu32, log->pages, max_pages);
+      return ESP_ERR_NO_MEM;
+    }
+    memset(index, 0, log->pages * sizeof(transcript_index_entry_t));
+    log->index = index;
+  } else {
+    log->index = calloc(log->pages, sizeof(transcript_index_entry_t));
+    if (log->index == NULL) {
+      return ESP_ERR_NO_MEM;
+    }
+    log->owns_index = true;
+  }
+
+  uint32_t last_boot = 0;
+  for (uint32_t slot = 0; slot < log->pages; slot++) {
+    transcript_page_header_t h;
+    esp_err_t err = storage_read(storage, (size_t)slot * log->page_size, &h, sizeof(h));
+    if (err != ESP_OK) {
+      transcript_log_unmount(log);
+      return err;
+    }
+
+    // erased, torn or foreign pages are left out of the index
+    if (h.magic != TRANSCRIPT_MAGIC || h.crc != header_crc(&h) || h.seq % log->pages != slot) {
+      continue;
+    }
+
+    log->index[slot] = (transcript_index_entry_t){.seq = h.seq, .boot = h.boot, .time_ms = h.time_ms, .valid = true};
+    if (log->empty || h.seq > log->head_seq) {
+      log->head_seq = h.seq;
+    }
+    if (log->empty || h.seq < log->tail_seq) {
+      log->tail_seq = h.seq;
+    }
+    if (log->empty || h.boot > last_boot) {
+      last_boot = h.boot;
+    }
+    log->empty = false;
+  }
+
+  if (!log->empty) {
+    log->boot = last_boot + 1;
+    esp_err_t err = find_fill(log, log->head_seq, &log->head_fill);
+    if (err != ESP_OK) {
+      transcript_log_unmount(log);
+      return err;
+    }
+  }
+
+  ESP_LOGI(TAG, "%" PRIu32 " pages, seq %" PRIu32 "..%" PRIu32 ", boot %" PRIu32, log->pages, log->tail_seq,
+           log->head_seq, log->boot);
+  return ESP_OK;
+}
+
+esp_err_t transcript_log_mount(transcript_log_t *log, storage_t *storage) { return mount(log, storage, NULL, 0); }
+
+esp_err_t transcript_log_mount_static(transcript_log_t *log, storage_t *storage, transcript_index_entry_t *index,
+                                      uint32_t max_pages) {
+  return index != NULL ? mount(log, storage, index, max_pages) : ESP_ERR_INVALID_ARG;
+}
+
+void transcript_log_unmount(transcript_log_t *log) {
+  if (log->owns_index) {
+    free(log->index);
+  }
+  log->index = NULL;
+  log->empty = true;
+}
+
+// erases the oldest page and starts a new one, the previous boot's last page is never reused
+static esp_err_t start_page(transcript_log_t *log, uint32_t now_ms) {
+  uint32_t seq = log->empty ? 0 : log->head_seq + 1;
+  size_t addr = page_addr(log, seq);
+  transcript_index_entry_t *e = &log->index[seq % log->pages];
+
+  e->valid = false;
+  esp_err_t err = storage_erase(log->storage, addr, log->page_size);
+  if (err != ESP_OK) {
+    return err;
+  }
+  log->erases++;
+
+  transcript_page_header_t h = {.magic = TRANSCRIPT_MAGIC, .seq = seq, .boot = log->boot, .time_ms = now_ms};
+  h.crc = header_crc(&h);
+  err = storage_write(log->storage, addr, &h, sizeof(h));
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  *e = (transcript_index_entry_t){.seq = seq, .boot = log->boot, .time_ms = now_ms, .valid = true};
+  if (log->empty) {
+    log->tail_seq = seq;
+  } else if (seq - log->tail_seq >= log->pages) {
+    log->tail_seq = seq - log->pages + 1;
+  }
+  log->empty = false;
+  log->head_seq = seq;
+  log->head_fill = 0;
+  log->page_open = true;
+  return ESP_OK;
+}
+
+esp_err_t transcript_log_append(transcript_log_t *log, const char *text, size_t len, uint32_t now_ms) {
+  if (log->index == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  while (len > 0) {
+    if (!log->page_open || log->head_fill >= log->payload) {
+      esp_err_t err = start_page(log, now_ms);
+      if (err != ESP_OK) {
+        return err;
+      }
+    }
+
+    size_t n = log->payload - log->head_fill;
+    if (n > len) {
+      n = len;
+    }
+
+    // 0xFF would read as the end of text
+    char chunk[64];
+    const char *src = text;
+    if (memchr(text, 0xFF, n) != NULL) {
+      if (n > sizeof(chunk)) {
+        n = sizeof(chunk);
+      }
+      for (size_t i = 0; i < n; i++) {
+        chunk[i] = ((uint8_t)text[i] == 0xFF) ? '?' : text[i];
+      }
+      src = chunk;
+    }
+
+    size_t addr = page_addr(log, log->head_seq) + sizeof(transcript_page_header_t) + log->head_fill;
+    esp_err_t err = storage_write(log->storage, addr, src, n);
+    if (err != ESP_OK) {
+      return err;
+    }
+
+    log->head_fill += n;
+    text += n;
+    len -= n;
+  }
+
+  return ESP_OK;
+}
+
+uint64_t transcript_log_begin(const transcript_log_t *log) {
+  return log->empty ? 0 : (uint64_t)log->tail_seq * log->payload;
+}
+
+uint64_t transcript_log_end(const transcript_log_t *log) {
+  return log->empty ? 0 : (uint64_t)log->head_seq * log->payload + log->head_fill;
+}
+
+uint64_t transcript_log_find(const transcript_log_t *log, uint32_t boot, uint32_t time_ms) {
+  if (log->empty) {
+    return 0;
+  }
+
+  // headers are in RAM, newest first
+  for (uint32_t seq = log->head_seq;; seq--) {
+    const transcript_index_entry_t *e = &log->index[seq % log->pages];
+    if (e->valid && e->seq == seq && (e->boot < boot || (e->boot == boot && e->time_ms <= time_ms))) {
+      return (uint64_t)seq * log->payload;
+    }
+    if (seq == log->tail_seq) {
+      break;
+    }
+  }
+  return transcript_log_begin(log);
+}
+
+size_t transcript_log_read(const transcript_log_t *log, uint64_t *offset, char *buf, size_t len) {
+  uint64_t end = transcript_log_end(log);
+  size_t done = 0;
+
+  if (log->index == NULL || log->empty) {
+    return 0;
+  }
+  if (*offset < transcript_log_begin(log)) {
+    *offset = transcript_log_begin(log);
+  }
+
+  while (done < len && *offset < end) {
+    uint32_t seq = (uint32_t)(*offset / log->payload);
+    uint32_t pos = (uint32_t)(*offset % log->payload);
+    uint64_t next_page = (uint64_t)(seq + 1) * log->payload;
+    const transcript_index_entry_t *e = &log->index[seq % log->pages];
+
+    if (!e->valid || e->seq != seq) {
+      *offset = next_page;
+      continue;
+    }
+
+    size_t n = log->payload - pos;
+    if (n > len - done) {
+      n = len - done;
+    }
+    if (*offset + n > end) {
+      n = (size_t)(end - *offset);
+    }
+
+    size_t addr = page_addr(log, seq) + sizeof(transcript_page_header_t) + pos;
+    if (storage_read(log->storage, addr, buf + done, n) != ESP_OK) {
+      ESP_LOGW(TAG, "Read failed at %" PRIu64, *offset);
+      break;
+    }
+
+    // a page from an earlier boot ends at its first erased byte
+    const char *ff = memchr(buf + done, 0xFF, n);
+    if (ff != NULL) {
+      done += ff - (buf + done);
+      *offset = next_page;
+    } else {
+      done += n;
+      *offset += n;
+    }
+  }
+
+  return done;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file transcript_log.h
+ * @brief Append-only decoded text log on top of a storage_t, platform free.
+ *
+ * The storage is a ring of pages, one erase sector each, used round robin so every sector is erased
+ * once per pass (even wear). A page starts with a header (sequence number, boot number, uptime) and
+ * is followed by text, the end of text is the first erased (0xFF) byte. Text is addressed by a logical
+ * offset, seq * payload + position in the page, which never wraps. A RAM index of page headers,
+ * read once at mount, maps offsets and times to pages without touching flash.
+ *
+ * Not thread safe, see transcript.h for the asynchronous device wrapper.
+ */
+#ifndef TRANSCRIPT_LOG_H_
+#define TRANSCRIPT_LOG_H_
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "storage.h"
+
+#define TRANSCRIPT_MAGIC (0x54584D43) // "CMXT"
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;     // page sequence number, the page lives in slot seq % pages
+  uint32_t boot;    // boot number the page was written in
+  uint32_t time_ms; // uptime when the page was started
+  uint32_t crc;     // of the fields above
+} transcript_page_header_t;
+
+// RAM copy of a page header
+typedef struct {
+  uint32_t seq;
+  uint32_t boot;
+  uint32_t time_ms;
+  bool valid;
+} transcript_index_entry_t;
+
+typedef struct {
+  storage_t *storage;
+  uint32_t pages;                  // number of pages (sectors)
+  uint32_t page_size;              // bytes, storage erase size
+  uint32_t payload;                // text bytes per page
+  transcript_index_entry_t *index; // one entry per slot
+  bool owns_index;                 // index allocated by transcript_log_mount()
+  bool empty;                      // no valid page yet
+  uint32_t head_seq;               // newest page
+  uint32_t tail_seq;               // oldest page
+  uint32_t head_fill;              // text bytes in the newest page
+  bool page_open;                  // newest page was started by this mount, appends go to a new page otherwise
+  uint32_t boot;                   // boot number of this mount
+  uint32_t erases;                 // sectors erased since mount
+} transcript_log_t;
+
+/**
+ * @brief Reads the page headers and builds the index, the first append starts a new page.
+ *
+ * @return ESP_ERR_NO_MEM if the index can't be allocated, ESP_ERR_INVALID_SIZE if storage has less than 2 pages
+ */
+esp_err_t transcript_log_mount(transcript_log_t *log, storage_t *storage);
+
+/**
+ * @brief Same as transcript_log_mount() with a caller provided index of max_pages entries, nothing is allocated.
+ *
+ * @return ESP_ERR_NO_MEM if storage has more than max_pages pages
+ */
+esp_err_t transcript_log_mount_static(transcript_log_t *log, storage_t *storage, transcript_index_entry_t *index,
+                                      uint32_t max_pages);
+
+void transcript_log_unmount(transcript_log_t *log);
+
+/**
+ * @brief Appends text, erasing the oldest page when a new one is needed.
+ *
+ * Blocks for flash writes and erases, batch text and call from a low priority task.
+ * 0xFF bytes (never valid UTF-8) are stored as '?'.
+ *
+ * @param now_ms uptime, stored in the header of a new page
+ */
+esp_err_t transcript_log_append(transcript_log_t *log, const char *text, size_t len, uint32_t now_ms);
+
+/** @return logical offset of the oldest text */
+uint64_t transcript_log_begin(const transcript_log_t *log);
+
+/** @return logical offset just past the newest text */
+uint64_t transcript_log_end(const transcript_log_t *log);
+
+/**
+ * @brief Logical offset of the page that was current at the given time.
+ *
+ * @return start of the newest page started at or before (boot, time_ms), transcript_log_begin() if none
+ */
+uint64_t transcript_log_find(const transcript_log_t *log, uint32_t boot, uint32_t time_ms);
+
+/**
+ * @brief Reads text, skipping unused page tails and pages that are gone.
+ *
+ * @param[in,out] offset logical offset to read from, advanced past the text read
+ * @return number of bytes read into buf, 0 at the end of the log
+ */
+size_t transcript_log_read(const transcript_log_t *log, uint64_t *offset, char *buf, size_t len);
+
+#endif // TRANSCRIPT_LOG_H_
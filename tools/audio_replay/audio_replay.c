@@ -0,0 +1,285 @@
+// Replays an audio capture (console "audio" command) through the DSP chain and the decoder on a host.
+//
+//   audio_replay [-e] [-w out.wav] [-f bpf_hz] [-Q bpf_q] [-c lpf_hz] capture.txt|capture.aud
+//
+// Each block continues from the chain state the device saved at its start. With the device filters the
+// edges of every block are checked against the device's crc and the chain state against the next block,
+// any difference means the host build does not match the device. -f/-Q/-c replace the filters for tuning,
+// checks are off then. Decoded text goes to stdout, edges (-e) and the check summary to stderr.
+
+#include <ctype.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_capture.h"
+#include "crc32.h"
+#include "dsp_chain.h"
+#include "host_stubs.h"
+#include "morse_core.h"
+
+typedef struct {
+  uint8_t *data;
+  size_t len;
+  size_t cap;
+} bytes_t;
+
+static void append(bytes_t *b, const uint8_t *data, size_t len) {
+  if (b->len + len > b->cap) {
+    b->cap = (b->len + len) * 2;
+    b->data = realloc(b->data, b->cap);
+    if (!b->data) {
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+    }
+  }
+  memcpy(b->data + b->len, data, len);
+  b->len += len;
+}
+
+static int hex_nibble(int c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c = tolower(c);
+  return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+}
+
+// "AUD <hex>" lines are the binary dump split up, anything before "AUD " (log prefixes) is ignored
+static bool load(const char *path, bytes_t *b) {
+  FILE *f = fopen(path, "rb");
+  static char line[4096];
+  uint32_t magic = 0;
+
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  if (fread(&magic, sizeof(magic), 1, f) == 1 && magic == AUDIO_CAPTURE_MAGIC) {
+    rewind(f);
+    size_t n;
+    while ((n = fread(line, 1, sizeof(line), f)) > 0) {
+      append(b, (const uint8_t *)line, n);
+    }
+  } else {
+    rewind(f);
+    while (fgets(line, sizeof(line), f)) {
+      const char *p = strstr(line, "AUD ");
+      for (p = p ? p + 4 : ""; hex_nibble(p[0]) >= 0 && hex_nibble(p[1]) >= 0; p += 2) {
+        uint8_t v = (uint8_t)(hex_nibble(p[0]) << 4 | hex_nibble(p[1]));
+        append(b, &v, 1);
+      }
+    }
+  }
+  fclose(f);
+
+  if (b->len < sizeof(audio_capture_header_t) || memcmp(b->data, &(uint32_t){AUDIO_CAPTURE_MAGIC}, 4) != 0) {
+    fprintf(stderr, "%s: no audio capture header\n", path);
+    return false;
+  }
+  return true;
+}
+
+// esp-dsp dsps_biquad_gen_bpf_f32 / dsps_biquad_gen_lpf_f32, f relative to the sample rate
+static void gen_biquad(float *coeffs, bool bpf, float f, float q) {
+  float w0 = 2 * M_PI * f;
+  float c = cosf(w0);
+  float s = sinf(w0);
+  float alpha = s / (2 * q);
+  float b0 = bpf ? s / 2 : (1 - c) / 2;
+  float b1 = bpf ? 0 : 1 - c;
+  float b2 = bpf ? -b0 : b0;
+  float a0 = 1 + alpha;
+
+  coeffs[0] = b0 / a0;
+  coeffs[1] = b1 / a0;
+  coeffs[2] = b2 / a0;
+  coeffs[3] = -2 * c / a0;
+  coeffs[4] = (1 - alpha) / a0;
+}
+
+static bool same_state(const dsp_chain_state_t *a, const dsp_chain_state_t *b) {
+  return memcmp(a->w_bpf, b->w_bpf, sizeof(a->w_bpf)) == 0 && memcmp(a->w_lpf, b->w_lpf, sizeof(a->w_lpf)) == 0 &&
+         memcmp(&a->smin, &b->smin, sizeof(float)) == 0 && memcmp(&a->smax, &b->smax, sizeof(float)) == 0 &&
+         memcmp(&a->nb.avg, &b->nb.avg, sizeof(float)) == 0 && a->nb.enabled == b->nb.enabled &&
+         a->nb.hold == b->nb.hold &&
+         memcmp(&a->sq.floor, &b->sq.floor, sizeof(float)) == 0 &&
+         memcmp(&a->sq.noise_ratio, &b->sq.noise_ratio, sizeof(float)) == 0 && a->sq.open == b->sq.open &&
+         a->sq.hang == b->sq.hang &&
+         a->ook.below_threshold == b->ook.below_threshold && a->ook.samples_in_state == b->ook.samples_in_state &&
+         memcmp(a->ook.level, b->ook.level, sizeof(a->ook.level)) == 0 &&
+         memcmp(a->ook.spread, b->ook.spread, sizeof(a->ook.spread)) == 0 && a->ook.prev == b->ook.prev;
+}
+
+typedef struct {
+  uint32_t crc;
+  uint32_t sample_rate;
+  bool print;
+} edge_ctx_t;
+
+static void on_edge(int32_t e, float range, uint64_t sample, void *ctx) {
+  edge_ctx_t *c = (edge_ctx_t *)ctx;
+  c->crc = crc32_update(c->crc, &e, sizeof(e));
+  if (c->print) {
+    fprintf(stderr, "%9.4f %7d %g\n", (double)sample / c->sample_rate, e, range);
+  }
+  morse_edge_t edge = {.e = e, .sample = sample};
+  morse_core_edge(&edge);
+}
+
+static void write_wav(FILE *f, const int16_t *samples, uint32_t n, uint32_t sample_rate) {
+  uint32_t data = n * sizeof(int16_t);
+  uint32_t header[] = {0x46464952, 36 + data, 0x45564157, 0x20746d66, 16, 0x00010001, sample_rate,
+                       2 * sample_rate, 0x00100002, 0x61746164, data};
+  fwrite(header, sizeof(header), 1, f);
+  fwrite(samples, sizeof(int16_t), n, f);
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: audio_replay [-e] [-w out.wav] [-f bpf_hz] [-Q bpf_q] [-c lpf_hz] capture\n"
+                  "  -e  print edges: time (s), duration (samples), range\n"
+                  "  -w  write the raw input as a mono wav file\n"
+                  "  -f  band-pass center, Hz\n"
+                  "  -Q  band-pass Q\n"
+                  "  -c  envelope low-pass cutoff, Hz\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  const char *path = NULL;
+  const char *wav = NULL;
+  float bpf_hz = 0;
+  float bpf_q = 0;
+  float lpf_hz = 0;
+  bool print_edges = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-e") == 0) {
+      print_edges = true;
+    } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+      wav = argv[++i];
+    } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      bpf_hz = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-Q") == 0 && i + 1 < argc) {
+      bpf_q = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      lpf_hz = atof(argv[++i]);
+    } else if (argv[i][0] != '-' && !path) {
+      path = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!path) {
+    usage();
+  }
+
+  bytes_t b = {0};
+  if (!load(path, &b)) {
+    return 1;
+  }
+
+  audio_capture_header_t h;
+  memcpy(&h, b.data, sizeof(h));
+  size_t pos = sizeof(h);
+
+  // the device settings (see params.h), unless the filters are replaced
+  bool tuned = bpf_hz > 0 || bpf_q > 0 || lpf_hz > 0;
+  if (bpf_hz > 0 || bpf_q > 0) {
+    gen_biquad(h.params.coeffs_bpf, true, (bpf_hz > 0 ? bpf_hz : 750.0f) / h.sample_rate, bpf_q > 0 ? bpf_q : 20.0f);
+  }
+  if (lpf_hz > 0) {
+    gen_biquad(h.params.coeffs_lpf, false, lpf_hz / h.sample_rate, 0.707f);
+  }
+
+  dsp_chain_t chain;
+  dsp_chain_init(&chain, h.params.coeffs_bpf, h.params.coeffs_lpf);
+  dsp_chain_set_params(&chain, &h.params);
+  morse_core_init();
+
+  static int16_t samples[DSP_CHAIN_MAX_SAMPLES];
+  int16_t *all = NULL;
+  uint32_t n_all = 0;
+  uint32_t first = 0;
+  uint32_t next = 0;
+  uint32_t crc_ok = 0;
+  uint32_t state_ok = 0;
+  uint32_t gaps = 0;
+  edge_ctx_t ctx = {.sample_rate = h.sample_rate, .print = print_edges};
+
+  for (uint32_t i = 0; i < h.blocks; i++) {
+    audio_capture_block_t blk;
+    if (pos + sizeof(blk) > b.len) {
+      fprintf(stderr, "truncated at block %u\n", i);
+      break;
+    }
+    memcpy(&blk, b.data + pos, sizeof(blk));
+    pos += sizeof(blk);
+    if (blk.len > DSP_CHAIN_MAX_SAMPLES || pos + blk.len * sizeof(int16_t) > b.len) {
+      fprintf(stderr, "truncated at block %u\n", i);
+      break;
+    }
+    memcpy(samples, b.data + pos, blk.len * sizeof(int16_t));
+    pos += blk.len * sizeof(int16_t);
+
+    if (i == 0) {
+      first = blk.start;
+    }
+    if (i == 0 || blk.start != next) {
+      // first block or samples missing, continue from the device state
+      gaps += i > 0;
+      chain.s = blk.state;
+    } else if (same_state(&chain.s, &blk.state)) {
+      state_ok++;
+    } else if (!tuned) {
+      fprintf(stderr, "block %u: chain state differs from the device\n", i);
+      chain.s = blk.state;
+    }
+    next = blk.start + blk.len;
+
+    all = realloc(all, (n_all + blk.len) * sizeof(int16_t));
+    memcpy(all + n_all, samples, blk.len * sizeof(int16_t));
+    n_all += blk.len;
+
+    ctx.crc = 0;
+    // sample indexes relative to the snapshot
+    dsp_chain_process(&chain, samples, 1, blk.len, blk.start - first, on_edge, &ctx);
+    if (ctx.crc == blk.edges_crc) {
+      crc_ok++;
+    } else if (!tuned) {
+      fprintf(stderr, "block %u: edges differ from the device\n", i);
+    }
+  }
+  morse_core_idle();
+  if (!host_quiet) {
+    putchar('\n');
+  }
+
+  fprintf(stderr, "%u samples (%.2f s) in %u blocks", n_all, (double)n_all / h.sample_rate, h.blocks);
+  if (h.trigger != AUDIO_CAPTURE_NO_TRIGGER) {
+    fprintf(stderr, ", decode failure at %.3f s", (double)(h.trigger - first) / h.sample_rate);
+  }
+  if (tuned) {
+    fprintf(stderr, ", filters replaced, not checked\n");
+  } else {
+    fprintf(stderr, "\nedges match in %u/%u blocks, state in %u/%u, %u gaps\n", crc_ok, h.blocks, state_ok,
+            h.blocks > gaps + 1 ? h.blocks - gaps - 1 : 0, gaps);
+  }
+
+  if (wav) {
+    FILE *f = fopen(wav, "wb");
+    if (!f) {
+      perror(wav);
+      return 1;
+    }
+    write_wav(f, all, n_all, h.sample_rate);
+    fclose(f);
+  }
+
+  free(all);
+  free(b.data);
+  return tuned || crc_ok == h.blocks ? 0 : 1;
+}
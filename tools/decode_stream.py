@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Parses the binary decode stream (CONFIG_DECODE_STREAM, frame format in main/decode_frame.h).
+
+As a library, feed bytes as they arrive and take the frames out:
+
+    parser = Parser()
+    for frame in parser.feed(data):
+        log(frame.channel, frame.time_ms, frame.text)
+
+Characters come as Frame as soon as they are decided. Once a word ends the device decodes it again and a Word
+follows, its text replaces the last word.replaces characters of the channel. Loggers that only want the final
+transcript take the words (with re-decoding off no words come, the characters are final).
+
+Noise and partial frames are skipped: the parser resyncs on the next sync bytes whose CRC checks.
+parser.crc_errors counts rejected frames, parser.lost the characters missing from sequence number gaps.
+
+As a tool, prints one line per character and word, or the corrected text with -t. Reading a serial port needs pyserial:
+
+    tools/decode_stream.py /dev/ttyUSB1              # 921600 baud
+    tools/decode_stream.py -t frames.bin             # edge_replay -o output
+"""
+
+import argparse
+import collections
+import struct
+import sys
+import zlib
+
+SYNC = b"\xa5\x5a"
+TYPE_CHAR = 1
+TYPE_WORD = 2
+
+WORD_START = 1 << 0
+UNDECODABLE = 1 << 1
+SOFT = 1 << 2
+
+# version, type, length
+HEADER = struct.Struct("<BBB")
+# seq, channel, flags, confidence, wpm_x10, key_ms, time_ms, text_len
+CHAR_FIXED = struct.Struct("<HBBBHIIB")
+# seq, channel, flags, replaces, key_ms, time_ms, text_len
+WORD_FIXED = struct.Struct("<HBBBIIB")
+
+Frame = collections.namedtuple(
+    "Frame", "version seq channel word_start undecodable soft confidence wpm key_ms time_ms text")
+Word = collections.namedtuple("Word", "version seq channel word_start replaces key_ms time_ms text")
+
+
+class Parser:
+    def __init__(self):
+        self.buf = bytearray()
+        self.crc_errors = 0
+        self.lost = 0
+        self.last_seq = {}
+
+    def feed(self, data):
+        """Yields the complete frames in data and the bytes left over from earlier calls."""
+        self.buf += data
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                # keep a trailing first sync byte
+                del self.buf[:max(0, len(self.buf) - 1)]
+                return
+            del self.buf[:start]
+            if len(self.buf) < len(SYNC) + HEADER.size:
+                return
+            version, ftype, length = HEADER.unpack_from(self.buf, len(SYNC))
+            end = len(SYNC) + HEADER.size + length
+            if len(self.buf) < end + 4:
+                return
+            (crc,) = struct.unpack_from("<I", self.buf, end)
+            if zlib.crc32(self.buf[len(SYNC):end]) != crc:
+                # not a frame after all, look for the next sync
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+            payload = bytes(self.buf[len(SYNC) + HEADER.size:end])
+            del self.buf[:end + 4]
+            if ftype == TYPE_CHAR and length >= CHAR_FIXED.size:
+                yield self._char(version, payload)
+            elif ftype == TYPE_WORD and length >= WORD_FIXED.size:
+                yield self._word(version, payload)
+
+    def _count(self, seq, channel):
+        last = self.last_seq.get(channel)
+        if last is not None:
+            self.lost += (seq - last - 1) & 0xFFFF
+        self.last_seq[channel] = seq
+
+    def _char(self, version, payload):
+        seq, channel, flags, confidence, wpm_x10, key_ms, time_ms, text_len = CHAR_FIXED.unpack_from(payload)
+        self._count(seq, channel)
+        # fields added by later versions follow the text
+        text = payload[CHAR_FIXED.size:CHAR_FIXED.size + text_len]
+        return Frame(version, seq, channel, bool(flags & WORD_START), bool(flags & UNDECODABLE), bool(flags & SOFT),
+                     confidence / 255, wpm_x10 / 10, key_ms, time_ms, text.decode("utf-8", "replace"))
+
+    def _word(self, version, payload):
+        seq, channel, flags, replaces, key_ms, time_ms, text_len = WORD_FIXED.unpack_from(payload)
+        self._count(seq, channel)
+        text = payload[WORD_FIXED.size:WORD_FIXED.size + text_len]
+        return Word(version, seq, channel, bool(flags & WORD_START), replaces, key_ms, time_ms,
+                    text.decode("utf-8", "replace"))
+
+
+class Transcript:
+    """Final text of one channel: characters are held until their word comes or the next word starts."""
+
+    def __init__(self, write):
+        self.write = write
+        self.pending = []
+
+    def add(self, f):
+        if isinstance(f, Word):
+            del self.pending[max(0, len(self.pending) - f.replaces):]
+            self.flush()
+            self.write((" " if f.word_start else "") + f.text)
+            return
+        if f.word_start:
+            # no word for the previous one, re-decoding is off
+            self.flush()
+        self.pending.append((" " if f.word_start else "") + f.text)
+
+    def flush(self):
+        self.write("".join(self.pending))
+        self.pending = []
+
+
+def open_input(path, baud):
+    try:
+        return open(path, "rb", buffering=0), False
+    except OSError:
+        pass
+    import serial  # pyserial
+    return serial.Serial(path, baud, timeout=0.05), True
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("input", help="serial port or file")
+    ap.add_argument("-b", "--baud", type=int, default=921600)
+    ap.add_argument("-t", "--text", action="store_true", help="print the text only")
+    args = ap.parse_args()
+
+    src, is_serial = open_input(args.input, args.baud)
+    parser = Parser()
+    transcripts = collections.defaultdict(lambda: Transcript(sys.stdout.write))
+    try:
+        while True:
+            data = src.read(4096)
+            if not data and not is_serial:
+                break
+            for f in parser.feed(data):
+                if args.text:
+                    transcripts[f.channel].add(f)
+                elif isinstance(f, Word):
+                    print("%5d ch%d %10.3f %10.3f word %s%s (replaces %d)" %
+                          (f.seq, f.channel, f.key_ms / 1000, f.time_ms / 1000, "| " if f.word_start else "  ",
+                           f.text, f.replaces))
+                else:
+                    print("%5d ch%d %10.3f %10.3f %5.1f wpm %.2f%s %s%s" %
+                          (f.seq, f.channel, f.key_ms / 1000, f.time_ms / 1000, f.wpm, f.confidence,
+                           "?" if f.soft else " ", "| " if f.word_start else "  ", f.text))
+                sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+    if args.text:
+        for t in transcripts.values():
+            t.flush()
+        print()
+    print("%d CRC errors, %d frames lost" % (parser.crc_errors, parser.lost), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
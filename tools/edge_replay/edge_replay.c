@@ -0,0 +1,328 @@
+// Replays an OOK edge capture (console "edges" command) through the decoder on a host.
+//
+//   edge_replay [-q] [-n repeat] [-l off|correct|defer] [-o frames.bin] [-t timing.bin] capture.txt|capture.edt
+//   edge_replay [-q] [-n repeat] -s wpm              # synthetic "PARIS" edges
+//
+// Decoded text goes to stdout, edge throughput to stderr. The input is either the console output
+// ("EDT <hex>" lines, anything else is skipped) or a binary dump (edge_trace_file_header_t + blocks).
+// Idle handling is driven from the edge durations the way the decoder task times out on its queue,
+// so the output matches the device bit for bit. -o writes the frames the device sends with
+// CONFIG_DECODE_STREAM (see decode_frame.h), timed by the decision sample instead of the clock.
+// -t starts from the timing snapshot in a file laid out like the "timing" partition (timing_store.h)
+// and saves the learned timing back to it afterwards, the warm start of the device across reboots.
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "decode_frame.h"
+#include "edge_trace.h"
+#include "host_stubs.h"
+#include "morse_core.h"
+#include "storage.h"
+#include "timing_store.h"
+
+// Size of the "timing" partition in partitions.csv and the flash sector size
+#define TIMING_FILE_SIZE (0x2000)
+#define TIMING_FILE_SECTOR (0x1000)
+
+// Decoder task queue timeout, samples at the capture sample rate are converted with this
+#define IDLE_TIMEOUT_S (1)
+
+typedef struct {
+  int32_t *e;
+  size_t n;
+  size_t cap;
+  uint32_t sample_rate;
+} edges_t;
+
+static void push(edges_t *edges, int32_t e) {
+  if (edges->n == edges->cap) {
+    edges->cap = edges->cap ? 2 * edges->cap : 4096;
+    edges->e = realloc(edges->e, edges->cap * sizeof(int32_t));
+    if (!edges->e) {
+      fprintf(stderr, "out of memory\n");
+      exit(1);
+    }
+  }
+  edges->e[edges->n++] = e;
+}
+
+static void decode_block(edges_t *edges, const uint8_t *block, size_t len) {
+  edge_trace_reader_t r;
+  int32_t e;
+  float range;
+
+  edge_trace_reader_init(&r, block, len);
+  while (edge_trace_next(&r, &e, &range)) {
+    push(edges, e);
+  }
+}
+
+static int hex_nibble(int c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c = tolower(c);
+  return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+}
+
+// parses one "EDT <hex>" line, anything before "EDT " (log prefixes) is ignored
+static size_t parse_hex_line(const char *line, uint8_t *out, size_t cap) {
+  const char *p = strstr(line, "EDT ");
+  size_t n = 0;
+
+  if (!p) {
+    return 0;
+  }
+  for (p += 4; n < cap; p += 2) {
+    int hi = hex_nibble(p[0]);
+    int lo = hi < 0 ? -1 : hex_nibble(p[1]);
+    if (lo < 0) {
+      break;
+    }
+    out[n++] = (uint8_t)(hi << 4 | lo);
+  }
+  return n;
+}
+
+static bool load_text(FILE *f, edges_t *edges) {
+  static char line[4 * EDGE_TRACE_BLOCK];
+  uint8_t buf[EDGE_TRACE_BLOCK];
+  bool header = false;
+  uint32_t block_size = 0;
+
+  while (fgets(line, sizeof(line), f)) {
+    size_t n = parse_hex_line(line, buf, sizeof(buf));
+    if (n == 0) {
+      continue;
+    }
+    if (n == sizeof(edge_trace_file_header_t)) {
+      edge_trace_file_header_t h;
+      memcpy(&h, buf, sizeof(h));
+      if (h.magic == EDGE_TRACE_MAGIC) {
+        header = true;
+        block_size = h.block_size;
+        edges->sample_rate = h.sample_rate;
+        continue;
+      }
+    }
+    if (!header || n != block_size) {
+      fprintf(stderr, "skipping malformed line: %.40s...\n", line);
+      continue;
+    }
+    decode_block(edges, buf, n);
+  }
+  return header;
+}
+
+static bool load_binary(FILE *f, edges_t *edges) {
+  edge_trace_file_header_t h;
+  uint8_t buf[EDGE_TRACE_BLOCK];
+
+  if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != EDGE_TRACE_MAGIC || h.block_size != EDGE_TRACE_BLOCK) {
+    return false;
+  }
+  edges->sample_rate = h.sample_rate;
+  for (uint32_t i = 0; i < h.blocks && fread(buf, sizeof(buf), 1, f) == 1; i++) {
+    decode_block(edges, buf, sizeof(buf));
+  }
+  return true;
+}
+
+static bool load(const char *path, edges_t *edges) {
+  FILE *f = fopen(path, "rb");
+  uint32_t magic = 0;
+
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  bool binary = fread(&magic, sizeof(magic), 1, f) == 1 && magic == EDGE_TRACE_MAGIC;
+  rewind(f);
+  bool ok = binary ? load_binary(f, edges) : load_text(f, edges);
+  fclose(f);
+  if (!ok) {
+    fprintf(stderr, "%s: no edge trace header\n", path);
+  }
+  return ok;
+}
+
+// "PARIS " repeated, dit = 1.2 / wpm seconds
+static void synthesize(edges_t *edges, int wpm) {
+  static const char *const paris[] = {".--.", ".-", ".-.", "..", "..."};
+  int32_t dit = (int32_t)(1.2 * edges->sample_rate / wpm);
+
+  for (int word = 0; word < 10000; word++) {
+    for (int c = 0; c < 5; c++) {
+      for (const char *el = paris[c]; *el; el++) {
+        push(edges, *el == '-' ? -3 * dit : -dit);
+        push(edges, el[1] ? dit : (c < 4 ? 3 * dit : 7 * dit));
+      }
+    }
+  }
+}
+
+static FILE *frames_out = NULL;
+static uint16_t frames_seq = 0;
+
+static void write_frame(const morse_char_t *ch, void *ctx) {
+  uint32_t sample_rate = *(const uint32_t *)ctx;
+  uint8_t frame[DECODE_FRAME_CHAR_MAX];
+  size_t len = decode_frame_char(frame, frames_seq++, 0, ch, sample_rate,
+                                 (uint32_t)(ch->decided_sample * 1000 / sample_rate));
+  fwrite(frame, 1, len, frames_out);
+}
+
+static void write_word_frame(const morse_word_t *w, void *ctx) {
+  uint32_t sample_rate = *(const uint32_t *)ctx;
+  uint8_t frame[DECODE_FRAME_WORD_MAX];
+  size_t len = decode_frame_word(frame, frames_seq++, 0, w, sample_rate,
+                                 (uint32_t)(w->decided_sample * 1000 / sample_rate));
+  fwrite(frame, 1, len, frames_out);
+}
+
+static void replay(const edges_t *edges, uint32_t sample_rate) {
+  int32_t idle = (int32_t)(IDLE_TIMEOUT_S * sample_rate);
+  // edges are contiguous, their sample indexes are the running sum of the durations
+  morse_edge_t edge = {0};
+
+  for (size_t i = 0; i < edges->n; i++) {
+    int32_t e = edges->e[i];
+    for (int32_t t = abs(e); t >= idle; t -= idle) {
+      morse_core_idle();
+    }
+    edge.e = e;
+    edge.sample += abs(e);
+    morse_core_edge(&edge);
+  }
+  morse_core_idle();
+}
+
+static storage_t timing_file;
+static timing_store_t timing_store;
+static morse_timing_t timing;
+
+static bool timing_open(const char *path) {
+  if (storage_file_open(&timing_file, path, TIMING_FILE_SIZE, TIMING_FILE_SECTOR) != ESP_OK ||
+      timing_store_open(&timing_store, &timing_file) != ESP_OK) {
+    fprintf(stderr, "%s: can't open timing snapshots\n", path);
+    return false;
+  }
+  esp_err_t err = timing_store_load(&timing_store, &timing);
+  if (err == ESP_OK) {
+    err = morse_core_set_timing(&timing);
+  }
+  if (err != ESP_OK) {
+    fprintf(stderr, "%s: cold start, %s\n", path, esp_err_to_name(err));
+  }
+  return true;
+}
+
+static void timing_close(void) {
+  morse_core_get_timing(&timing);
+  esp_err_t err = timing_store_save(&timing_store, &timing);
+  if (err != ESP_OK) {
+    fprintf(stderr, "timing snapshot not saved: %s\n", esp_err_to_name(err));
+  }
+  storage_file_close(&timing_file);
+}
+
+static morse_lookahead_mode_t parse_mode(const char *s) {
+  if (strcmp(s, "off") == 0) {
+    return MORSE_LOOKAHEAD_OFF;
+  } else if (strcmp(s, "defer") == 0) {
+    return MORSE_LOOKAHEAD_DEFER;
+  }
+  return MORSE_LOOKAHEAD_CORRECT;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: edge_replay [-q] [-n repeat] [-l off|correct|defer] [-o frames] [-t timing] capture | -s wpm\n"
+                  "  -q  no text output, for benchmarking\n"
+                  "  -n  replay the capture this many times\n"
+                  "  -l  lookahead mode\n"
+                  "  -o  write decode stream frames to this file\n"
+                  "  -t  start from the timing snapshot in this file, save it back at the end\n"
+                  "  -s  synthetic PARIS edges at this speed instead of a capture\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  edges_t edges = {.sample_rate = 44100};
+  const char *path = NULL;
+  const char *frames_path = NULL;
+  const char *timing_path = NULL;
+  int repeat = 1;
+  int wpm = 0;
+  morse_lookahead_mode_t mode = MORSE_LOOKAHEAD_CORRECT;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-q") == 0) {
+      host_quiet = true;
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      repeat = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+      mode = parse_mode(argv[++i]);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      frames_path = argv[++i];
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      timing_path = argv[++i];
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      wpm = atoi(argv[++i]);
+    } else if (argv[i][0] != '-' && !path) {
+      path = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if ((!path) == (wpm <= 0) || repeat < 1) {
+    usage();
+  }
+
+  if (path && !load(path, &edges)) {
+    return 1;
+  }
+  if (wpm > 0) {
+    synthesize(&edges, wpm);
+  }
+
+  morse_core_init();
+  morse_core_set_lookahead_mode(mode);
+  if (timing_path && !timing_open(timing_path)) {
+    return 1;
+  }
+  if (frames_path) {
+    frames_out = fopen(frames_path, "wb");
+    if (!frames_out) {
+      perror(frames_path);
+      return 1;
+    }
+    morse_core_set_char_fn(write_frame, &edges.sample_rate);
+    morse_core_set_word_fn(write_word_frame, &edges.sample_rate);
+  }
+
+  clock_t start = clock();
+  for (int i = 0; i < repeat; i++) {
+    replay(&edges, edges.sample_rate);
+  }
+  double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  if (!host_quiet) {
+    putchar('\n');
+  }
+  double n = (double)edges.n * repeat;
+  fprintf(stderr, "%.0f edges in %.3f s, %.2f M edges/s\n", n, secs, secs > 0 ? n / secs / 1e6 : 0.0);
+  if (frames_out) {
+    fclose(frames_out);
+  }
+  if (timing_path) {
+    timing_close();
+  }
+  free(edges.e);
+  return 0;
+}
@@ -0,0 +1,200 @@
+// Runs the ES8388 init sequence (es8388_regs.c) against a register file standing in for the codec.
+//
+//   es8388_sim [-v] [-w] [-r] [-s reg] [-k khz]
+//
+// The register file increments the address after every data byte like the chip, -w and -r turn that off
+// for writes or reads to exercise the one by one fallback, -s makes a register ignore writes. -v prints
+// every transaction. Checks that the registers end up with the table values, that the writes reached
+// the chip in table order and that the table keeps the user guide power-up order (GUIDE_ORDER, written out
+// here apart from the table), and estimates the bus time against one register per write at -k kHz.
+// Exit status 0 when all checks pass.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "es8388_regs.h"
+
+// I2C frame bits: start, 7 bit address + R/W and ack, per byte 8 + ack, stop
+#define I2C_BITS_ADDR (1 + 9)
+#define I2C_BITS_BYTE (9)
+#define I2C_BITS_STOP (1)
+
+// ES8388 user guide power-up steps, the register order the table has to keep; it may add registers in between
+static const uint8_t GUIDE_ORDER[] = {
+    0x08,                                                 // 2 slave mode
+    0x02,                                                 // 3 power down DEM and STM
+    0x00, 0x01,                                           // 5, 6 play & record, analog and bias power
+    0x07, 0x05, 0x06,                                     // analog voltage, low power
+    0x2B,                                                 // 4 same LRCK
+    0x04,                                                 // 7 DAC power
+    0x0A, 0x09,                                           // 8, 9 ADC input, PGA gain
+    0x0C, 0x0D, 0x10, 0x11,                               // 10-12 ADC format, ratio, volume
+    0x12, 0x13, 0x14, 0x15, 0x16,                         // 13 ALC
+    0x03,                                                 // 14 ADC power
+    0x17, 0x18, 0x1A, 0x1B, 0x19,                         // 15-18 DAC format, ratio, volume, unmute
+    0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, // DAC output, shelving filter
+    0x25, 0x2C, 0x2D,                                     // analog stage
+    0x26, 0x27, 0x28, 0x29, 0x2A,                         // 19 mixer
+    0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34,             // 20 output volumes, references
+    0x02,                                                 // 21 power up DEM and STM
+};
+
+typedef struct {
+  uint8_t regs[256];
+  bool write_inc;
+  bool read_inc;
+  int stuck; // register that ignores writes, -1 for none
+  bool verbose;
+  // single register writes in the order they reached the chip
+  es8388_reg_t log[1024];
+  size_t n_log;
+  long bits;
+} regfile_t;
+
+static esp_err_t rf_write(void *ctx, uint8_t reg, const uint8_t *data, size_t len) {
+  regfile_t *rf = (regfile_t *)ctx;
+  // address + register + data
+  rf->bits += I2C_BITS_ADDR + I2C_BITS_BYTE * (1 + len) + I2C_BITS_STOP;
+  if (rf->verbose) {
+    printf("W %02x:", reg);
+    for (size_t i = 0; i < len; i++) {
+      printf(" %02x", data[i]);
+    }
+    printf("\n");
+  }
+  for (size_t i = 0; i < len; i++) {
+    uint8_t r = rf->write_inc ? reg + i : reg;
+    if (r != rf->stuck) {
+      rf->regs[r] = data[i];
+    }
+    if (rf->n_log < sizeof(rf->log) / sizeof(rf->log[0])) {
+      rf->log[rf->n_log++] = (es8388_reg_t){r, data[i]};
+    }
+  }
+  return ESP_OK;
+}
+
+static esp_err_t rf_read(void *ctx, uint8_t reg, uint8_t *data, size_t len) {
+  regfile_t *rf = (regfile_t *)ctx;
+  // address + register, repeated start, address + data
+  rf->bits += 2 * I2C_BITS_ADDR + I2C_BITS_BYTE * (1 + len) + I2C_BITS_STOP;
+  for (size_t i = 0; i < len; i++) {
+    data[i] = rf->regs[rf->read_inc ? (uint8_t)(reg + i) : reg];
+  }
+  if (rf->verbose) {
+    printf("R %02x: %u bytes\n", reg, (unsigned)len);
+  }
+  return ESP_OK;
+}
+
+// the log ends with the table, in order; a fallback rewrite comes after the batched attempt
+static bool in_order(const regfile_t *rf) {
+  size_t n = es8388_init_seq_len;
+  if (rf->n_log < n) {
+    return false;
+  }
+  const es8388_reg_t *last = rf->log + rf->n_log - n;
+  for (size_t i = 0; i < n; i++) {
+    if (last[i].reg != es8388_init_seq[i].reg || last[i].val != es8388_init_seq[i].val) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// GUIDE_ORDER is a subsequence of the table
+static bool guide_order(void) {
+  size_t g = 0;
+  for (size_t i = 0; i < es8388_init_seq_len && g < sizeof(GUIDE_ORDER); i++) {
+    g += es8388_init_seq[i].reg == GUIDE_ORDER[g];
+  }
+  if (g < sizeof(GUIDE_ORDER)) {
+    printf("table leaves the guide order at step register 0x%02x\n", GUIDE_ORDER[g]);
+  }
+  return g == sizeof(GUIDE_ORDER);
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: es8388_sim [-v] [-w] [-r] [-s reg] [-k khz]\n"
+                  "  -v  print every transaction\n"
+                  "  -w  no address increment on writes\n"
+                  "  -r  no address increment on reads\n"
+                  "  -s  register that ignores writes, hex\n"
+                  "  -k  bus clock, kHz (100)\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  static regfile_t rf = {.write_inc = true, .read_inc = true, .stuck = -1};
+  double khz = 100;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (arg[0] != '-' || !arg[1] || arg[2]) {
+      usage();
+    }
+    switch (arg[1]) {
+    case 'v':
+      rf.verbose = true;
+      break;
+    case 'w':
+      rf.write_inc = false;
+      break;
+    case 'r':
+      rf.read_inc = false;
+      break;
+    case 's':
+      if (i + 1 >= argc) {
+        usage();
+      }
+      rf.stuck = strtol(argv[++i], NULL, 16);
+      break;
+    case 'k':
+      if (i + 1 >= argc) {
+        usage();
+      }
+      khz = atof(argv[++i]);
+      break;
+    default:
+      usage();
+    }
+  }
+  if (khz <= 0) {
+    usage();
+  }
+  // power-on state that differs from the table, so a missed write shows
+  memset(rf.regs, 0xA5, sizeof(rf.regs));
+
+  es8388_bus_t bus = {.write = rf_write, .read = rf_read, .ctx = &rf};
+  es8388_program_stats_t stats;
+  esp_err_t err = es8388_program(&bus, es8388_init_seq, es8388_init_seq_len, &stats);
+
+  int wrong = 0;
+  for (size_t i = 0; i < es8388_init_seq_len; i++) {
+    // the last write of each register is what stays
+    const es8388_reg_t *e = &es8388_init_seq[i];
+    bool last = true;
+    for (size_t j = i + 1; j < es8388_init_seq_len; j++) {
+      last = last && es8388_init_seq[j].reg != e->reg;
+    }
+    if (last && rf.regs[e->reg] != e->val) {
+      printf("register 0x%02x is 0x%02x, table 0x%02x\n", e->reg, rf.regs[e->reg], e->val);
+      wrong++;
+    }
+  }
+  bool ordered = in_order(&rf);
+  bool guide = guide_order();
+
+  // one register per write, no readback
+  long single_bits = (long)es8388_init_seq_len * (I2C_BITS_ADDR + 2 * I2C_BITS_BYTE + I2C_BITS_STOP);
+  printf("%d registers in %d writes and %d reads%s: %s\n", stats.registers, stats.writes, stats.reads,
+         stats.unbatched ? " (unbatched)" : "", err == ESP_OK ? "verified" : "not verified");
+  printf("mismatches %d, failed %d, final state %s, write order %s, guide order %s\n", stats.mismatches,
+         stats.failed, wrong ? "wrong" : "ok", ordered ? "ok" : "wrong", guide ? "ok" : "wrong");
+  printf("bus %ld bits, %.2f ms at %.0f kHz, one register per write without readback %ld bits, %.2f ms\n", rf.bits,
+         rf.bits / khz, khz, single_bits, single_bits / khz);
+  return wrong == 0 && ordered && guide ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Generates main/morse_tables.h: read-only Morse code tables for every alphabet variant.
+
+Codes are indexed by key = (1 << len) | elements, first element in the most significant bit, dah = 1,
+so decoding a character is a shift per element and a single table load. The variant is selected at
+compile time with CONFIG_MORSE_ALPHABET_* / CONFIG_MORSE_PROSIGNS (see main/Kconfig.projbuild).
+
+Characters that are not a single ASCII byte (prosigns, Cyrillic, kana) are glyph ids >= 0x80 with
+UTF-8 transcript text and an ASCII form for the LCD.
+
+    tools/gen_morse_tables.py > main/morse_tables.h
+"""
+
+import sys
+
+MAX_LEN = 8
+FIRST_GLYPH = 0x80
+
+LETTERS = [
+    (".-", "A"), ("-...", "B"), ("-.-.", "C"), ("-..", "D"), (".", "E"), ("..-.", "F"), ("--.", "G"),
+    ("....", "H"), ("..", "I"), (".---", "J"), ("-.-", "K"), (".-..", "L"), ("--", "M"), ("-.", "N"),
+    ("---", "O"), (".--.", "P"), ("--.-", "Q"), (".-.", "R"), ("...", "S"), ("-", "T"), ("..-", "U"),
+    ("...-", "V"), (".--", "W"), ("-..-", "X"), ("-.--", "Y"), ("--..", "Z"),
+]
+
+DIGITS = [
+    ("-----", "0"), (".----", "1"), ("..---", "2"), ("...--", "3"), ("....-", "4"), (".....", "5"),
+    ("-....", "6"), ("--...", "7"), ("---..", "8"), ("----.", "9"),
+]
+
+# ITU-R M.1677-1 punctuation plus common non-ITU signs
+PUNCTUATION = [
+    (".-.-.-", "."), ("--..--", ","), ("---...", ":"), ("..--..", "?"), (".----.", "'"), ("-....-", "-"),
+    ("-..-.", "/"), ("-.--.", "("), ("-.--.-", ")"), (".-..-.", "\""), ("-...-", "="), (".-.-.", "+"),
+    (".--.-.", "@"), ("-.-.--", "!"), (".-...", "&"), ("-.-.-.", ";"), ("..--.-", "_"), ("...-..-", "$"),
+]
+
+# (code, transcript text, LCD text), override punctuation sharing the same code. Letters of the alphabet override
+# them in turn: Wabun kana take the codes of AR, BT, KN, AS and KA, only SK, VE, HH and BK stay prosigns there.
+PROSIGNS = [
+    (".-.-.", "<AR>"), ("...-.-", "<SK>"), ("-...-", "<BT>"), ("-.--.", "<KN>"), (".-...", "<AS>"),
+    ("-.-.-", "<KA>"), ("...-.", "<VE>"), ("........", "<HH>"), ("-...-.-", "<BK>"),
+]
+
+CYRILLIC = [
+    (".-", "А", "A"), ("-...", "Б", "B"), (".--", "В", "V"), ("--.", "Г", "G"), ("-..", "Д", "D"),
+    (".", "Е", "E"), ("...-", "Ж", "ZH"), ("--..", "З", "Z"), ("..", "И", "I"), (".---", "Й", "J"),
+    ("-.-", "К", "K"), (".-..", "Л", "L"), ("--", "М", "M"), ("-.", "Н", "N"), ("---", "О", "O"),
+    (".--.", "П", "P"), (".-.", "Р", "R"), ("...", "С", "S"), ("-", "Т", "T"), ("..-", "У", "U"),
+    ("..-.", "Ф", "F"), ("....", "Х", "H"), ("-.-.", "Ц", "C"), ("---.", "Ч", "CH"), ("----", "Ш", "SH"),
+    ("--.-", "Щ", "SC"), ("--.--", "Ъ", "\""), ("-.--", "Ы", "Y"), ("-..-", "Ь", "'"), ("..-..", "Э", "E"),
+    ("..--", "Ю", "YU"), (".-.-", "Я", "YA"),
+]
+
+WABUN = [
+    (".-", "イ", "I"), (".-.-", "ロ", "RO"), ("-...", "ハ", "HA"), ("-.-.", "ニ", "NI"), ("-..", "ホ", "HO"),
+    (".", "ヘ", "HE"), ("..-..", "ト", "TO"), ("..-.", "チ", "CHI"), ("--.", "リ", "RI"), ("....", "ヌ", "NU"),
+    ("-.--.", "ル", "RU"), (".---", "ヲ", "WO"), ("-.-", "ワ", "WA"), (".-..", "カ", "KA"), ("--", "ヨ", "YO"),
+    ("-.", "タ", "TA"), ("---", "レ", "RE"), ("---.", "ソ", "SO"), (".--.", "ツ", "TSU"), ("--.-", "ネ", "NE"),
+    (".-.", "ナ", "NA"), ("...", "ラ", "RA"), ("-", "ム", "MU"), ("..-", "ウ", "U"), (".-..-", "ヰ", "WI"),
+    ("..--", "ノ", "NO"), (".-...", "オ", "O"), ("...-", "ク", "KU"), (".--", "ヤ", "YA"), ("-..-", "マ", "MA"),
+    ("-.--", "ケ", "KE"), ("--..", "フ", "FU"), ("----", "コ", "KO"), ("-.---", "エ", "E"), (".-.--", "テ", "TE"),
+    ("--.--", "ア", "A"), ("-.-.-", "サ", "SA"), ("-.-..", "キ", "KI"), ("-..--", "ユ", "YU"), ("-...-", "メ", "ME"),
+    ("..-.-", "ミ", "MI"), ("--.-.", "シ", "SHI"), (".--..", "ヱ", "WE"), ("--..-", "ヒ", "HI"), ("-..-.", "モ", "MO"),
+    (".---.", "セ", "SE"), ("---.-", "ス", "SU"), (".-.-.", "ン", "N"), ("..", "゛", "\""), ("..--.", "゜", "*"),
+    (".--.-", "ー", "-"), (".-.-.-", "、", ","), (".-.-..", "。", "."), ("-.--.-", "（", "("), (".-..-.", "）", ")"),
+]
+
+
+def ascii_entries(table):
+    return [(code, ch, ch) for code, ch in table]
+
+
+def prosign_entries():
+    return [(code, text, text) for code, text in PROSIGNS]
+
+
+def merge(*tables):
+    codes = {}
+    for table in tables:
+        for code, text, lcd in table:
+            codes[code] = (text, lcd)  # later tables override
+    return codes
+
+
+def key(code):
+    k = 1
+    for e in code:
+        k = (k << 1) | (e == "-")
+    return k
+
+
+def main():
+    latin = ascii_entries(LETTERS + DIGITS + PUNCTUATION)
+    common = ascii_entries(DIGITS + PUNCTUATION)
+    wabun_common = ascii_entries(DIGITS)
+    variants = [
+        ("LATIN", merge(latin)),
+        ("LATIN_PROSIGNS", merge(latin, prosign_entries())),
+        ("CYRILLIC", merge(common, CYRILLIC)),
+        ("CYRILLIC_PROSIGNS", merge(common, prosign_entries(), CYRILLIC)),
+        ("WABUN", merge(wabun_common, WABUN)),
+        ("WABUN_PROSIGNS", merge(wabun_common, prosign_entries(), WABUN)),
+    ]
+
+    # glyph ids are shared by all variants
+    glyphs = []
+    for _, codes in variants:
+        for text, lcd in codes.values():
+            if len(text.encode()) > 1 and (text, lcd) not in glyphs:
+                glyphs.append((text, lcd))
+    assert FIRST_GLYPH + len(glyphs) < 0xFF, "glyph ids must stay clear of 0xFF"
+
+    def glyph(text, lcd):
+        if len(text.encode()) == 1:
+            return "'\\''" if text == "'" else "'%s'" % text.replace("\\", "\\\\")
+        return "0x%02X" % (FIRST_GLYPH + glyphs.index((text, lcd)))
+
+    out = sys.stdout
+    out.write("// Generated by tools/gen_morse_tables.py, do not edit\n")
+    out.write("#ifndef MORSE_TABLES_H_\n#define MORSE_TABLES_H_\n\n#include <stdint.h>\n\n")
+    out.write("#define MORSE_GLYPH_FIRST (0x%02X)\n#define MORSE_GLYPHS (%d)\n\n" % (FIRST_GLYPH, len(glyphs)))
+    out.write("// transcript (UTF-8) text of glyph ids >= MORSE_GLYPH_FIRST\n")
+    out.write("static const char *const morse_glyph_texts[MORSE_GLYPHS] = {\n")
+    for text, _ in glyphs:
+        out.write("    \"%s\",\n" % text.replace("\"", "\\\""))
+    out.write("};\n\n// LCD (ASCII) text of glyph ids >= MORSE_GLYPH_FIRST\n")
+    out.write("static const char *const morse_glyph_lcd_texts[MORSE_GLYPHS] = {\n")
+    for _, lcd in glyphs:
+        out.write("    \"%s\",\n" % lcd.replace("\\", "\\\\").replace("\"", "\\\""))
+    out.write("};\n\n")
+    out.write("// text of plain ASCII glyphs, each character followed by a terminator\n")
+    out.write("static const char morse_ascii_texts[128][2] = {")
+    for c in range(128):
+        out.write(("\n   " if c % 8 == 0 else "") + " {0x%02X, 0}," % c)
+    out.write("\n};\n\n")
+
+    for i, (name, codes) in enumerate(variants):
+        prosigns = name.endswith("_PROSIGNS")
+        alphabet = name.replace("_PROSIGNS", "")
+        cond = "defined(CONFIG_MORSE_ALPHABET_%s) && %sdefined(CONFIG_MORSE_PROSIGNS)" % (
+            alphabet, "" if prosigns else "!")
+        out.write("#%s %s\n" % ("if" if i == 0 else "elif", cond))
+        if prosigns:
+            # prosigns whose code is a letter of this alphabet
+            lost = ["%s %s" % (text, codes[code][0]) for code, text in PROSIGNS if codes[code][0] != text]
+            if lost:
+                out.write("// prosign codes decoded as letters: %s\n" % ", ".join(lost))
+        out.write("#define MORSE_TABLE_NAME \"%s\"\n" % name)
+        out.write("static const uint8_t morse_code_glyphs[%d] = {\n" % (2 << MAX_LEN))
+        for code in sorted(codes, key=lambda c: (len(c), key(c))):
+            assert len(code) <= MAX_LEN, code
+            text, lcd = codes[code]
+            out.write("    [0x%03X] = %s, // %s %s\n" % (key(code), glyph(text, lcd), code, text))
+        out.write("};\n")
+    out.write("#else\n#error \"Unknown Morse alphabet\"\n#endif\n\n#endif // MORSE_TABLES_H_\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,60 @@
+// Host versions of the device functions the decoder core and the DSP chain call.
+// Only the transcript produces output, everything else is a no-op.
+
+#include "host_stubs.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "audio_capture.h"
+#include "driver/gpio.h"
+#include "lcd.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "transcript.h"
+
+bool host_quiet = false;
+
+void lcd_flush() {}
+void lcd_print_str(const char *cp) { (void)cp; }
+void lcd_print_flush(char ch) { (void)ch; }
+void lcd_backspace() {}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+  (void)gpio_num;
+  (void)level;
+  return ESP_OK;
+}
+
+void telemetry_init(void) {}
+void telemetry_record_edge(int32_t dit_len, int32_t dah_len) {
+  (void)dit_len;
+  (void)dah_len;
+}
+void telemetry_record_char(bool decoded, bool soft, float confidence) {
+  (void)decoded;
+  (void)soft;
+  (void)confidence;
+}
+void telemetry_record_levels(float floor, float peak) {
+  (void)floor;
+  (void)peak;
+}
+void telemetry_record_blanked(int blanked) { (void)blanked; }
+void telemetry_record_squelch(bool open) { (void)open; }
+
+void transcript_append(const char *text, size_t len) {
+  if (!host_quiet) {
+    fwrite(text, 1, len, stdout);
+  }
+}
+
+void trace_record(trace_module_t module, trace_type_t type, int32_t a, int32_t b, int16_t c) {
+  (void)module;
+  (void)type;
+  (void)a;
+  (void)b;
+  (void)c;
+}
+
+void audio_capture_trigger(void) {}
@@ -0,0 +1,16 @@
+// Host stand-in for the ESP-IDF header, LEDs are provided by the host tool
+#ifndef HOST_DRIVER_GPIO_H_
+#define HOST_DRIVER_GPIO_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_19 (19)
+#define GPIO_NUM_22 (22)
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+
+#endif // HOST_DRIVER_GPIO_H_
@@ -0,0 +1,16 @@
+// Host stand-in for the ESP-IDF header
+#ifndef HOST_ESP_CHECK_H_
+#define HOST_ESP_CHECK_H_
+
+#include "esp_err.h"
+#include "esp_log.h"
+
+#define ESP_RETURN_ON_FALSE(a, err_code, log_tag, format, ...)                                                         \
+  do {                                                                                                                 \
+    if (!(a)) {                                                                                                        \
+      ESP_LOGE(log_tag, format, ##__VA_ARGS__);                                                                        \
+      return err_code;                                                                                                 \
+    }                                                                                                                  \
+  } while (0)
+
+#endif // HOST_ESP_CHECK_H_
@@ -0,0 +1,30 @@
+// Host stand-in for the ESP-IDF header, errors and warnings go to stderr, the rest is dropped
+#ifndef HOST_ESP_LOG_H_
+#define HOST_ESP_LOG_H_
+
+#include <stdio.h>
+
+typedef enum {
+  ESP_LOG_NONE,
+  ESP_LOG_ERROR,
+  ESP_LOG_WARN,
+  ESP_LOG_INFO,
+  ESP_LOG_DEBUG,
+  ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+#define HOST_LOG(level, tag, format, ...) fprintf(stderr, level " (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGE(tag, format, ...) HOST_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG("W", tag, format, ##__VA_ARGS__)
+// arguments are still type checked and count as used
+#define HOST_LOG_OFF(tag, format, ...)                                                                                 \
+  do {                                                                                                                 \
+    if (0) {                                                                                                           \
+      HOST_LOG("", tag, format, ##__VA_ARGS__);                                                                        \
+    }                                                                                                                  \
+  } while (0)
+#define ESP_LOGI(tag, format, ...) HOST_LOG_OFF(tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG_OFF(tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) HOST_LOG_OFF(tag, format, ##__VA_ARGS__)
+
+#endif // HOST_ESP_LOG_H_
@@ -0,0 +1,10 @@
+// Device functions the platform free sources call, implemented for host tools by tools/host/host_stubs.c
+#ifndef HOST_STUBS_H_
+#define HOST_STUBS_H_
+
+#include <stdbool.h>
+
+// transcript text is written to stdout unless set
+extern bool host_quiet;
+
+#endif // HOST_STUBS_H_
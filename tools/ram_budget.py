@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Static RAM budget per module, from the linker map of an ESP-IDF build.
+
+Sums the input sections placed in RAM by the object they come from: every main/ source file is a
+module of its own, the rest is summed per library (ADF, FreeRTOS, drivers, libc). With
+CONFIG_STATIC_MEMORY this is nearly all the RAM the application takes, the heap the rest of the
+startup takes is logged by app_main ("Startup took ... bytes of heap").
+
+    idf build
+    tools/ram_budget.py build/esp-adf-esp32-a1s-morse-decode.map
+    tools/ram_budget.py -n 0 build/*.map       # every library
+
+Columns are bytes: data (initialized, DRAM), bss (zeroed DRAM), psram (.ext_ram.bss) and iram (code
+and data in instruction RAM).
+"""
+
+import argparse
+import collections
+import re
+import sys
+
+# output sections by column, the rest (flash, RTC) is left out
+COLUMNS = collections.OrderedDict([
+    ("data", re.compile(r"^\.dram\d\.data$")),
+    ("bss", re.compile(r"^\.dram\d\.bss$|^\.noinit$")),
+    ("psram", re.compile(r"^\.ext_ram\.bss$|^\.ext_ram_noinit$")),
+    ("iram", re.compile(r"^\.iram\d\.(text|data|bss|vectors)$")),
+])
+
+OUTPUT = re.compile(r"^(\.[\w.]+)(?:\s+0x[0-9a-f]+\s+0x[0-9a-f]+)?\s*$")
+INPUT = re.compile(r"^ (\S+)?\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$")
+INPUT_NAME = re.compile(r"^ (\S+)\s*$")
+ARCHIVE = re.compile(r"(?:.*/)?lib([^/()]+)\.a\(([^)]+)\)$")
+
+
+def owner(path):
+    """Returns (group, name): ("main", module) for the application, ("lib", library) otherwise."""
+    m = ARCHIVE.match(path)
+    if not m:
+        return "lib", path.rsplit("/", 1)[-1]
+    lib, obj = m.groups()
+    if lib == "main":
+        return "main", re.sub(r"\.(c|cpp|S)\.obj$|\.o$", "", obj)
+    return "lib", lib
+
+
+def parse(lines):
+    """Returns {(group, name): {column: bytes}}."""
+    sizes = collections.defaultdict(lambda: collections.Counter())
+    column = None
+    pending = None
+    in_map = False
+    for line in lines:
+        line = line.rstrip("\n")
+        if not in_map:
+            in_map = line.startswith("Linker script and memory map")
+            continue
+        m = OUTPUT.match(line)
+        if m:
+            column = next((c for c, r in COLUMNS.items() if r.match(m.group(1))), None)
+            pending = None
+            continue
+        if column is None:
+            continue
+        m = INPUT.match(line)
+        if m and (m.group(1) or pending):
+            name = m.group(1) or pending
+            pending = None
+            size = int(m.group(3), 16)
+            # *fill* and load addresses have no object
+            if size and name != "*fill*" and "(size before relaxing)" not in m.group(4):
+                sizes[owner(m.group(4).strip())][column] += size
+            continue
+        # a long section name goes on a line of its own, the address and size follow
+        m = INPUT_NAME.match(line)
+        pending = m.group(1) if m else None
+    return sizes
+
+
+def row(name, c):
+    return "%-28s %8d %8d %8d %8d %8d" % (name, c["data"], c["bss"], c["psram"], c["iram"], sum(c.values()))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("map", help="linker map, build/<project>.map")
+    ap.add_argument("-n", "--libs", type=int, default=10, help="largest libraries listed, 0 for all")
+    args = ap.parse_args()
+
+    with open(args.map, errors="replace") as f:
+        sizes = parse(f)
+    if not sizes:
+        sys.exit("%s: no RAM sections, not an ESP-IDF linker map?" % args.map)
+
+    for group, title in (("main", "module"), ("lib", "library")):
+        items = sorted(((n, c) for (g, n), c in sizes.items() if g == group), key=lambda i: -sum(i[1].values()))
+        total = sum((c for _, c in items), collections.Counter())
+        shown = items if group == "main" or args.libs == 0 else items[:args.libs]
+        print("%-28s %8s %8s %8s %8s %8s" % (title, *COLUMNS.keys(), "total"))
+        for name, c in shown:
+            print(row(name, c))
+        if len(shown) < len(items):
+            print(row("(%d more)" % (len(items) - len(shown)), sum((c for _, c in items[len(shown):]),
+                                                                    collections.Counter())))
+        print(row("total", total))
+        print()
+
+
+if __name__ == "__main__":
+    main()
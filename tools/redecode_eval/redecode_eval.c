@@ -0,0 +1,265 @@
+// Evaluates word re-decoding on held-out text: keyed tone plus white noise through the device DSP chain and
+// decoder, the character error rate of each decoder setting against the sent text.
+//
+//   redecode_eval [-w wpm] [-r rate] [-s from:to:step] [text.txt]
+//
+// The text is plain QSO and contest traffic with callsigns, reports and serial numbers, a file replaces it.
+// Each SNR runs the same signal and noise twice: live characters (lookahead off) and words re-decoded with the
+// speed learned over them (lookahead correct), the edge_replay -l off / -l correct settings.
+// CER is the edit distance between the sent and the decoded text, spaces included, over the sent length.
+// SNR is tone power over the noise power in the full band, see tools/ook_bench.
+
+#include <ctype.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cw_gen.h"
+#include "dsp_chain.h"
+#include "host_stubs.h"
+#include "morse_code_table.h"
+#include "morse_core.h"
+
+#define BLOCK (512)
+#define AMPLITUDE (8000.0f)
+#define TEXT_MAX (8192)
+
+static const char *const QSO_TEXT = "VK3ABC DE ZL2XYZ GE ES TNX FER THE CALL UR SIGS 579 IN WELLINGTON "
+                                   "NAME IS GRAHAM OP HERE RUNNING 50W TO A LONG WIRE WX IS WINDY AND WET "
+                                   "SO HW COPY VK3ABC DE ZL2XYZ KN "
+                                   "EI7QT DE YO8RZ R R FB GRAHAM ALL OK HERE MY QTH IS NEAR IASI "
+                                   "RIG IS HOMEBREW WITH 20W INTO VERTICAL ANT TEMP 12C "
+                                   "PSE QSL VIA BURO WILL SEND MINE TODAY EI7QT DE YO8RZ BK "
+                                   "CQ TEST CT1ZZ CT1ZZ TEST LZ2PQ 599 014 4X6TT 5NN 27 "
+                                   "HAPPY TO MEET YOU AGAIN ON THIS BAND CONDX ARE IMPROVING "
+                                   "TNX FER NICE CHAT HOPE TO HEAR YOU NEXT WEEKEND 73 ES GUD DX SK";
+
+// esp-dsp dsps_biquad_gen_bpf_f32 / dsps_biquad_gen_lpf_f32, f relative to the sample rate
+static void gen_biquad(float *coeffs, bool bpf, float f, float q) {
+  float w0 = 2 * M_PI * f;
+  float c = cosf(w0);
+  float s = sinf(w0);
+  float alpha = s / (2 * q);
+  float b0 = bpf ? s / 2 : (1 - c) / 2;
+  float b1 = bpf ? 0 : 1 - c;
+  float b2 = bpf ? -b0 : b0;
+  float a0 = 1 + alpha;
+
+  coeffs[0] = b0 / a0;
+  coeffs[1] = b1 / a0;
+  coeffs[2] = b2 / a0;
+  coeffs[3] = -2 * c / a0;
+  coeffs[4] = (1 - alpha) / a0;
+}
+
+static float gaussian(void) {
+  float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+  float u2 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+  return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+// decoded transcript text, from the characters with lookahead off and from the words otherwise
+typedef struct {
+  char text[TEXT_MAX];
+  size_t len;
+} output_t;
+
+static void append(output_t *out, bool space, const char *text) {
+  if (space && out->len > 0 && out->len + 1 < TEXT_MAX) {
+    out->text[out->len++] = ' ';
+  }
+  size_t n = strlen(text);
+  if (out->len + n < TEXT_MAX) {
+    memcpy(out->text + out->len, text, n);
+    out->len += n;
+  }
+  out->text[out->len] = 0;
+}
+
+static void on_char(const morse_char_t *ch, void *ctx) { append(ctx, ch->word_start, morse_glyph_text(ch->c)); }
+
+static void on_word(const morse_word_t *w, void *ctx) {
+  for (int i = 0; i < w->n; i++) {
+    append(ctx, i == 0 && w->word_start, morse_glyph_text(w->glyphs[i]));
+  }
+}
+
+// key-ups of the generator, the last one ends the text
+typedef struct {
+  uint32_t chars;
+  uint32_t keyups;
+  uint64_t last;
+} sent_t;
+
+static void on_keyup(char c, uint64_t sample, void *ctx) {
+  sent_t *sent = (sent_t *)ctx;
+  if (sent->keyups < sent->chars && ++sent->keyups == sent->chars) {
+    sent->last = sample;
+  }
+}
+
+static void on_edge(int32_t e, float range, uint64_t sample, void *ctx) {
+  morse_edge_t edge = {.e = e, .sample = sample};
+  morse_core_edge(&edge);
+}
+
+static void run(output_t *out, const char *text, morse_lookahead_mode_t mode, float snr_db, int wpm, uint32_t rate) {
+  float coeffs_bpf[DSP_CHAIN_COEFFS];
+  float coeffs_lpf[DSP_CHAIN_COEFFS];
+  gen_biquad(coeffs_bpf, true, 749.7f / rate, 20.0f);
+  gen_biquad(coeffs_lpf, false, 22.05f / rate, 0.707f);
+  dsp_chain_t chain;
+  dsp_chain_init(&chain, coeffs_bpf, coeffs_lpf);
+
+  memset(out, 0, sizeof(*out));
+  morse_core_init();
+  morse_core_set_lookahead_mode(mode);
+  morse_core_set_char_fn(mode == MORSE_LOOKAHEAD_OFF ? on_char : NULL, out);
+  morse_core_set_word_fn(mode == MORSE_LOOKAHEAD_OFF ? NULL : on_word, out);
+
+  // once through the text, stops before the repetition after the word gap
+  sent_t sent = {0};
+  for (const char *p = text; *p; p++) {
+    sent.chars += *p != ' ' && morse_code_key_of(*p) != MORSE_CODE_KEY_EMPTY;
+  }
+  cw_gen_t gen;
+  cw_gen_init(&gen, text, wpm, 749.7f, AMPLITUDE, rate, on_keyup, &sent);
+
+  float sigma = AMPLITUDE / sqrtf(2.0f) / powf(10.0f, snr_db / 20);
+  static int16_t samples[BLOCK];
+  srand(1);
+  while (sent.keyups < sent.chars || gen.sample < sent.last + 6 * (uint64_t)gen.dit) {
+    cw_gen_fill(&gen, samples, 1, BLOCK);
+    for (int i = 0; i < BLOCK; i++) {
+      float v = samples[i] + sigma * gaussian();
+      samples[i] = (int16_t)fmaxf(fminf(v, INT16_MAX), INT16_MIN);
+    }
+    dsp_chain_process(&chain, samples, 1, BLOCK, gen.sample - BLOCK, on_edge, NULL);
+  }
+  morse_core_idle();
+}
+
+// Levenshtein distance, two rows
+static size_t edit_distance(const char *a, size_t na, const char *b, size_t nb) {
+  static size_t rows[2][TEXT_MAX + 1];
+  size_t *prev = rows[0];
+  size_t *cur = rows[1];
+  for (size_t j = 0; j <= nb; j++) {
+    prev[j] = j;
+  }
+  for (size_t i = 1; i <= na; i++) {
+    cur[0] = i;
+    for (size_t j = 1; j <= nb; j++) {
+      size_t sub = prev[j - 1] + (a[i - 1] != b[j - 1]);
+      size_t del = prev[j] + 1;
+      size_t ins = cur[j - 1] + 1;
+      cur[j] = sub < del ? (sub < ins ? sub : ins) : (del < ins ? del : ins);
+    }
+    size_t *t = prev;
+    prev = cur;
+    cur = t;
+  }
+  return prev[nb];
+}
+
+// upper case, single spaces, no leading or trailing space
+static void normalize(char *s) {
+  char *o = s;
+  for (const char *p = s; *p; p++) {
+    char c = (char)toupper((unsigned char)*p);
+    if (isspace((unsigned char)c)) {
+      if (o > s && o[-1] != ' ') {
+        *o++ = ' ';
+      }
+    } else {
+      *o++ = c;
+    }
+  }
+  if (o > s && o[-1] == ' ') {
+    o--;
+  }
+  *o = 0;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: redecode_eval [-w wpm] [-r rate] [-s from:to:step] [text.txt]\n"
+                  "  -w  speed, wpm (20)\n"
+                  "  -r  sample rate of the chain, Hz (44100)\n"
+                  "  -s  SNR sweep, dB (-21:-9:3)\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  int wpm = 20;
+  uint32_t rate = 44100;
+  float from = -21, to = -9, step = 3;
+  const char *path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (arg[0] != '-') {
+      path = arg;
+      continue;
+    }
+    if (!arg[1] || arg[2] || i + 1 >= argc) {
+      usage();
+    }
+    const char *v = argv[++i];
+    switch (arg[1]) {
+    case 'w':
+      wpm = atoi(v);
+      break;
+    case 'r':
+      rate = (uint32_t)atoi(v);
+      break;
+    case 's':
+      if (sscanf(v, "%f:%f:%f", &from, &to, &step) != 3) {
+        usage();
+      }
+      break;
+    default:
+      usage();
+    }
+  }
+  if (wpm <= 0 || rate < 2000 || step <= 0) {
+    usage();
+  }
+
+  static char text[TEXT_MAX];
+  if (path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+      perror(path);
+      return 1;
+    }
+    text[fread(text, 1, sizeof(text) - 1, f)] = 0;
+    fclose(f);
+  } else {
+    strncpy(text, QSO_TEXT, sizeof(text) - 1);
+  }
+  normalize(text);
+  size_t n = strlen(text);
+  if (n == 0) {
+    usage();
+  }
+
+  host_quiet = true;
+  fprintf(stderr, "%zu characters at %d wpm, %u Hz\n", n, wpm, rate);
+  printf("%6s %8s %8s\n", "snr_db", "live", "redecode");
+
+  static output_t out;
+  for (float snr = from; snr <= to + step / 2; snr += step) {
+    float cer[2];
+    const morse_lookahead_mode_t modes[2] = {MORSE_LOOKAHEAD_OFF, MORSE_LOOKAHEAD_CORRECT};
+    for (int m = 0; m < 2; m++) {
+      run(&out, text, modes[m], snr, wpm, rate);
+      normalize(out.text);
+      cer[m] = 100.0f * edit_distance(text, n, out.text, strlen(out.text)) / n;
+    }
+    printf("%6.1f %7.1f%% %7.1f%%\n", snr, cer[0], cer[1]);
+  }
+  return 0;
+}
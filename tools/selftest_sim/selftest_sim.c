@@ -0,0 +1,250 @@
+// Runs the self-test on a host: CW generator, DSP chain and decoder with a simulated pipeline clock.
+//
+//   selftest_sim [-t seconds] [-w wpm] [-f hz] [-a level] [-n noise] [-b frames] [-r blocks] [-d us] [-q us]
+//                [-p] [text]
+//
+// The source releases a block of -b frames when its last sample is due, like the I2S reader. The DSP
+// element reads it -r blocks later (ringbuffer backlog) and its edges are out -d us after that. The
+// decoder task takes each edge -q us after it was queued. The decoder and the latency accounting are the
+// device code, so the report matches the console "latency" command for the same pipeline timing.
+// Decoded text and then the report go to stdout, the pipeline settings to stderr.
+//
+// -p also times the chain on the host CPU, and a copy of it with the noise blanker off on the same blocks,
+// for the share of the block cost the blanker takes.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cw_gen.h"
+#include "dsp_chain.h"
+#include "host_stubs.h"
+#include "latency.h"
+#include "morse_core.h"
+
+#define SAMPLE_RATE (44100)
+// Decoder task queue timeout
+#define IDLE_TIMEOUT_US (1000000)
+
+static int64_t sim_now;
+
+static int64_t sim_clock(void) { return sim_now; }
+
+// esp-dsp dsps_biquad_gen_bpf_f32 / dsps_biquad_gen_lpf_f32, f relative to the sample rate
+static void gen_biquad(float *coeffs, bool bpf, float f, float q) {
+  float w0 = 2 * M_PI * f;
+  float c = cosf(w0);
+  float s = sinf(w0);
+  float alpha = s / (2 * q);
+  float b0 = bpf ? s / 2 : (1 - c) / 2;
+  float b1 = bpf ? 0 : 1 - c;
+  float b2 = bpf ? -b0 : b0;
+  float a0 = 1 + alpha;
+
+  coeffs[0] = b0 / a0;
+  coeffs[1] = b1 / a0;
+  coeffs[2] = b2 / a0;
+  coeffs[3] = -2 * c / a0;
+  coeffs[4] = (1 - alpha) / a0;
+}
+
+static int64_t cpu_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// host CPU time of the chain with and without the noise blanker
+typedef struct {
+  bool on;
+  dsp_chain_t plain;
+  int64_t chain_ns;
+  int64_t plain_ns;
+  int64_t decoder_ns; // in on_edge, taken out of chain_ns
+  uint32_t blocks;
+} profile_t;
+
+static profile_t prof;
+
+static void ignore_edge(int32_t e, float range, uint64_t sample, void *ctx) {}
+
+typedef struct {
+  int64_t queue_us;
+  int64_t last_edge; // decoder task clock of the last edge, for the queue timeout
+  bool idle;         // timed out since the last edge
+} decoder_t;
+
+// the decoder task: waits on the queue, decodes, times out after a second without edges
+static void decoder_wait_until(decoder_t *d, int64_t t) {
+  if (!d->idle && t - d->last_edge >= IDLE_TIMEOUT_US) {
+    sim_now = d->last_edge + IDLE_TIMEOUT_US;
+    morse_core_idle();
+    d->idle = true;
+  }
+}
+
+static void on_edge(int32_t e, float range, uint64_t sample, void *ctx) {
+  decoder_t *d = (decoder_t *)ctx;
+  int64_t detect = sim_now;
+  int64_t t0 = prof.on ? cpu_ns() : 0;
+
+  latency_edge(e);
+  decoder_wait_until(d, detect + d->queue_us);
+  sim_now = detect + d->queue_us;
+  latency_dequeue();
+  morse_edge_t edge = {.e = e, .sample = sample};
+  morse_core_edge(&edge);
+  d->last_edge = sim_now;
+  d->idle = false;
+  sim_now = detect;
+  if (prof.on) {
+    prof.decoder_ns += cpu_ns() - t0;
+  }
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: selftest_sim [-t s] [-w wpm] [-f hz] [-a level] [-n noise] [-b frames] [-r blocks] "
+                  "[-d us] [-q us] [-p] [text]\n"
+                  "  -t  simulated time, s (60)\n"
+                  "  -w  speed, wpm (20)\n"
+                  "  -f  tone, Hz (750)\n"
+                  "  -a  tone peak level (8000)\n"
+                  "  -n  white noise peak level (0)\n"
+                  "  -b  source block, frames (512)\n"
+                  "  -r  ringbuffer backlog, blocks (4)\n"
+                  "  -d  DSP time per block, us (1500)\n"
+                  "  -q  queue to decoder task, us (50)\n"
+                  "  -p  time the chain and its noise blanker on this CPU\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  const char *text = "CQ CQ DE ESP32 PARIS 73";
+  float seconds = 60;
+  int wpm = 20;
+  float freq = 750;
+  float level = 8000;
+  float noise = 0;
+  int block = 512;
+  int rb_blocks = 4;
+  int64_t dsp_us = 1500;
+  decoder_t dec = {.queue_us = 50};
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (strcmp(arg, "-p") == 0) {
+      prof.on = true;
+    } else if (arg[0] == '-' && arg[1] && !arg[2] && i + 1 < argc) {
+      const char *v = argv[++i];
+      switch (arg[1]) {
+      case 't':
+        seconds = atof(v);
+        break;
+      case 'w':
+        wpm = atoi(v);
+        break;
+      case 'f':
+        freq = atof(v);
+        break;
+      case 'a':
+        level = atof(v);
+        break;
+      case 'n':
+        noise = atof(v);
+        break;
+      case 'b':
+        block = atoi(v);
+        break;
+      case 'r':
+        rb_blocks = atoi(v);
+        break;
+      case 'd':
+        dsp_us = atoll(v);
+        break;
+      case 'q':
+        dec.queue_us = atoll(v);
+        break;
+      default:
+        usage();
+      }
+    } else if (arg[0] != '-') {
+      text = arg;
+    } else {
+      usage();
+    }
+  }
+  if (wpm <= 0 || block <= 0 || block > DSP_CHAIN_MAX_SAMPLES || rb_blocks < 0) {
+    usage();
+  }
+
+  // the device filters, see audio_dsp.c
+  float coeffs_bpf[DSP_CHAIN_COEFFS];
+  float coeffs_lpf[DSP_CHAIN_COEFFS];
+  gen_biquad(coeffs_bpf, true, 0.017f, 20.0f);
+  gen_biquad(coeffs_lpf, false, 0.0005f, 0.707f);
+  dsp_chain_t chain;
+  dsp_chain_init(&chain, coeffs_bpf, coeffs_lpf);
+  morse_core_init();
+  prof.plain = chain;
+  noise_blanker_set_enabled(&prof.plain.s.nb, false);
+
+  cw_gen_t gen;
+  cw_gen_init(&gen, text, wpm, freq, level, SAMPLE_RATE, latency_keyup, NULL);
+  latency_start(sim_clock, SAMPLE_RATE, gen.dit);
+  latency_set_origin(0);
+
+  static int16_t samples[DSP_CHAIN_MAX_SAMPLES];
+  uint64_t total = (uint64_t)(seconds * SAMPLE_RATE);
+  int64_t block_us = (int64_t)block * 1000000 / SAMPLE_RATE;
+  srand(1);
+
+  while (gen.sample < total) {
+    // source: block is out when its last sample is due
+    cw_gen_fill(&gen, samples, 1, block);
+    for (int i = 0; noise > 0 && i < block; i++) {
+      samples[i] += (int16_t)(noise * (2.0f * rand() / RAND_MAX - 1.0f));
+    }
+    int64_t emit = (int64_t)(gen.sample * 1000000 / SAMPLE_RATE);
+    sim_now = emit;
+    latency_source_block(gen.sample);
+
+    // DSP element, behind the ringbuffer backlog
+    sim_now = emit + rb_blocks * block_us;
+    latency_dsp_block(gen.sample);
+    sim_now += dsp_us;
+    if (prof.on) {
+      static int16_t copy[DSP_CHAIN_MAX_SAMPLES];
+      memcpy(copy, samples, block * sizeof(copy[0]));
+      int64_t t0 = cpu_ns();
+      dsp_chain_process(&prof.plain, copy, 1, block, gen.sample - block, ignore_edge, NULL);
+      int64_t t1 = cpu_ns();
+      dsp_chain_process(&chain, samples, 1, block, gen.sample - block, on_edge, &dec);
+      int64_t t2 = cpu_ns();
+      prof.plain_ns += t1 - t0;
+      prof.chain_ns += t2 - t1;
+      prof.blocks++;
+    } else {
+      dsp_chain_process(&chain, samples, 1, block, gen.sample - block, on_edge, &dec);
+    }
+    decoder_wait_until(&dec, sim_now);
+  }
+  decoder_wait_until(&dec, dec.last_edge + IDLE_TIMEOUT_US);
+  if (!host_quiet) {
+    putchar('\n');
+  }
+
+  fprintf(stderr, "%.1f s at %d wpm, %d frame blocks, %d blocks backlog, DSP %lld us, queue %lld us\n", seconds, wpm,
+          block, rb_blocks, (long long)dsp_us, (long long)dec.queue_us);
+  if (prof.on && prof.blocks > 0) {
+    double chain_us = (prof.chain_ns - prof.decoder_ns) / 1000.0 / prof.blocks;
+    double nb_us = chain_us - prof.plain_ns / 1000.0 / prof.blocks;
+    fprintf(stderr, "Chain %.2f us per block on this CPU, noise blanker %.2f us (%.1f%%)\n", chain_us, nb_us,
+            100.0 * nb_us / chain_us);
+  }
+  latency_report();
+  return 0;
+}
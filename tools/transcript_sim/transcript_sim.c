@@ -0,0 +1,301 @@
+// Runs the transcript log (transcript_log.c) on a file backed storage (storage_file.c) across simulated reboots.
+//
+//   transcript_sim [file]
+//
+// Each boot closes and reopens the file and mounts the log again. Covers appends across pages, a new page
+// per boot, wrap-around with the tail advancing, remount after a torn page header and after an erase that
+// never got its header, and transcript_log_find / transcript_log_read across the unused tails of pages from
+// earlier boots. Every step is compared against a model of the pages. Exit status 0 when all checks pass.
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "storage.h"
+#include "transcript_log.h"
+
+#define PAGES (8)
+#define PAGE_SIZE (256)
+#define PAYLOAD (PAGE_SIZE - sizeof(transcript_page_header_t))
+#define SEQ_MAX (64)
+
+#define CHECK(cond)                                                                                                    \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond);                                                       \
+      failures++;                                                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+static int failures;
+
+// what the log should hold, by page sequence number
+typedef struct {
+  char text[SEQ_MAX][PAYLOAD];
+  uint32_t fill[SEQ_MAX];
+  uint32_t boot[SEQ_MAX];
+  uint32_t time_ms[SEQ_MAX];
+  bool valid[SEQ_MAX];
+  bool empty;
+  uint32_t head;
+  uint32_t tail;
+  bool open; // head page started in this boot
+} model_t;
+
+typedef struct {
+  const char *path;
+  storage_t storage;
+  transcript_log_t log;
+  model_t m;
+  uint32_t now_ms;
+} sim_t;
+
+static void boot(sim_t *s) {
+  if (s->storage.ctx != NULL) {
+    transcript_log_unmount(&s->log);
+    storage_file_close(&s->storage);
+  }
+  CHECK(storage_file_open(&s->storage, s->path, PAGES * PAGE_SIZE, PAGE_SIZE) == ESP_OK);
+  CHECK(transcript_log_mount(&s->log, &s->storage) == ESP_OK);
+  s->m.open = false;
+  s->now_ms = 0;
+
+  CHECK(s->log.empty == s->m.empty);
+  if (!s->m.empty) {
+    CHECK(s->log.head_seq == s->m.head);
+    CHECK(s->log.tail_seq == s->m.tail);
+    CHECK(s->log.head_fill == s->m.fill[s->m.head]);
+    CHECK(s->log.boot == s->m.boot[s->m.head] + 1);
+  }
+}
+
+// appends through the log and the model, a new page when the head is full or from an earlier boot
+static void append(sim_t *s, const char *text, size_t len) {
+  model_t *m = &s->m;
+  CHECK(transcript_log_append(&s->log, text, len, s->now_ms) == ESP_OK);
+
+  for (size_t i = 0; i < len; i++) {
+    if (!m->open || m->fill[m->head] >= PAYLOAD) {
+      uint32_t seq = m->empty ? 0 : m->head + 1;
+      if (seq >= SEQ_MAX) {
+        fprintf(stderr, "model holds %d pages\n", SEQ_MAX);
+        exit(2);
+      }
+      if (seq >= PAGES) {
+        m->valid[seq - PAGES] = false;
+      }
+      m->fill[seq] = 0;
+      m->boot[seq] = s->log.boot;
+      m->time_ms[seq] = s->now_ms;
+      m->valid[seq] = true;
+      if (m->empty) {
+        m->tail = seq;
+      }
+      while (seq - m->tail >= PAGES) {
+        m->tail++;
+      }
+      m->empty = false;
+      m->head = seq;
+      m->open = true;
+    }
+    m->text[m->head][m->fill[m->head]++] = (uint8_t)text[i] == 0xFF ? '?' : text[i];
+  }
+  s->now_ms += 100;
+}
+
+// text from i-th byte of an endless pattern, distinct per call so misplaced text shows
+static void append_pattern(sim_t *s, size_t len) {
+  static uint32_t counter;
+  char buf[512];
+  for (size_t i = 0; i < len; i++) {
+    buf[i] = (char)('A' + (counter++ % 26));
+  }
+  append(s, buf, len);
+}
+
+// text the log should return reading from offset to its end
+static size_t model_read(const sim_t *s, uint64_t offset, char *buf) {
+  const model_t *m = &s->m;
+  size_t n = 0;
+  if (m->empty) {
+    return 0;
+  }
+  if (offset < (uint64_t)m->tail * PAYLOAD) {
+    offset = (uint64_t)m->tail * PAYLOAD;
+  }
+  for (uint32_t seq = (uint32_t)(offset / PAYLOAD); seq <= m->head; seq++) {
+    uint32_t pos = seq == offset / PAYLOAD ? (uint32_t)(offset % PAYLOAD) : 0;
+    if (m->valid[seq] && pos < m->fill[seq]) {
+      memcpy(buf + n, m->text[seq] + pos, m->fill[seq] - pos);
+      n += m->fill[seq] - pos;
+    }
+  }
+  return n;
+}
+
+// reads to the end in chunks of the given size and compares with the model
+static void check_read(const sim_t *s, uint64_t offset, size_t chunk) {
+  static char got[SEQ_MAX * PAYLOAD];
+  static char want[SEQ_MAX * PAYLOAD];
+  size_t n_want = model_read(s, offset, want);
+  size_t n_got = 0;
+
+  for (;;) {
+    size_t n = transcript_log_read(&s->log, &offset, got + n_got, chunk);
+    if (n == 0) {
+      break;
+    }
+    n_got += n;
+    if (n_got > n_want) {
+      break;
+    }
+  }
+  CHECK(n_got == n_want);
+  CHECK(memcmp(got, want, n_got < n_want ? n_got : n_want) == 0);
+  CHECK(offset == transcript_log_end(&s->log));
+}
+
+static void check_reads(const sim_t *s) {
+  const size_t chunks[] = {1, 7, PAYLOAD, 4096};
+  for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+    check_read(s, 0, chunks[i]);
+    if (!s->m.empty) {
+      check_read(s, transcript_log_begin(&s->log) + 5, chunks[i]);
+    }
+  }
+  CHECK(transcript_log_begin(&s->log) == (s->m.empty ? 0 : (uint64_t)s->m.tail * PAYLOAD));
+  CHECK(transcript_log_end(&s->log) == (s->m.empty ? 0 : (uint64_t)s->m.head * PAYLOAD + s->m.fill[s->m.head]));
+}
+
+// newest valid page started at or before (boot, time_ms), the oldest text if none
+static uint64_t model_find(const model_t *m, uint32_t boot, uint32_t time_ms) {
+  if (m->empty) {
+    return 0;
+  }
+  for (uint32_t seq = m->head + 1; seq-- > m->tail;) {
+    if (m->valid[seq] && (m->boot[seq] < boot || (m->boot[seq] == boot && m->time_ms[seq] <= time_ms))) {
+      return (uint64_t)seq * PAYLOAD;
+    }
+  }
+  return (uint64_t)m->tail * PAYLOAD;
+}
+
+static void check_find(const sim_t *s) {
+  for (uint32_t boot = 0; boot <= s->log.boot + 1; boot++) {
+    for (uint32_t t = 0; t <= 10000; t += 50) {
+      CHECK(transcript_log_find(&s->log, boot, t) == model_find(&s->m, boot, t));
+    }
+  }
+}
+
+// power lost on the head's successor: the sector erased, the header torn (len bytes of it) or not written
+static void interrupt_page(sim_t *s, size_t len) {
+  uint32_t seq = s->m.head + 1;
+  size_t addr = (size_t)(seq % PAGES) * PAGE_SIZE;
+  transcript_page_header_t h = {.magic = TRANSCRIPT_MAGIC, .seq = seq, .boot = s->log.boot, .time_ms = s->now_ms};
+
+  CHECK(storage_erase(&s->storage, addr, PAGE_SIZE) == ESP_OK);
+  if (len > 0) {
+    CHECK(storage_write(&s->storage, addr, &h, len) == ESP_OK);
+  }
+  if (seq >= PAGES) {
+    s->m.valid[seq - PAGES] = false;
+    if (s->m.tail == seq - PAGES) {
+      s->m.tail++;
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  static sim_t s;
+  char path[64];
+
+  snprintf(path, sizeof(path), "/tmp/transcript_sim.%d", (int)getpid());
+  s.path = argc > 1 ? argv[1] : path;
+  remove(s.path);
+  s.m.empty = true;
+
+  // first boot, appends across pages, 0xFF stored as '?'
+  boot(&s);
+  CHECK(s.log.empty && s.log.boot == 0);
+  check_reads(&s);
+  for (int i = 0; i < 6; i++) {
+    append_pattern(&s, 100);
+  }
+  append(&s, "\xff" "AB\xff", 4);
+  CHECK(s.log.head_seq == 2 && s.log.erases == 3);
+  check_reads(&s);
+  check_find(&s);
+
+  // a boot without text starts no page, the next one starts a page after the unused tail
+  boot(&s);
+  CHECK(s.log.boot == 1 && !s.log.page_open);
+  boot(&s);
+  CHECK(s.log.boot == 1 && s.log.erases == 0);
+  append_pattern(&s, 50);
+  CHECK(s.log.head_seq == 3 && s.log.boot == 1);
+  check_reads(&s);
+  check_find(&s);
+
+  // inside the skipped tail of page 2, the read goes on at page 3
+  {
+    uint64_t offset = 2 * PAYLOAD + s.m.fill[2] + 3;
+    char c;
+    CHECK(transcript_log_read(&s.log, &offset, &c, 1) == 1 && c == s.m.text[3][0]);
+    CHECK(offset == 3 * PAYLOAD + 1);
+  }
+
+  // a few short boots, each leaves a page tail
+  for (int i = 0; i < 3; i++) {
+    boot(&s);
+    append_pattern(&s, 30 + 40 * i);
+    append_pattern(&s, 20);
+  }
+  CHECK(s.log.head_seq == 6 && s.log.tail_seq == 0);
+  check_reads(&s);
+  check_find(&s);
+
+  // wrap-around, the tail advances with every new page
+  boot(&s);
+  for (int i = 0; i < 80; i++) {
+    append_pattern(&s, 37 + i % 5);
+    CHECK(s.log.tail_seq == s.m.tail && s.log.head_seq == s.m.head);
+    CHECK(s.log.head_seq - s.log.tail_seq < PAGES);
+  }
+  CHECK(s.log.head_seq >= 2 * PAGES && s.log.head_seq - s.log.tail_seq == PAGES - 1);
+  check_reads(&s);
+  check_find(&s);
+  CHECK(transcript_log_find(&s.log, 0, 0) == transcript_log_begin(&s.log));
+
+  // torn header on the next page, the old tail page in that sector is gone
+  interrupt_page(&s, offsetof(transcript_page_header_t, crc));
+  boot(&s);
+  CHECK(s.log.head_seq - s.log.tail_seq == PAGES - 2);
+  check_reads(&s);
+  check_find(&s);
+  append_pattern(&s, 300);
+  check_reads(&s);
+
+  // erase without a header
+  interrupt_page(&s, 0);
+  boot(&s);
+  CHECK(s.log.head_seq - s.log.tail_seq == PAGES - 2);
+  check_reads(&s);
+  check_find(&s);
+  append_pattern(&s, 10);
+  CHECK(s.log.head_seq - s.log.tail_seq == PAGES - 1);
+  check_reads(&s);
+  check_find(&s);
+
+  transcript_log_unmount(&s.log);
+  storage_file_close(&s.storage);
+  remove(s.path);
+
+  printf("%" PRIu32 " pages written, %d failed checks\n", s.m.head + 1, failures);
+  return failures == 0 ? 0 : 1;
+}